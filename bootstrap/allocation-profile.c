@@ -0,0 +1,175 @@
+#include "allocation-profile.h"
+#include "function.h"
+#include "gc.h"
+#include "source-code.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct sysmelb_AllocationSite_s
+{
+    const char *fileName;
+    int line;
+    bool hasSourcePosition;
+    sysmelb_SourcePosition_t sourcePosition;
+    size_t count;
+    size_t bytes;
+} sysmelb_AllocationSite_t;
+
+bool sysmelb_AllocationProfileEnabled;
+
+// The profile is kept outside of the collected heap, so that recording an
+// allocation never allocates.
+static sysmelb_AllocationSite_t *sysmelb_AllocationSites;
+static size_t sysmelb_AllocationSiteCount;
+static size_t sysmelb_AllocationSiteCapacity;
+
+void sysmelb_allocationProfile_enable(void)
+{
+    sysmelb_AllocationProfileEnabled = true;
+}
+
+static uint64_t sysmelb_allocationProfile_hashSite(const char *fileName, int line, bool hasSourcePosition, sysmelb_SourcePosition_t *sourcePosition)
+{
+    uint64_t hash = (uintptr_t)fileName;
+    hash = hash*1099511628211u + (uint64_t)line;
+    if(hasSourcePosition)
+    {
+        hash = hash*1099511628211u + (uintptr_t)sourcePosition->sourceCode;
+        hash = hash*1099511628211u + (uint64_t)sourcePosition->startIndex;
+        hash = hash*1099511628211u + (uint64_t)sourcePosition->endIndex;
+    }
+    return hash ^ (hash >> 29);
+}
+
+static bool sysmelb_allocationProfile_siteEquals(sysmelb_AllocationSite_t *site, const char *fileName, int line, bool hasSourcePosition, sysmelb_SourcePosition_t *sourcePosition)
+{
+    if(site->fileName != fileName || site->line != line || site->hasSourcePosition != hasSourcePosition)
+        return false;
+    if(!hasSourcePosition)
+        return true;
+
+    return site->sourcePosition.sourceCode == sourcePosition->sourceCode
+        && site->sourcePosition.startIndex == sourcePosition->startIndex
+        && site->sourcePosition.endIndex == sourcePosition->endIndex;
+}
+
+static sysmelb_AllocationSite_t *sysmelb_allocationProfile_scanFor(const char *fileName, int line, bool hasSourcePosition, sysmelb_SourcePosition_t *sourcePosition)
+{
+    size_t mask = sysmelb_AllocationSiteCapacity - 1;
+    size_t index = sysmelb_allocationProfile_hashSite(fileName, line, hasSourcePosition, sourcePosition) & mask;
+    for(;;)
+    {
+        sysmelb_AllocationSite_t *site = sysmelb_AllocationSites + index;
+        if(!site->fileName || sysmelb_allocationProfile_siteEquals(site, fileName, line, hasSourcePosition, sourcePosition))
+            return site;
+        index = (index + 1) & mask;
+    }
+}
+
+static void sysmelb_allocationProfile_increaseCapacity(void)
+{
+    sysmelb_AllocationSite_t *oldSites = sysmelb_AllocationSites;
+    size_t oldCapacity = sysmelb_AllocationSiteCapacity;
+
+    sysmelb_AllocationSiteCapacity = oldCapacity ? oldCapacity*2 : 1024;
+    sysmelb_AllocationSites = calloc(sysmelb_AllocationSiteCapacity, sizeof(sysmelb_AllocationSite_t));
+    if(!sysmelb_AllocationSites)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        abort();
+    }
+
+    for(size_t i = 0; i < oldCapacity; ++i)
+    {
+        sysmelb_AllocationSite_t *oldSite = oldSites + i;
+        if(!oldSite->fileName)
+            continue;
+
+        *sysmelb_allocationProfile_scanFor(oldSite->fileName, oldSite->line, oldSite->hasSourcePosition, &oldSite->sourcePosition) = *oldSite;
+    }
+
+    free(oldSites);
+}
+
+void sysmelb_allocationProfile_record(const char *fileName, int line, size_t allocationSize)
+{
+    if(sysmelb_AllocationSiteCount*4 >= sysmelb_AllocationSiteCapacity*3)
+        sysmelb_allocationProfile_increaseCapacity();
+
+    sysmelb_SourcePosition_t sourcePosition = {0};
+    bool hasSourcePosition = sysmelb_getCurrentInterpretedSourcePosition(&sourcePosition) && sourcePosition.sourceCode;
+
+    sysmelb_AllocationSite_t *site = sysmelb_allocationProfile_scanFor(fileName, line, hasSourcePosition, &sourcePosition);
+    if(!site->fileName)
+    {
+        site->fileName = fileName;
+        site->line = line;
+        site->hasSourcePosition = hasSourcePosition;
+        site->sourcePosition = sourcePosition;
+        ++sysmelb_AllocationSiteCount;
+    }
+
+    ++site->count;
+    site->bytes += allocationSize;
+}
+
+void sysmelb_allocationProfile_markReferences(void)
+{
+    // Keep the source code of the profiled sites alive for printing them.
+    for(size_t i = 0; i < sysmelb_AllocationSiteCapacity; ++i)
+    {
+        sysmelb_AllocationSite_t *site = sysmelb_AllocationSites + i;
+        if(site->fileName && site->hasSourcePosition)
+            sysmelb_gc_markSourcePosition(&site->sourcePosition);
+    }
+}
+
+static int sysmelb_allocationProfile_compareSites(const void *a, const void *b)
+{
+    const sysmelb_AllocationSite_t *siteA = a;
+    const sysmelb_AllocationSite_t *siteB = b;
+    if(siteA->bytes != siteB->bytes)
+        return siteA->bytes < siteB->bytes ? 1 : -1;
+    if(siteA->count != siteB->count)
+        return siteA->count < siteB->count ? 1 : -1;
+    return 0;
+}
+
+void sysmelb_allocationProfile_print(void)
+{
+    sysmelb_AllocationSite_t *sortedSites = calloc(sysmelb_AllocationSiteCount + 1, sizeof(sysmelb_AllocationSite_t));
+    size_t totalCount = 0;
+    size_t totalBytes = 0;
+    size_t siteCount = 0;
+    for(size_t i = 0; i < sysmelb_AllocationSiteCapacity; ++i)
+    {
+        sysmelb_AllocationSite_t *site = sysmelb_AllocationSites + i;
+        if(!site->fileName)
+            continue;
+
+        sortedSites[siteCount++] = *site;
+        totalCount += site->count;
+        totalBytes += site->bytes;
+    }
+
+    qsort(sortedSites, siteCount, sizeof(sysmelb_AllocationSite_t), sysmelb_allocationProfile_compareSites);
+
+    fprintf(stderr, "%12s %10s %6s  %s\n", "Bytes", "Count", "%", "Site");
+    for(size_t i = 0; i < siteCount; ++i)
+    {
+        sysmelb_AllocationSite_t *site = sortedSites + i;
+        fprintf(stderr, "%12zu %10zu %6.2f  %s:%d", site->bytes, site->count, totalBytes ? site->bytes * 100.0 / totalBytes : 0.0, site->fileName, site->line);
+        if(site->hasSourcePosition)
+        {
+            sysmelb_SourcePosition_t *position = &site->sourcePosition;
+            fprintf(stderr, " <- %s%s:%d.%d-%d.%d", position->sourceCode->directory ? position->sourceCode->directory : "", position->sourceCode->name,
+                position->startLine, position->startColumn, position->endLine, position->endColumn);
+        }
+        fprintf(stderr, "\n");
+    }
+    fprintf(stderr, "%12zu %10zu %6.2f  Total\n", totalBytes, totalCount, 100.0);
+
+    free(sortedSites);
+}
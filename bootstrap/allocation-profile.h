@@ -0,0 +1,18 @@
+#ifndef SYSMELB_ALLOCATION_PROFILE_H
+#define SYSMELB_ALLOCATION_PROFILE_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+extern bool sysmelb_AllocationProfileEnabled;
+
+// Allocations are grouped by their C call site, and by the source position
+// of the interpreted bytecode that was being executed, if any.
+void sysmelb_allocationProfile_enable(void);
+void sysmelb_allocationProfile_record(const char *fileName, int line, size_t allocationSize);
+void sysmelb_allocationProfile_markReferences(void);
+void sysmelb_allocationProfile_print(void);
+
+#endif //SYSMELB_ALLOCATION_PROFILE_H
@@ -0,0 +1,642 @@
+// Microbenchmarks of the data structures of the bootstrap interpreter. They
+// are built from the same unity build, without the interpreter entry point.
+//
+//   build/benchmark probe-lengths
+//   build/benchmark symbol-lookups
+//   build/benchmark interning sysmelc/*.sysmel
+//   build/benchmark values sysmelc/package.sysmel samples/22-Compilation.sysmel
+//
+// The values benchmark is meant to be compared against build/benchmark-tagged,
+// which is built with the single word value layout.
+#define SYSMELB_NO_MAIN
+#include "unity.c"
+#include <ctype.h>
+#include <time.h>
+#include <sys/resource.h>
+
+static const size_t sysmelb_benchmark_TableSizes[] = {1000, 20000, 100000};
+#define SYSMELB_BENCHMARK_TABLE_SIZE_COUNT (sizeof(sysmelb_benchmark_TableSizes) / sizeof(sysmelb_benchmark_TableSizes[0]))
+
+static void *sysmelb_benchmark_allocateOrAbort(size_t size)
+{
+    void *result = calloc(1, size);
+    if(!result)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        abort();
+    }
+    return result;
+}
+
+// Identity collections hash the addresses of their elements, so their keys
+// are objects from the collected heap, as in the interpreter.
+static void **sysmelb_benchmark_makeObjects(size_t count)
+{
+    void **objects = sysmelb_benchmark_allocateOrAbort(count * sizeof(void*));
+    for(size_t i = 0; i < count; ++i)
+        objects[i] = sysmelb_allocate(32);
+    return objects;
+}
+
+static sysmelb_symbol_t **sysmelb_benchmark_makeSymbols(const char *prefix, size_t count)
+{
+    sysmelb_symbol_t **symbols = sysmelb_benchmark_allocateOrAbort(count * sizeof(sysmelb_symbol_t*));
+    char name[64];
+    for(size_t i = 0; i < count; ++i)
+    {
+        int nameSize = snprintf(name, sizeof(name), "%s%zu", prefix, i);
+        symbols[i] = sysmelb_internSymbol(nameSize, name);
+    }
+    return symbols;
+}
+
+static void sysmelb_benchmark_printMeasure(const char *name, const sysmelb_HashtableMeasure_t *measure)
+{
+    double meanProbeLength = measure->size ? (double)measure->totalProbeLength / (double)measure->size : 0.0;
+    printf("%-22s %8zu %9zu %10.2f %6zu\n", name, measure->size, measure->capacity, meanProbeLength, measure->maxProbeLength);
+}
+
+// The symbol hash before wyhash, kept as a baseline.
+static uint32_t sysmelb_benchmark_multiplyAddHash(size_t stringSize, const char *string)
+{
+    uint32_t hash = 0;
+    for(size_t i = 0; i < stringSize; ++i)
+        hash = hash*1664525 + string[i];
+    return hash;
+}
+
+static uint64_t sysmelb_benchmark_oldIdentityHash(void *key)
+{
+    return (uintptr_t)key*1664525;
+}
+
+static uint64_t sysmelb_benchmark_oldSymbolHash(void *key)
+{
+    sysmelb_symbol_t *symbol = key;
+    return sysmelb_benchmark_multiplyAddHash(symbol->size, symbol->string);
+}
+
+// The probing of every hashtable before the mask, kept as a baseline: the
+// keys are probed linearly from their hash modulo the capacity, and the
+// table doubles at 80% of its capacity. The values do not change the probe
+// lengths, so they are not stored.
+typedef struct sysmelb_benchmark_ModuloTable_s
+{
+    uint64_t (*hash)(void *key);
+    size_t minimumCapacity;
+    size_t capacity;
+    size_t size;
+    void **keys;
+} sysmelb_benchmark_ModuloTable_t;
+
+static size_t sysmelb_benchmark_ModuloTable_scanFor(sysmelb_benchmark_ModuloTable_t *table, void *key)
+{
+    size_t index = table->hash(key) % table->capacity;
+    for(size_t i = index; i < table->capacity; ++i)
+    {
+        if(!table->keys[i] || table->keys[i] == key)
+            return i;
+    }
+
+    for(size_t i = 0; i < index; ++i)
+    {
+        if(!table->keys[i] || table->keys[i] == key)
+            return i;
+    }
+
+    abort();
+}
+
+static void sysmelb_benchmark_ModuloTable_add(sysmelb_benchmark_ModuloTable_t *table, void *key)
+{
+    if(table->capacity == 0 || table->size + 1 > table->capacity * 80 / 100)
+    {
+        size_t oldCapacity = table->capacity;
+        void **oldKeys = table->keys;
+        table->capacity = oldCapacity ? oldCapacity*2 : table->minimumCapacity;
+        table->size = 0;
+        table->keys = sysmelb_benchmark_allocateOrAbort(table->capacity * sizeof(void*));
+        for(size_t i = 0; i < oldCapacity; ++i)
+        {
+            if(oldKeys[i])
+                sysmelb_benchmark_ModuloTable_add(table, oldKeys[i]);
+        }
+        free(oldKeys);
+    }
+
+    size_t index = sysmelb_benchmark_ModuloTable_scanFor(table, key);
+    if(!table->keys[index])
+    {
+        table->keys[index] = key;
+        ++table->size;
+    }
+}
+
+static void sysmelb_benchmark_ModuloTable_measure(sysmelb_benchmark_ModuloTable_t *table, sysmelb_HashtableMeasure_t *measure)
+{
+    memset(measure, 0, sizeof(sysmelb_HashtableMeasure_t));
+    measure->size = table->size;
+    measure->capacity = table->capacity;
+    for(size_t i = 0; i < table->capacity; ++i)
+    {
+        if(!table->keys[i])
+            continue;
+
+        size_t home = table->hash(table->keys[i]) % table->capacity;
+        size_t probeLength = (i + table->capacity - home) % table->capacity + 1;
+        measure->totalProbeLength += probeLength;
+        if(probeLength > measure->maxProbeLength)
+            measure->maxProbeLength = probeLength;
+    }
+}
+
+// The mean probe length is the number of slots that a successful lookup
+// reads on average. For symbol hashtables it counts the slots from the start
+// of the first group that is probed. The identity hashset and dictionary
+// used the same modulo probing, so they share a baseline row.
+static void sysmelb_benchmark_probeLengths(void)
+{
+    printf("%-22s %8s %9s %10s %6s\n", "Table", "Size", "Capacity", "Mean probe", "Max");
+    for(size_t i = 0; i < SYSMELB_BENCHMARK_TABLE_SIZE_COUNT; ++i)
+    {
+        size_t size = sysmelb_benchmark_TableSizes[i];
+        void **objects = sysmelb_benchmark_makeObjects(size);
+        sysmelb_HashtableMeasure_t measure;
+
+        sysmelb_IdentityHashset_t set = {0};
+        for(size_t j = 0; j < size; ++j)
+            sysmelb_IdentityHashset_add(&set, sysmelb_value_makeReference(SysmelValueKindObjectReference, NULL, objects[j]));
+        sysmelb_IdentityHashset_measure(&set, &measure);
+        sysmelb_benchmark_printMeasure("Identity hashset", &measure);
+
+        sysmelb_IdentityDictionary_t dictionary = {0};
+        for(size_t j = 0; j < size; ++j)
+            sysmelb_IdentityDictionary_atPut(&dictionary, objects[j], objects[j]);
+        sysmelb_IdentityDictionary_measure(&dictionary, &measure);
+        sysmelb_benchmark_printMeasure("Identity dictionary", &measure);
+
+        sysmelb_benchmark_ModuloTable_t moduloIdentityTable = {.hash = sysmelb_benchmark_oldIdentityHash, .minimumCapacity = 32};
+        for(size_t j = 0; j < size; ++j)
+            sysmelb_benchmark_ModuloTable_add(&moduloIdentityTable, objects[j]);
+        sysmelb_benchmark_ModuloTable_measure(&moduloIdentityTable, &measure);
+        sysmelb_benchmark_printMeasure("Modulo identity", &measure);
+        free(moduloIdentityTable.keys);
+
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "probeLengths%zu_", size);
+        sysmelb_symbol_t **symbols = sysmelb_benchmark_makeSymbols(prefix, size);
+        sysmelb_SymbolHashtable_t table = {0};
+        for(size_t j = 0; j < size; ++j)
+            sysmelb_SymbolHashtable_addSymbolWithValue(&table, symbols[j], objects[j]);
+        sysmelb_SymbolHashtable_measure(&table, &measure);
+        sysmelb_benchmark_printMeasure("Symbol hashtable", &measure);
+
+        sysmelb_benchmark_ModuloTable_t moduloSymbolTable = {.hash = sysmelb_benchmark_oldSymbolHash, .minimumCapacity = 32};
+        for(size_t j = 0; j < size; ++j)
+            sysmelb_benchmark_ModuloTable_add(&moduloSymbolTable, symbols[j]);
+        sysmelb_benchmark_ModuloTable_measure(&moduloSymbolTable, &measure);
+        sysmelb_benchmark_printMeasure("Modulo symbol", &measure);
+        free(moduloSymbolTable.keys);
+
+        free(symbols);
+        free(objects);
+    }
+
+    sysmelb_HashtableMeasure_t measure;
+    sysmelb_measureInternedSymbols(&measure);
+    sysmelb_benchmark_printMeasure("Interned symbols", &measure);
+
+    sysmelb_benchmark_ModuloTable_t moduloInternedSet = {.hash = sysmelb_benchmark_oldSymbolHash, .minimumCapacity = 1024};
+    for(uint32_t i = 0; i < sysmelb_getInternedSymbolCount(); ++i)
+        sysmelb_benchmark_ModuloTable_add(&moduloInternedSet, sysmelb_getSymbolWithID(i));
+    sysmelb_benchmark_ModuloTable_measure(&moduloInternedSet, &measure);
+    sysmelb_benchmark_printMeasure("Modulo interned", &measure);
+    free(moduloInternedSet.keys);
+}
+
+static double sysmelb_benchmark_now(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+static uint64_t sysmelb_benchmark_random(uint64_t *state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+#define SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE (1 << 20)
+#define SYSMELB_BENCHMARK_LOOKUP_ROUNDS 20
+
+// The symbol hashtable before the control bytes, kept as a baseline: the
+// pairs are probed linearly from the key hash modulo the capacity, and the
+// table grows at 80% of its capacity.
+typedef struct sysmelb_benchmark_LinearPair_s
+{
+    sysmelb_symbol_t *key;
+    void *value;
+} sysmelb_benchmark_LinearPair_t;
+
+typedef struct sysmelb_benchmark_LinearSymbolTable_s
+{
+    size_t capacity;
+    size_t size;
+    sysmelb_benchmark_LinearPair_t *data;
+} sysmelb_benchmark_LinearSymbolTable_t;
+
+static size_t sysmelb_benchmark_LinearSymbolTable_scanFor(sysmelb_benchmark_LinearSymbolTable_t *table, sysmelb_symbol_t *key)
+{
+    size_t index = key->hash % table->capacity;
+    for(size_t i = index; i < table->capacity; ++i)
+    {
+        if(!table->data[i].key || table->data[i].key == key)
+            return i;
+    }
+
+    for(size_t i = 0; i < index; ++i)
+    {
+        if(!table->data[i].key || table->data[i].key == key)
+            return i;
+    }
+
+    abort();
+}
+
+static void sysmelb_benchmark_LinearSymbolTable_add(sysmelb_benchmark_LinearSymbolTable_t *table, sysmelb_symbol_t *key, void *value)
+{
+    if(table->size + 1 >= table->capacity * 80 / 100)
+    {
+        sysmelb_benchmark_LinearSymbolTable_t oldTable = *table;
+        table->capacity = oldTable.capacity ? oldTable.capacity*2 : 32;
+        table->size = 0;
+        table->data = sysmelb_benchmark_allocateOrAbort(table->capacity * sizeof(sysmelb_benchmark_LinearPair_t));
+        memset(table->data, 0, table->capacity * sizeof(sysmelb_benchmark_LinearPair_t));
+        for(size_t i = 0; i < oldTable.capacity; ++i)
+        {
+            if(oldTable.data[i].key)
+                sysmelb_benchmark_LinearSymbolTable_add(table, oldTable.data[i].key, oldTable.data[i].value);
+        }
+        free(oldTable.data);
+    }
+
+    sysmelb_benchmark_LinearPair_t *pair = table->data + sysmelb_benchmark_LinearSymbolTable_scanFor(table, key);
+    if(!pair->key)
+        ++table->size;
+    pair->key = key;
+    pair->value = value;
+}
+
+static bool sysmelb_benchmark_LinearSymbolTable_lookup(sysmelb_benchmark_LinearSymbolTable_t *table, sysmelb_symbol_t *key, void **outValue)
+{
+    sysmelb_benchmark_LinearPair_t *pair = table->data + sysmelb_benchmark_LinearSymbolTable_scanFor(table, key);
+    if(!pair->key)
+        return false;
+    *outValue = pair->value;
+    return true;
+}
+
+static double sysmelb_benchmark_timeLookups(sysmelb_SymbolHashtable_t *table, sysmelb_benchmark_LinearSymbolTable_t *linearTable, sysmelb_symbol_t **sequence)
+{
+    size_t found = 0;
+    void *value;
+    double startTime = sysmelb_benchmark_now();
+    for(size_t round = 0; round < SYSMELB_BENCHMARK_LOOKUP_ROUNDS; ++round)
+    {
+        if(linearTable)
+        {
+            for(size_t i = 0; i < SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE; ++i)
+                found += sysmelb_benchmark_LinearSymbolTable_lookup(linearTable, sequence[i], &value);
+        }
+        else
+        {
+            for(size_t i = 0; i < SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE; ++i)
+                found += sysmelb_SymbolHashtable_lookupSymbol(table, sequence[i], &value);
+        }
+    }
+    double endTime = sysmelb_benchmark_now();
+
+    // Keep the lookups from being optimised away.
+    if(found == SIZE_MAX)
+        printf("%zu\n", found);
+    return (endTime - startTime) / ((double)SYSMELB_BENCHMARK_LOOKUP_ROUNDS * SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE);
+}
+
+// Looks up the keys of a table in random order, and as many symbols that
+// are not in it, over about 20M lookups of each kind. The same lookups are
+// timed on the linear baseline.
+static void sysmelb_benchmark_symbolLookups(void)
+{
+    static const size_t entryCounts[] = {8, 64, 512, 4096, 32768};
+    sysmelb_symbol_t **sequence = sysmelb_benchmark_allocateOrAbort(SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE * sizeof(sysmelb_symbol_t*));
+    uint64_t randomState = 0x9E3779B97F4A7C15ull;
+
+    printf("%8s %10s %10s %12s %12s\n", "Entries", "Hit ns", "Miss ns", "Linear hit", "Linear miss");
+    for(size_t i = 0; i < sizeof(entryCounts) / sizeof(entryCounts[0]); ++i)
+    {
+        size_t entryCount = entryCounts[i];
+        char prefix[64];
+        snprintf(prefix, sizeof(prefix), "hit%zu_", entryCount);
+        sysmelb_symbol_t **keys = sysmelb_benchmark_makeSymbols(prefix, entryCount);
+        snprintf(prefix, sizeof(prefix), "miss%zu_", entryCount);
+        sysmelb_symbol_t **missingKeys = sysmelb_benchmark_makeSymbols(prefix, entryCount);
+
+        sysmelb_SymbolHashtable_t table = {0};
+        sysmelb_benchmark_LinearSymbolTable_t linearTable = {0};
+        for(size_t j = 0; j < entryCount; ++j)
+        {
+            sysmelb_SymbolHashtable_addSymbolWithValue(&table, keys[j], keys[j]);
+            sysmelb_benchmark_LinearSymbolTable_add(&linearTable, keys[j], keys[j]);
+        }
+
+        for(size_t j = 0; j < SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE; ++j)
+            sequence[j] = keys[sysmelb_benchmark_random(&randomState) % entryCount];
+        double hitTime = sysmelb_benchmark_timeLookups(&table, NULL, sequence);
+        double linearHitTime = sysmelb_benchmark_timeLookups(NULL, &linearTable, sequence);
+
+        for(size_t j = 0; j < SYSMELB_BENCHMARK_LOOKUP_SEQUENCE_SIZE; ++j)
+            sequence[j] = missingKeys[sysmelb_benchmark_random(&randomState) % entryCount];
+        double missTime = sysmelb_benchmark_timeLookups(&table, NULL, sequence);
+        double linearMissTime = sysmelb_benchmark_timeLookups(NULL, &linearTable, sequence);
+
+        printf("%8zu %10.1f %10.1f %12.1f %12.1f\n", entryCount, hitTime, missTime, linearHitTime, linearMissTime);
+        free(linearTable.data);
+        free(missingKeys);
+        free(keys);
+    }
+
+    free(sequence);
+}
+
+typedef struct sysmelb_benchmark_Identifier_s
+{
+    size_t size;
+    const char *string;
+} sysmelb_benchmark_Identifier_t;
+
+typedef struct sysmelb_benchmark_IdentifierList_s
+{
+    size_t size;
+    size_t capacity;
+    sysmelb_benchmark_Identifier_t *identifiers;
+} sysmelb_benchmark_IdentifierList_t;
+
+static void sysmelb_benchmark_addIdentifier(sysmelb_benchmark_IdentifierList_t *list, size_t size, const char *string)
+{
+    if(list->size >= list->capacity)
+    {
+        size_t newCapacity = list->capacity ? list->capacity * 2 : 1024;
+        sysmelb_benchmark_Identifier_t *newIdentifiers = realloc(list->identifiers, newCapacity * sizeof(sysmelb_benchmark_Identifier_t));
+        if(!newIdentifiers)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+        list->identifiers = newIdentifiers;
+        list->capacity = newCapacity;
+    }
+
+    sysmelb_benchmark_Identifier_t identifier = {size, string};
+    list->identifiers[list->size++] = identifier;
+}
+
+static void sysmelb_benchmark_extractIdentifiers(sysmelb_benchmark_IdentifierList_t *list, const char *fileName)
+{
+    FILE *file = fopen(fileName, "rb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open %s\n", fileName);
+        abort();
+    }
+
+    fseek(file, 0, SEEK_END);
+    size_t fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    // The text is kept alive until exit, since the identifiers point into it.
+    char *text = sysmelb_benchmark_allocateOrAbort(fileSize + 1);
+    if(fread(text, fileSize, 1, file) != 1 && fileSize != 0)
+    {
+        fprintf(stderr, "Failed to read %s\n", fileName);
+        abort();
+    }
+    fclose(file);
+
+    size_t i = 0;
+    while(i < fileSize)
+    {
+        if(!isalpha((unsigned char)text[i]) && text[i] != '_')
+        {
+            ++i;
+            continue;
+        }
+
+        size_t start = i;
+        while(i < fileSize && (isalnum((unsigned char)text[i]) || text[i] == '_'))
+            ++i;
+        sysmelb_benchmark_addIdentifier(list, i - start, text + start);
+    }
+}
+
+#define SYSMELB_BENCHMARK_INTERNING_ROUNDS 50
+
+static int sysmelb_benchmark_compareHashes(const void *a, const void *b)
+{
+    uint64_t hashA = *(const uint64_t*)a;
+    uint64_t hashB = *(const uint64_t*)b;
+    return hashA < hashB ? -1 : (hashA > hashB ? 1 : 0);
+}
+
+// Counts the interned symbols whose full hash is the same as the one of
+// another symbol. The hashes are sorted in place.
+static size_t sysmelb_benchmark_countHashCollisions(uint64_t *hashes, size_t count)
+{
+    qsort(hashes, count, sizeof(uint64_t), sysmelb_benchmark_compareHashes);
+    size_t collisions = 0;
+    for(size_t i = 1; i < count; ++i)
+        collisions += hashes[i] == hashes[i - 1];
+    return collisions;
+}
+
+// Interns every identifier of the given source files, in the order of the
+// files, as the scanner and the parser do. The multiply-add hash that
+// symbols had before wyhash is timed and measured on the same identifiers.
+static void sysmelb_benchmark_interning(int fileCount, const char **fileNames)
+{
+    sysmelb_benchmark_IdentifierList_t list = {0};
+    for(int i = 0; i < fileCount; ++i)
+        sysmelb_benchmark_extractIdentifiers(&list, fileNames[i]);
+    if(list.size == 0)
+    {
+        fprintf(stderr, "No identifiers to intern.\n");
+        abort();
+    }
+
+    size_t totalIdentifierSize = 0;
+    for(size_t i = 0; i < list.size; ++i)
+        totalIdentifierSize += list.identifiers[i].size;
+
+    double startTime = sysmelb_benchmark_now();
+    for(size_t round = 0; round < SYSMELB_BENCHMARK_INTERNING_ROUNDS; ++round)
+    {
+        for(size_t i = 0; i < list.size; ++i)
+            sysmelb_internSymbol(list.identifiers[i].size, list.identifiers[i].string);
+    }
+    double internTime = sysmelb_benchmark_now() - startTime;
+
+    uint64_t hashes = 0;
+    startTime = sysmelb_benchmark_now();
+    for(size_t round = 0; round < SYSMELB_BENCHMARK_INTERNING_ROUNDS; ++round)
+    {
+        for(size_t i = 0; i < list.size; ++i)
+            hashes += sysmelb_stringHash(list.identifiers[i].size, list.identifiers[i].string);
+    }
+    double hashTime = sysmelb_benchmark_now() - startTime;
+
+    startTime = sysmelb_benchmark_now();
+    for(size_t round = 0; round < SYSMELB_BENCHMARK_INTERNING_ROUNDS; ++round)
+    {
+        for(size_t i = 0; i < list.size; ++i)
+            hashes += sysmelb_benchmark_multiplyAddHash(list.identifiers[i].size, list.identifiers[i].string);
+    }
+    double multiplyAddHashTime = sysmelb_benchmark_now() - startTime;
+
+    // Keep the hashes from being optimised away.
+    if(hashes == 0)
+        printf("%llu\n", (unsigned long long)hashes);
+
+    uint32_t symbolCount = sysmelb_getInternedSymbolCount();
+    uint64_t *symbolHashes = sysmelb_benchmark_allocateOrAbort(symbolCount * sizeof(uint64_t));
+    for(uint32_t i = 0; i < symbolCount; ++i)
+        symbolHashes[i] = sysmelb_getSymbolWithID(i)->hash;
+    size_t collisions = sysmelb_benchmark_countHashCollisions(symbolHashes, symbolCount);
+    for(uint32_t i = 0; i < symbolCount; ++i)
+        symbolHashes[i] = sysmelb_benchmark_oldSymbolHash(sysmelb_getSymbolWithID(i));
+    size_t multiplyAddCollisions = sysmelb_benchmark_countHashCollisions(symbolHashes, symbolCount);
+    free(symbolHashes);
+
+    sysmelb_benchmark_ModuloTable_t moduloInternedSet = {.hash = sysmelb_benchmark_oldSymbolHash, .minimumCapacity = 1024};
+    for(uint32_t i = 0; i < symbolCount; ++i)
+        sysmelb_benchmark_ModuloTable_add(&moduloInternedSet, sysmelb_getSymbolWithID(i));
+    sysmelb_HashtableMeasure_t moduloMeasure;
+    sysmelb_benchmark_ModuloTable_measure(&moduloInternedSet, &moduloMeasure);
+    free(moduloInternedSet.keys);
+
+    double lookupCount = (double)SYSMELB_BENCHMARK_INTERNING_ROUNDS * (double)list.size;
+    sysmelb_HashtableMeasure_t measure;
+    sysmelb_measureInternedSymbols(&measure);
+    printf("Identifiers: %zu, %.1f bytes on average\n", list.size, (double)totalIdentifierSize / (double)list.size);
+    printf("Intern: %.1f ns per identifier\n", internTime / lookupCount);
+    printf("Hash: %.1f ns per identifier, %.1f ns with multiply-add\n", hashTime / lookupCount, multiplyAddHashTime / lookupCount);
+    printf("Hash collisions: %zu, %zu with multiply-add\n", collisions, multiplyAddCollisions);
+    printf("Interned symbols: %zu in %zu slots, mean probe %.2f, max probe %zu\n", measure.size, measure.capacity,
+        measure.size ? (double)measure.totalProbeLength / (double)measure.size : 0.0, measure.maxProbeLength);
+    printf("Multiply-add modulo probing: %zu slots, mean probe %.2f, max probe %zu\n", moduloMeasure.capacity,
+        moduloMeasure.size ? (double)moduloMeasure.totalProbeLength / (double)moduloMeasure.size : 0.0, moduloMeasure.maxProbeLength);
+    free(list.identifiers);
+}
+
+#define SYSMELB_BENCHMARK_VALUE_ROUNDS (1<<24)
+
+// Evaluates the given source files in a single module, as the interpreter
+// does, and reports the cost of the values with the layout of this build.
+static void sysmelb_benchmark_values(int fileCount, const char **fileNames)
+{
+    sysmelb_gc_setNativeStackBottom(__builtin_frame_address(0));
+
+    const sysmelb_BasicTypes_t *basicTypes = sysmelb_getBasicTypes();
+    sysmelb_Value_t accumulator = sysmelb_value_makeInteger(basicTypes->integer, 0);
+    double startTime = sysmelb_benchmark_now();
+    for(size_t i = 0; i < SYSMELB_BENCHMARK_VALUE_ROUNDS; ++i)
+        accumulator = sysmelb_value_makeInteger(
+            basicTypes->integer, sysmelb_value_getInteger(accumulator) + (sysmelb_IntegerLiteralType_t)(i & 0xFF));
+    double integerTime = sysmelb_benchmark_now() - startTime;
+
+    startTime = sysmelb_benchmark_now();
+    sysmelb_Value_t reference = sysmelb_value_makeReference(SysmelValueKindTypeReference, basicTypes->universe, basicTypes->integer);
+    for(size_t i = 0; i < SYSMELB_BENCHMARK_VALUE_ROUNDS; ++i)
+        reference = sysmelb_value_makeReference(
+            SysmelValueKindTypeReference, sysmelb_value_getType(reference), sysmelb_value_getReference(reference, type));
+    double referenceTime = sysmelb_benchmark_now() - startTime;
+
+    // Keep the loops from being optimised away.
+    if(sysmelb_value_getInteger(accumulator) == 0 || sysmelb_value_getReference(reference, type) != basicTypes->integer)
+        printf("%lld\n", (long long)sysmelb_value_getInteger(accumulator));
+
+    startTime = sysmelb_benchmark_now();
+    sysmelb_Module_t *module = NULL;
+    for(int i = 0; i < fileCount; ++i)
+    {
+        sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromFileNamed(fileNames[i]);
+        sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+        sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
+        sysmelb_ParseTreeNode_t *parseTree = parseTokenList(sourceCode, scannedTokens.size, scannedTokens.tokens);
+        sysmelb_scratch_endScope(scratchScope);
+        if(sysmelb_visitForDisplayingAndCountingErrors(parseTree) != 0)
+            abort();
+
+        if(!module)
+            module = sysmelb_createModuleNamed(sysmelb_internSymbolC(sourceCode->name));
+        sysmelb_analyzeAndEvaluateScript(sysmelb_module_createTopLevelEnvironment(module), parseTree);
+    }
+    double evaluationTime = sysmelb_benchmark_now() - startTime;
+
+    sysmelb_gc_collect();
+    const sysmelb_GCStatistics_t *statistics = sysmelb_gc_getStatistics();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    printf("Value size: %zu bytes\n", sizeof(sysmelb_Value_t));
+    printf("Integer round trip: %.2f ns\n", integerTime / SYSMELB_BENCHMARK_VALUE_ROUNDS);
+    printf("Reference round trip: %.2f ns\n", referenceTime / SYSMELB_BENCHMARK_VALUE_ROUNDS);
+    printf("Evaluation: %.1f ms\n", evaluationTime / 1e6);
+    printf("GC collections: %zu, live bytes: %zu\n", statistics->collectionCount, statistics->lastLiveBytes);
+    printf("Peak resident set: %ld KB\n", usage.ru_maxrss);
+}
+
+static void sysmelb_benchmark_printUsage(void)
+{
+    printf("benchmark probe-lengths\n");
+    printf("benchmark symbol-lookups\n");
+    printf("benchmark interning <source files>\n");
+    printf("benchmark values <source files>\n");
+}
+
+int main(int argc, const char **argv)
+{
+    if(argc < 2)
+    {
+        sysmelb_benchmark_printUsage();
+        return 1;
+    }
+
+    const char *benchmark = argv[1];
+    if(!strcmp(benchmark, "probe-lengths"))
+    {
+        sysmelb_benchmark_probeLengths();
+    }
+    else if(!strcmp(benchmark, "symbol-lookups"))
+    {
+        sysmelb_benchmark_symbolLookups();
+    }
+    else if(!strcmp(benchmark, "interning") && argc > 2)
+    {
+        sysmelb_benchmark_interning(argc - 2, argv + 2);
+    }
+    else if(!strcmp(benchmark, "values") && argc > 2)
+    {
+        sysmelb_benchmark_values(argc - 2, argv + 2);
+    }
+    else
+    {
+        sysmelb_benchmark_printUsage();
+        return 1;
+    }
+
+    return 0;
+}
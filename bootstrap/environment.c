@@ -1,6 +1,7 @@
 #include "environment.h"
 #include "error.h"
 #include "function.h"
+#include "gc.h"
 #include "memory.h"
 #include "parse-tree.h"
 #include "module.h"
@@ -55,9 +56,7 @@ sysmelb_SymbolBinding_t *sysmelb_createSymbolTypeBinding(sysmelb_Type_t *type)
 {
     sysmelb_SymbolBinding_t *binding = sysmelb_allocate(sizeof(sysmelb_SymbolBinding_t));
     binding->kind = SysmelSymbolValueBinding;
-    binding->value.kind = SysmelValueKindTypeReference;
-    binding->value.type = sysmelb_getBasicTypes()->universe;
-    binding->value.typeReference = type;
+    binding->value = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, type);
     return binding;
 }
 
@@ -65,9 +64,7 @@ sysmelb_SymbolBinding_t *sysmelb_createSymbolFunctionBinding(sysmelb_function_t
 {
     sysmelb_SymbolBinding_t *binding = sysmelb_allocate(sizeof(sysmelb_SymbolBinding_t));
     binding->kind = SysmelSymbolValueBinding;
-    binding->value.kind = SysmelValueKindFunctionReference;
-    binding->value.type = sysmelb_getBasicTypes()->gradual;
-    binding->value.functionReference = function;
+    binding->value = sysmelb_value_makeReference(SysmelValueKindFunctionReference, sysmelb_getBasicTypes()->gradual, function);
     return binding;
 }
 
@@ -76,18 +73,17 @@ sysmelb_SymbolBinding_t *sysmelb_environmentLookRecursively(sysmelb_Environment_
     if(!environment)
         return NULL;
 
-    const sysmelb_SymbolHashtablePair_t *lookupResult = sysmelb_SymbolHashtable_lookupSymbol(&environment->localSymbolTable, symbol);
-    if(lookupResult && lookupResult->key)
-        return (sysmelb_SymbolBinding_t*)lookupResult->value;
+    void *lookupResult;
+    if(sysmelb_SymbolHashtable_lookupSymbol(&environment->localSymbolTable, symbol, &lookupResult))
+        return (sysmelb_SymbolBinding_t*)lookupResult;
 
     switch(environment->kind)
     {
     case SysmelEnvKindNamespace:
         {
             sysmelb_Namespace_t *namespace = environment->ownerNamespace;
-            lookupResult = sysmelb_SymbolHashtable_lookupSymbol(&namespace->exportedObjects, symbol);
-            if(lookupResult && lookupResult->key)
-                return (sysmelb_SymbolBinding_t*)lookupResult->value;
+            if(sysmelb_SymbolHashtable_lookupSymbol(&namespace->exportedObjects, symbol, &lookupResult))
+                return (sysmelb_SymbolBinding_t*)lookupResult;
         }
         break;
     default:
@@ -128,13 +124,10 @@ static sysmelb_Value_t sysmelb_ifThenElsePrimitiveMacro(sysmelb_MacroContext_t *
 {
     assert(argumentCount == 3);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeIfSelection, macroContext->sourcePosition);
-    node->ifSelection.condition = arguments[0].parseTreeReference;
-    node->ifSelection.trueExpression = arguments[1].parseTreeReference;
-    node->ifSelection.falseExpression = arguments[2].parseTreeReference;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    node->ifSelection.condition = sysmelb_value_getReference(arguments[0], parseTree);
+    node->ifSelection.trueExpression = sysmelb_value_getReference(arguments[1], parseTree);
+    node->ifSelection.falseExpression = sysmelb_value_getReference(arguments[2], parseTree);
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
@@ -142,12 +135,9 @@ static sysmelb_Value_t sysmelb_ifThenPrimitiveMacro(sysmelb_MacroContext_t *macr
 {
     assert(argumentCount == 2);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeIfSelection, macroContext->sourcePosition);
-    node->ifSelection.condition = arguments[0].parseTreeReference;
-    node->ifSelection.trueExpression = arguments[1].parseTreeReference;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    node->ifSelection.condition = sysmelb_value_getReference(arguments[0], parseTree);
+    node->ifSelection.trueExpression = sysmelb_value_getReference(arguments[1], parseTree);
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
@@ -155,14 +145,11 @@ static sysmelb_Value_t sysmelb_WhileDoContinueWithPrimitiveMacro(sysmelb_MacroCo
 {
     assert(argumentCount == 3);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeWhileLoop, macroContext->sourcePosition);
-    node->whileLoop.condition = arguments[0].parseTreeReference;
-    node->whileLoop.body = arguments[1].parseTreeReference;
-    node->whileLoop.continueExpression = arguments[2].parseTreeReference;
-
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    node->whileLoop.condition = sysmelb_value_getReference(arguments[0], parseTree);
+    node->whileLoop.body = sysmelb_value_getReference(arguments[1], parseTree);
+    node->whileLoop.continueExpression = sysmelb_value_getReference(arguments[2], parseTree);
+
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
@@ -170,13 +157,10 @@ static sysmelb_Value_t sysmelb_WhileDoPrimitiveMacro(sysmelb_MacroContext_t *mac
 {
     assert(argumentCount == 2);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeWhileLoop, macroContext->sourcePosition);
-    node->whileLoop.condition = arguments[0].parseTreeReference;
-    node->whileLoop.body = arguments[1].parseTreeReference;
+    node->whileLoop.condition = sysmelb_value_getReference(arguments[0], parseTree);
+    node->whileLoop.body = sysmelb_value_getReference(arguments[1], parseTree);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
@@ -184,14 +168,11 @@ static sysmelb_Value_t sysmelb_DoContinueWithWhileWithPrimitiveMacro(sysmelb_Mac
 {
     assert(argumentCount == 3);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeDoWhileLoop, macroContext->sourcePosition);
-    node->doWhileLoop.body = arguments[0].parseTreeReference;
-    node->doWhileLoop.continueExpression = arguments[1].parseTreeReference;
-    node->doWhileLoop.condition = arguments[2].parseTreeReference;
-
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    node->doWhileLoop.body = sysmelb_value_getReference(arguments[0], parseTree);
+    node->doWhileLoop.continueExpression = sysmelb_value_getReference(arguments[1], parseTree);
+    node->doWhileLoop.condition = sysmelb_value_getReference(arguments[2], parseTree);
+
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
@@ -199,46 +180,36 @@ static sysmelb_Value_t sysmelb_DoWhilePrimitiveMacro(sysmelb_MacroContext_t *mac
 {
     assert(argumentCount == 2);
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeDoWhileLoop, macroContext->sourcePosition);
-    node->doWhileLoop.body = arguments[0].parseTreeReference;
-    node->doWhileLoop.condition = arguments[1].parseTreeReference;
+    node->doWhileLoop.body = sysmelb_value_getReference(arguments[0], parseTree);
+    node->doWhileLoop.condition = sysmelb_value_getReference(arguments[1], parseTree);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_ReturnPrimitiveMacro(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
     
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeReturnValue, macroContext->sourcePosition);
-    node->returnExpression.valueExpression = arguments[0].parseTreeReference;
+    node->returnExpression.valueExpression = sysmelb_value_getReference(arguments[0], parseTree);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .parseTreeReference = node
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, NULL, node);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_SwitchWithCasesMacro(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    assert(arguments[1].kind == SysmelValueKindParseTreeReference && arguments[1].parseTreeReference->kind == ParseTreeImmutableDictionary);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindParseTreeReference && sysmelb_value_getReference(arguments[1], parseTree)->kind == ParseTreeImmutableDictionary);
     
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeSwitch, macroContext->sourcePosition);
-    node->switchExpression.value = arguments[0].parseTreeReference;
-    node->switchExpression.cases = arguments[1].parseTreeReference;
-
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = node
-    };
+    node->switchExpression.value = sysmelb_value_getReference(arguments[0], parseTree);
+    node->switchExpression.cases = sysmelb_value_getReference(arguments[1], parseTree);
+
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, node);
     return result;
 }
 
@@ -246,20 +217,17 @@ static sysmelb_Value_t sysmelb_SwitchWithCasesMacro(sysmelb_MacroContext_t *macr
 static sysmelb_Value_t sysmelb_MatchOfTypeWithPatterns(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    assert(arguments[1].kind == SysmelValueKindParseTreeReference);
-    assert(arguments[2].kind == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[2]) == SysmelValueKindParseTreeReference);
 
     sysmelb_ParseTreeNode_t *patternMatchingNode = sysmelb_newParseTreeNode(ParseTreeSwitchPatternMatching, macroContext->sourcePosition);
-    patternMatchingNode->switchPatternMatching.value = arguments[0].parseTreeReference;
-    patternMatchingNode->switchPatternMatching.valueSumType = arguments[1].parseTreeReference;
-    patternMatchingNode->switchPatternMatching.cases = arguments[2].parseTreeReference;
-
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = patternMatchingNode
-    };
+    patternMatchingNode->switchPatternMatching.value = sysmelb_value_getReference(arguments[0], parseTree);
+    patternMatchingNode->switchPatternMatching.valueSumType = sysmelb_value_getReference(arguments[1], parseTree);
+    patternMatchingNode->switchPatternMatching.cases = sysmelb_value_getReference(arguments[2], parseTree);
+
+    sysmelb_Value_t result = sysmelb_value_makeReference(
+        SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, patternMatchingNode);
     return result;
     abort();
 }
@@ -268,16 +236,13 @@ static sysmelb_Value_t sysmelb_print(size_t argumentCount, sysmelb_Value_t *argu
 {
     for(size_t i = 0; i < argumentCount; ++i)
     {
-        if(arguments[i].kind == SysmelValueKindStringReference)
-            printf("%.*s", (int)arguments[i].stringSize, arguments[i].string);
+        if(sysmelb_value_getKind(arguments[i]) == SysmelValueKindStringReference)
+            printf("%.*s", (int)sysmelb_value_getStringSize(arguments[i]), sysmelb_value_getString(arguments[i]));
         else
             sysmelb_printValue(arguments[i]);
     }
         
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->null
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->null);
     return result;
 }
 
@@ -285,27 +250,24 @@ static sysmelb_Value_t sysmelb_printLine(size_t argumentCount, sysmelb_Value_t *
 {
     for(size_t i = 0; i < argumentCount; ++i)
     {
-        if(arguments[i].kind == SysmelValueKindStringReference)
-            printf("%.*s", (int)arguments[i].stringSize, arguments[i].string);
+        if(sysmelb_value_getKind(arguments[i]) == SysmelValueKindStringReference)
+            printf("%.*s", (int)sysmelb_value_getStringSize(arguments[i]), sysmelb_value_getString(arguments[i]));
         else
             sysmelb_printValue(arguments[i]);
     }
         
     printf("\n");
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->null
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->null);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_readWholeFileAsText(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
 
-    char* nameCString = calloc(arguments[0].stringSize + 1, 1);
-    memcpy(nameCString, arguments[0].string, arguments[0].stringSize);
+    char* nameCString = calloc(sysmelb_value_getStringSize(arguments[0]) + 1, 1);
+    memcpy(nameCString, sysmelb_value_getString(arguments[0]), sysmelb_value_getStringSize(arguments[0]));
 
     FILE *file = fopen(nameCString, "rb");
     if(!file)
@@ -328,23 +290,18 @@ static sysmelb_Value_t sysmelb_readWholeFileAsText(size_t argumentCount, sysmelb
     free(nameCString);
     fclose(file);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindStringReference,
-        .type = sysmelb_getBasicTypes()->string,
-        .stringSize = fileSize,
-        .string = fileData
-    };
+    sysmelb_Value_t result = sysmelb_value_makeString(fileSize, fileData);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_writeWholeFileWithBinaryData(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
-    assert(arguments[1].kind == SysmelValueKindByteArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindByteArrayReference);
 
-    char* nameCString = calloc(arguments[0].stringSize + 1, 1);
-    memcpy(nameCString, arguments[0].string, arguments[0].stringSize);
+    char* nameCString = calloc(sysmelb_value_getStringSize(arguments[0]) + 1, 1);
+    memcpy(nameCString, sysmelb_value_getString(arguments[0]), sysmelb_value_getStringSize(arguments[0]));
 
     FILE *file = fopen(nameCString, "wb");
     if(!file)
@@ -353,7 +310,7 @@ static sysmelb_Value_t sysmelb_writeWholeFileWithBinaryData(size_t argumentCount
         abort();
     }
 
-    if(fwrite(arguments[1].byteArrayReference->elements, arguments[1].byteArrayReference->size, 1, file) != 1)
+    if(fwrite(sysmelb_value_getReference(arguments[1], byteArray)->elements, sysmelb_value_getReference(arguments[1], byteArray)->size, 1, file) != 1)
     {
         fprintf(stderr, "Failed to write file %s.", nameCString);
         abort();
@@ -362,10 +319,7 @@ static sysmelb_Value_t sysmelb_writeWholeFileWithBinaryData(size_t argumentCount
     free(nameCString);
     fclose(file);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->voidType
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
     return result;
 }
 
@@ -381,31 +335,27 @@ static sysmelb_Value_t sysmelb_RecordWithFieldsMacro(sysmelb_MacroContext_t *mac
     assert(argumentCount == 2);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
-    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[1].parseTreeReference);
-    if(dictionaryWithFieldAndType.kind != SysmelValueKindImmutableDictionaryReference)
+    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[1], parseTree));
+    if(sysmelb_value_getKind(dictionaryWithFieldAndType) != SysmelValueKindImmutableDictionaryReference)
     {
-        sysmelb_errorPrintf(arguments[1].parseTreeReference->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[1], parseTree)->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
         abort();
     }
 
-    sysmelb_Type_t *recordType = sysmelb_allocateRecordType(name, dictionaryWithFieldAndType.immutableDictionaryReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = recordType
-    };
+    sysmelb_Type_t *recordType = sysmelb_allocateRecordType(name, sysmelb_value_getReference(dictionaryWithFieldAndType, immutableDictionary));
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, recordType);
     
     if(name)
     {
@@ -421,31 +371,27 @@ static sysmelb_Value_t sysmelb_ClassWithFieldsMacro(sysmelb_MacroContext_t *macr
     assert(argumentCount == 2);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
-    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[1].parseTreeReference);
-    if(dictionaryWithFieldAndType.kind != SysmelValueKindImmutableDictionaryReference)
+    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[1], parseTree));
+    if(sysmelb_value_getKind(dictionaryWithFieldAndType) != SysmelValueKindImmutableDictionaryReference)
     {
-        sysmelb_errorPrintf(arguments[1].parseTreeReference->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[1], parseTree)->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
         abort();
     }
 
-    sysmelb_Type_t *classType = sysmelb_allocateClassType(name, NULL, dictionaryWithFieldAndType.immutableDictionaryReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = classType
-    };
+    sysmelb_Type_t *classType = sysmelb_allocateClassType(name, NULL, sysmelb_value_getReference(dictionaryWithFieldAndType, immutableDictionary));
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, classType);
     
     if(name)
     {
@@ -462,38 +408,34 @@ static sysmelb_Value_t sysmelb_ClassWithSuperclassFieldsMacro(sysmelb_MacroConte
     assert(argumentCount == 3);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
-    sysmelb_Value_t superclassValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[1].parseTreeReference);
-    if(superclassValue.kind != SysmelValueKindTypeReference)
+    sysmelb_Value_t superclassValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[1], parseTree));
+    if(sysmelb_value_getKind(superclassValue) != SysmelValueKindTypeReference)
     {
-        sysmelb_errorPrintf(arguments[1].parseTreeReference->sourcePosition, "A superclass type is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[1], parseTree)->sourcePosition, "A superclass type is expected.");
         abort();
 
     }
-    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[2].parseTreeReference);
-    if(dictionaryWithFieldAndType.kind != SysmelValueKindImmutableDictionaryReference)
+    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[2], parseTree));
+    if(sysmelb_value_getKind(dictionaryWithFieldAndType) != SysmelValueKindImmutableDictionaryReference)
     {
-        sysmelb_errorPrintf(arguments[2].parseTreeReference->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[2], parseTree)->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
         abort();
     }
 
-    sysmelb_Type_t *classType = sysmelb_allocateClassType(name, superclassValue.typeReference, dictionaryWithFieldAndType.immutableDictionaryReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = classType
-    };
+    sysmelb_Type_t *classType = sysmelb_allocateClassType(name, sysmelb_value_getReference(superclassValue, type), sysmelb_value_getReference(dictionaryWithFieldAndType, immutableDictionary));
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, classType);
     
     if(name)
     {
@@ -509,26 +451,26 @@ static sysmelb_Value_t sysmelb_InductiveWithAlternativesMacro(sysmelb_MacroConte
     assert(argumentCount == 2);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
     sysmelb_Value_t alternatives = arguments[1];
-    if(alternatives.parseTreeReference->kind != ParseTreeArray)
+    if(sysmelb_value_getReference(alternatives, parseTree)->kind != ParseTreeArray)
     {
         sysmelb_errorPrintf(macroContext->sourcePosition, "Expected an array of alternative types.");
         abort();
     }
 
-    sysmelb_ParseTreeNode_t *alternativesArray = alternatives.parseTreeReference;
+    sysmelb_ParseTreeNode_t *alternativesArray = sysmelb_value_getReference(alternatives, parseTree);
     uint32_t alternativeCount = alternativesArray->array.elements.size;
     sysmelb_Type_t *sumType = sysmelb_allocateSumType(name, alternativeCount);
 
@@ -542,16 +484,12 @@ static sysmelb_Value_t sysmelb_InductiveWithAlternativesMacro(sysmelb_MacroConte
     {
         sysmelb_ParseTreeNode_t *alternativeNode = alternativesArray->array.elements.elements[i];
         sysmelb_Value_t alternativeValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, alternativeNode);
-        if (alternativeValue.kind != SysmelValueKindTypeReference)
+        if (sysmelb_value_getKind(alternativeValue) != SysmelValueKindTypeReference)
             sysmelb_errorPrintf(alternativeNode->sourcePosition, "Expected a type to be part of the sum type.");
-        sumType->sumType.alternatives[i] = alternativeValue.typeReference;
+        sumType->sumType.alternatives[i] = sysmelb_value_getReference(alternativeValue, type);
     }
 
-    sysmelb_Value_t sumTypeValue = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = sumType
-    };
+    sysmelb_Value_t sumTypeValue = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, sumType);
 
     return sumTypeValue;
 }
@@ -561,38 +499,34 @@ static sysmelb_Value_t sysmelb_EnumWithBaseTypeAndValuesMacro(sysmelb_MacroConte
     assert(argumentCount == 3);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
-    sysmelb_Value_t baseTypeValue =  sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[1].parseTreeReference);
-    if(baseTypeValue.kind != SysmelValueKindTypeReference)
+    sysmelb_Value_t baseTypeValue =  sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[1], parseTree));
+    if(sysmelb_value_getKind(baseTypeValue) != SysmelValueKindTypeReference)
     {
-        sysmelb_errorPrintf(arguments[1].parseTreeReference->sourcePosition, "A base type specification is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[1], parseTree)->sourcePosition, "A base type specification is expected.");
         abort();
     }
 
-    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[2].parseTreeReference);
-    if(dictionaryWithFieldAndType.kind != SysmelValueKindImmutableDictionaryReference)
+    sysmelb_Value_t dictionaryWithFieldAndType = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[2], parseTree));
+    if(sysmelb_value_getKind(dictionaryWithFieldAndType) != SysmelValueKindImmutableDictionaryReference)
     {
-        sysmelb_errorPrintf(arguments[2].parseTreeReference->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
+        sysmelb_errorPrintf(sysmelb_value_getReference(arguments[2], parseTree)->sourcePosition, "An ImmutableDictionar with field names and types is expected.");
         abort();
     }
 
-    sysmelb_Type_t *enumType = sysmelb_allocateEnumType(name, baseTypeValue.typeReference, dictionaryWithFieldAndType.immutableDictionaryReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = enumType
-    };
+    sysmelb_Type_t *enumType = sysmelb_allocateEnumType(name, sysmelb_value_getReference(baseTypeValue, type), sysmelb_value_getReference(dictionaryWithFieldAndType, immutableDictionary));
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, enumType);
     
     if(name)
     {
@@ -608,16 +542,16 @@ static sysmelb_Value_t sysmelb_NamespaceDefinitionMacro(sysmelb_MacroContext_t *
     assert(argumentCount == 2);
     sysmelb_symbol_t *name = NULL;
 
-    if (arguments[0].parseTreeReference->kind == ParseTreeIdentifierReference)
-        name = arguments[0].parseTreeReference->identifierReference.identifier;
-    else if (arguments[0].parseTreeReference->kind == ParseTreeLiteralSymbolNode)
-        name = arguments[0].parseTreeReference->literalSymbol.internedSymbol;
+    if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeIdentifierReference)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->identifierReference.identifier;
+    else if (sysmelb_value_getReference(arguments[0], parseTree)->kind == ParseTreeLiteralSymbolNode)
+        name = sysmelb_value_getReference(arguments[0], parseTree)->literalSymbol.internedSymbol;
     else
     {
-        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-        if(nameValue.kind != SysmelValueKindSymbolReference)
+        sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+        if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
             sysmelb_errorPrintf(macroContext->sourcePosition, "A non-valid name object is being passed.");
-        name = nameValue.symbolReference;
+        name = sysmelb_value_getReference(nameValue, symbol);
     }
 
     sysmelb_Namespace_t *currentNamespace = sysmelb_lookEnvironmentForNamespace(macroContext->environment);
@@ -625,13 +559,9 @@ static sysmelb_Value_t sysmelb_NamespaceDefinitionMacro(sysmelb_MacroContext_t *
 
     sysmelb_ParseTreeNode_t *node = sysmelb_newParseTreeNode(ParseTreeNamespaceDefinition, macroContext->sourcePosition);
     node->namespaceDefinition.namespace = childNamespace;
-    node->namespaceDefinition.definition = arguments[1].parseTreeReference;
+    node->namespaceDefinition.definition = sysmelb_value_getReference(arguments[1], parseTree);
     
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = node
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, node);
     return result;
 }
 
@@ -639,42 +569,36 @@ static sysmelb_Value_t sysmelb_PublicMacro(sysmelb_MacroContext_t *macroContext,
 {
     assert(argumentCount == 1);
     sysmelb_Value_t argument = arguments[0];
-    if(argument.parseTreeReference->kind != ParseTreeArray)
+    if(sysmelb_value_getReference(argument, parseTree)->kind != ParseTreeArray)
     {
         sysmelb_errorPrintf(macroContext->sourcePosition, "Expected an array to public objects.");
         abort();
     }
 
     sysmelb_Namespace_t *ownerNamespace = sysmelb_lookEnvironmentForNamespace(macroContext->environment);
-    uint32_t elementCount = argument.parseTreeReference->array.elements.size;
-    sysmelb_Value_t lastElement = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->voidType,
-    };
+    uint32_t elementCount = sysmelb_value_getReference(argument, parseTree)->array.elements.size;
+    sysmelb_Value_t lastElement = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
     
     for(uint32_t i = 0; i < elementCount; ++i)
     {
-        sysmelb_ParseTreeNode_t *elementToExport = argument.parseTreeReference->array.elements.elements[i];
+        sysmelb_ParseTreeNode_t *elementToExport = sysmelb_value_getReference(argument, parseTree)->array.elements.elements[i];
         sysmelb_Value_t valueToExport = sysmelb_analyzeAndEvaluateScript(macroContext->environment, elementToExport);
-        switch(valueToExport.kind)
+        switch(sysmelb_value_getKind(valueToExport))
         {
         case SysmelValueKindTypeReference:
         {
-            if(valueToExport.typeReference->name)
-                sysmelb_namespace_exportValueWithName(ownerNamespace, valueToExport.typeReference->name, &valueToExport);
-            if(valueToExport.typeReference->kind == SysmelTypeKindSum)
+            if(sysmelb_value_getReference(valueToExport, type)->name)
+                sysmelb_namespace_exportValueWithName(ownerNamespace, sysmelb_value_getReference(valueToExport, type)->name, &valueToExport);
+            if(sysmelb_value_getReference(valueToExport, type)->kind == SysmelTypeKindSum)
             {
-                uint32_t alternatives = valueToExport.typeReference->sumType.alternativeCount;
+                uint32_t alternatives = sysmelb_value_getReference(valueToExport, type)->sumType.alternativeCount;
                 for(uint32_t i = 0; i < alternatives; ++i)
                 {
-                    sysmelb_Type_t *alternativeType = valueToExport.typeReference->sumType.alternatives[i];
+                    sysmelb_Type_t *alternativeType = sysmelb_value_getReference(valueToExport, type)->sumType.alternatives[i];
                     if(alternativeType->name)
                     {
-                        sysmelb_Value_t alternativeTypeValue = {
-                            .kind = SysmelValueKindTypeReference,
-                            .type = sysmelb_getBasicTypes()->universe,
-                            .typeReference = alternativeType,
-                        };
+                        sysmelb_Value_t alternativeTypeValue = sysmelb_value_makeReference(
+                            SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, alternativeType);
                         sysmelb_namespace_exportValueWithName(ownerNamespace, alternativeType->name, &alternativeTypeValue);
                     }
                 }
@@ -683,10 +607,10 @@ static sysmelb_Value_t sysmelb_PublicMacro(sysmelb_MacroContext_t *macroContext,
             break;
         case SysmelValueKindFunctionReference:
         {
-            if(!valueToExport.functionReference->name)
+            if(!sysmelb_value_getReference(valueToExport, function)->name)
                 sysmelb_errorPrintf(elementToExport->sourcePosition, "Cannot export function without a name.");
             else
-                sysmelb_namespace_exportValueWithName(ownerNamespace, valueToExport.functionReference->name, &valueToExport);
+                sysmelb_namespace_exportValueWithName(ownerNamespace, sysmelb_value_getReference(valueToExport, function)->name, &valueToExport);
         }
             break;
         default:
@@ -702,29 +626,29 @@ static sysmelb_Value_t sysmelb_PublicMacro(sysmelb_MacroContext_t *macroContext,
 static sysmelb_Value_t sysmelb_loadFileOnceMacro(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    sysmelb_Value_t sourceName = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
-    if(sourceName.kind != SysmelValueKindStringReference)
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    sysmelb_Value_t sourceName = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
+    if(sysmelb_value_getKind(sourceName) != SysmelValueKindStringReference)
     {
         sysmelb_errorPrintf(macroContext->sourcePosition, "Expected a string value for loading file.");
         abort();
     }
     sysmelb_SourceCode_t *loaderSourceCode = macroContext->sourcePosition.sourceCode;
     size_t directorySize = strlen(loaderSourceCode->directory);
-    size_t baseNameSize = sourceName.stringSize;
+    size_t baseNameSize = sysmelb_value_getStringSize(sourceName);
 
     char *fullName = sysmelb_allocate(directorySize + baseNameSize + 1);
     memcpy(fullName, loaderSourceCode->directory, directorySize);
-    memcpy(fullName + directorySize, sourceName.string, sourceName.stringSize);
+    memcpy(fullName + directorySize, sysmelb_value_getString(sourceName), sysmelb_value_getStringSize(sourceName));
 
     sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromFileNamed(fullName);
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
     sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
     sysmelb_ParseTreeNode_t *parseTree = parseTokenList(sourceCode, scannedTokens.size, scannedTokens.tokens);
+    sysmelb_scratch_endScope(scratchScope);
     if(sysmelb_visitForDisplayingAndCountingErrors(parseTree) != 0)
     {
-        sysmelb_Value_t nullResult = {
-            .type = sysmelb_getBasicTypes()->null
-        };
+        sysmelb_Value_t nullResult = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
         return nullResult;
     }
     
@@ -732,33 +656,29 @@ static sysmelb_Value_t sysmelb_loadFileOnceMacro(sysmelb_MacroContext_t *macroCo
     
     
     sysmelb_Environment_t *environment = sysmelb_module_createTopLevelEnvironment(currentModule);
-    return sysmelb_analyzeAndEvaluateScript(environment, parseTree);
+    sysmelb_Value_t result = sysmelb_analyzeAndEvaluateScript(environment, parseTree);
+    sysmelb_gc_safePoint();
+    return result;
 }
 
 static sysmelb_Value_t sysmelb_assertMacro(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {   assert(argumentCount == 1);
     sysmelb_ParseTreeNode_t *assertionNode = sysmelb_newParseTreeNode(ParseTreeAssertNode, macroContext->sourcePosition);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    assertionNode->assertNode.condition = arguments[0].parseTreeReference;
-
-    sysmelb_Value_t resultValue = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = assertionNode,
-    };
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    assertionNode->assertNode.condition = sysmelb_value_getReference(arguments[0], parseTree);
+
+    sysmelb_Value_t resultValue = sysmelb_value_makeReference(
+        SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, assertionNode);
     return resultValue;
 }
 
 static sysmelb_Value_t sysmelb_setMainEntryPointMacro(sysmelb_MacroContext_t *macroContext, size_t argumentCount, sysmelb_Value_t *arguments)
 {   assert(argumentCount == 1);
-    sysmelb_Value_t entryPointFunction = sysmelb_analyzeAndEvaluateScript(macroContext->environment, arguments[0].parseTreeReference);
+    sysmelb_Value_t entryPointFunction = sysmelb_analyzeAndEvaluateScript(macroContext->environment, sysmelb_value_getReference(arguments[0], parseTree));
     sysmelb_Module_t *module = sysmelb_lookEnvironmentForModule(macroContext->environment);
     module->mainEntryPointFunction = entryPointFunction;
 
-    sysmelb_Value_t resultValue = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->voidType,
-    };
+    sysmelb_Value_t resultValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
     return resultValue;
 }
 
@@ -788,42 +708,28 @@ sysmelb_Environment_t *sysmelb_getOrCreateIntrinsicsEnvironment()
 
     // null
     {
-        sysmelb_Value_t nullValue = {
-            .kind = SysmelValueKindNull,
-            .type = sysmelb_getBasicTypes()->null
-        };
+        sysmelb_Value_t nullValue = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
 
         sysmelb_Environment_setLocalSymbolBinding(&sysmelb_IntrinsicsEnvironment, sysmelb_internSymbolC("null"), sysmelb_createSymbolValueBinding(nullValue));        
     }
 
     // void
     {
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
 
         sysmelb_Environment_setLocalSymbolBinding(&sysmelb_IntrinsicsEnvironment, sysmelb_internSymbolC("void"), sysmelb_createSymbolValueBinding(voidValue));        
     }
 
     // Boolean false
     {
-        sysmelb_Value_t booleanFalse = {
-            .kind = SysmelValueKindBoolean,
-            .type = sysmelb_getBasicTypes()->boolean,
-            .boolean = false,
-        };
+        sysmelb_Value_t booleanFalse = sysmelb_value_makeBoolean(false);
 
         sysmelb_Environment_setLocalSymbolBinding(&sysmelb_IntrinsicsEnvironment, sysmelb_internSymbolC("false"), sysmelb_createSymbolValueBinding(booleanFalse));        
     }
 
     // Boolean true
     {
-        sysmelb_Value_t booleanTrue = {
-            .kind = SysmelValueKindBoolean,
-            .type = sysmelb_getBasicTypes()->boolean,
-            .boolean = true,
-        };
+        sysmelb_Value_t booleanTrue = sysmelb_value_makeBoolean(true);
 
         sysmelb_Environment_setLocalSymbolBinding(&sysmelb_IntrinsicsEnvironment, sysmelb_internSymbolC("true"), sysmelb_createSymbolValueBinding(booleanTrue));
     }
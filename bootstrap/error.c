@@ -7,6 +7,8 @@ void sysmelb_errorPrintf(sysmelb_SourcePosition_t sourcePosition, const char *fo
     va_list args;
     va_start (args, format);
 
+    // Errors are followed by an abort, which discards buffered output.
+    fflush(stdout);
     if(sourcePosition.sourceCode)
     {
         if(sourcePosition.sourceCode->directory)
@@ -2,37 +2,52 @@
 #include "error.h"
 #include "memory.h"
 #include "value.h"
+#include "gc.h"
+#include "method-cache.h"
 #include <string.h>
 
 #define SYSMEL_BYTECODE_MAX_TEMPORARY_COUNT 512
-#define SYSMEL_BYTECODE_MAX_STACK_DEPTH 64
-
+#define SYSMEL_VM_STACK_BLOCK_SLOT_COUNT (64*1024)
+
+// The interpreter jumps directly from one instruction handler to the next
+// with computed gotos when the compiler supports them. Building with
+// SYSMELB_SWITCH_DISPATCH defined uses a portable switch instead.
+#if defined(__GNUC__) && !defined(SYSMELB_SWITCH_DISPATCH)
+#define SYSMELB_THREADED_DISPATCH
+#endif
+
+// Instructions are 8 bytes. Literals live in the constant pool of the
+// function, message selectors in the inline cache of each send, and source
+// positions in a side table that is only looked up for errors and profiling.
 typedef struct sysmelb_FunctionInstruction_s {
-    sysmelb_FunctionOpcode_t opcode;
+    uint8_t opcode;
     union
     {
-        uint16_t argumentIndex;
-        sysmelb_Value_t literalValue;
         uint16_t applicationArgumentCount;
-
-        struct
-        {
-            uint16_t messageSendArguments;
-            sysmelb_symbol_t *messageSendSelector;
-        };
-
-        uint16_t temporaryIndex;
-        int16_t jumpOffset;
-
+        uint16_t messageSendArguments;
         uint16_t arraySize;
         uint16_t dictionarySize;
         uint16_t tupleSize;
-
-        sysmelb_SourcePosition_t lastSourcePosition;
-        sysmelb_SourcePosition_t assertPosition;
+    };
+    union
+    {
+        uint32_t literalIndex;
+        uint32_t sendCacheIndex;
+        uint16_t argumentIndex;
+        uint16_t temporaryIndex;
+        int32_t jumpOffset;
     };
 } sysmelb_FunctionInstruction_t;
 
+_Static_assert(sizeof(sysmelb_FunctionInstruction_t) == 8, "Bytecode instructions must be 8 bytes");
+
+// The source position of an instruction is the one of the last entry whose pc
+// is not after it.
+typedef struct sysmelb_BytecodeSourcePosition_s {
+    uint32_t pc;
+    sysmelb_SourcePosition_t sourcePosition;
+} sysmelb_BytecodeSourcePosition_t;
+
 void sysmelb_bytecode_ensureCapacity(sysmelb_FunctionBytecode_t*bytecode)
 {
     if(bytecode->instructionSize < bytecode->instructionCapacity)
@@ -50,19 +65,131 @@ void sysmelb_bytecode_ensureCapacity(sysmelb_FunctionBytecode_t*bytecode)
     bytecode->instructionCapacity = newCapacity;
     bytecode->instructions = newStorage;
 }
-uint16_t sysmelb_bytecode_addInstruction(sysmelb_FunctionBytecode_t*bytecode, sysmelb_FunctionInstruction_t instructionToAdd)
+static int32_t sysmelb_bytecode_stackEffect(sysmelb_FunctionInstruction_t *instruction)
 {
+    switch(instruction->opcode)
+    {
+    case SysmelFunctionOpcodePushLiteral:
+    case SysmelFunctionOpcodePushArgument:
+    case SysmelFunctionOpcodePushCapture:
+    case SysmelFunctionOpcodePushTemporary:
+        return 1;
+    case SysmelFunctionOpcodePopAndStoreTemporary:
+    case SysmelFunctionOpcodePop:
+    case SysmelFunctionOpcodeIntegerEquals:
+    case SysmelFunctionOpcodeJumpIfFalse:
+    case SysmelFunctionOpcodeJumpIfTrue:
+    case SysmelFunctionOpcodeMakeAssociation:
+        return -1;
+    case SysmelFunctionOpcodeApplyFunction:
+        return -(int32_t)instruction->applicationArgumentCount;
+    case SysmelFunctionOpcodeSendMessage:
+        return -(int32_t)instruction->messageSendArguments;
+    case SysmelFunctionOpcodeMakeArray:
+    case SysmelFunctionOpcodeMakeByteArray:
+        return 1 - (int32_t)instruction->arraySize;
+    case SysmelFunctionOpcodeMakeImmutableDictionary:
+        return 1 - (int32_t)instruction->dictionarySize;
+    case SysmelFunctionOpcodeMakeTuple:
+        return 1 - (int32_t)instruction->tupleSize;
+    default:
+        return 0;
+    }
+}
+
+uint32_t sysmelb_bytecode_addInstruction(sysmelb_FunctionBytecode_t*bytecode, sysmelb_FunctionInstruction_t instructionToAdd)
+{
+    // Frames are allocated with the deepest operand stack seen while emitting.
+    int32_t stackEffect = sysmelb_bytecode_stackEffect(&instructionToAdd);
+    assert(stackEffect >= 0 || bytecode->stackDepth >= (uint32_t)-stackEffect);
+    bytecode->stackDepth += stackEffect;
+    if(bytecode->stackDepth > bytecode->maxStackDepth)
+        bytecode->maxStackDepth = bytecode->stackDepth;
+
     sysmelb_bytecode_ensureCapacity(bytecode);
-    uint16_t instructionIndex = bytecode->instructionSize;
+    uint32_t instructionIndex = bytecode->instructionSize;
     bytecode->instructions[bytecode->instructionSize++] = instructionToAdd;
+    bytecode->threadedCode = NULL;
     return instructionIndex;
 }
 
+static uint32_t sysmelb_bytecode_addLiteral(sysmelb_FunctionBytecode_t *bytecode, sysmelb_Value_t literal)
+{
+    if(bytecode->literalSize >= bytecode->literalCapacity)
+    {
+        uint32_t newCapacity = bytecode->literalCapacity * 2;
+        if(newCapacity < 8)
+            newCapacity = 8;
+
+        sysmelb_Value_t *newStorage = sysmelb_allocate(sizeof(sysmelb_Value_t) * newCapacity);
+        if(bytecode->literals && bytecode->literalSize > 0)
+            memcpy(newStorage, bytecode->literals, sizeof(sysmelb_Value_t)*bytecode->literalSize);
+
+        sysmelb_freeAllocation(bytecode->literals);
+        bytecode->literalCapacity = newCapacity;
+        bytecode->literals = newStorage;
+    }
+
+    uint32_t literalIndex = bytecode->literalSize;
+    bytecode->literals[bytecode->literalSize++] = literal;
+    return literalIndex;
+}
+
+static sysmelb_Value_t sysmelb_makeAssociationWith(sysmelb_Value_t key, sysmelb_Value_t value)
+{
+    sysmelb_Association_t *assoc = sysmelb_allocate(sizeof(sysmelb_Association_t));
+    assoc->key = key;
+    assoc->value = value;
+
+    return sysmelb_value_makeReference(SysmelValueKindAssociationReference, sysmelb_getBasicTypes()->association, assoc);
+}
+
+static sysmelb_Value_t sysmelb_makeImmutableDictionaryWithElements(uint16_t dictionarySize, sysmelb_Value_t *elements)
+{
+    sysmelb_ImmutableDictionary_t *dictionary = sysmelb_allocate(sizeof(sysmelb_ImmutableDictionary_t) + dictionarySize*sizeof(sysmelb_Association_t*));
+    dictionary->size = dictionarySize;
+    for(uint16_t i = 0; i < dictionarySize; ++i)
+    {
+        assert(sysmelb_value_getKind(elements[i]) == SysmelValueKindAssociationReference);
+        dictionary->elements[i] = sysmelb_value_getReference(elements[i], association);
+    }
+
+    return sysmelb_value_makeReference(SysmelValueKindImmutableDictionaryReference, sysmelb_getBasicTypes()->immutableDictionary, dictionary);
+}
+
+static sysmelb_Value_t sysmelb_makeArrayWithElements(uint16_t arraySize, sysmelb_Value_t *elements)
+{
+    sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + arraySize*sizeof(sysmelb_Value_t));
+    array->size = arraySize;
+    memcpy(array->elements, elements, arraySize*sizeof(sysmelb_Value_t));
+
+    return sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, array);
+}
+
+static sysmelb_Value_t sysmelb_makeByteArrayWithElements(uint16_t byteArraySize, sysmelb_Value_t *elements)
+{
+    sysmelb_ByteArrayHeader_t *byteArray = sysmelb_allocate(sizeof(sysmelb_ByteArrayHeader_t) + byteArraySize);
+    byteArray->size = byteArraySize;
+    for(uint16_t i = 0; i < byteArraySize; ++i)
+        byteArray->elements[i] = sysmelb_value_getInteger(elements[i]);
+
+    return sysmelb_value_makeReference(SysmelValueKindByteArrayReference, sysmelb_getBasicTypes()->byteArray, byteArray);
+}
+
+static sysmelb_Value_t sysmelb_makeTupleWithElements(uint16_t tupleSize, sysmelb_Value_t *elements)
+{
+    sysmelb_TupleHeader_t *tuple = sysmelb_allocate(sizeof(sysmelb_TupleHeader_t) + tupleSize*sizeof(sysmelb_Value_t));
+    tuple->size = tupleSize;
+    memcpy(tuple->elements, elements, tupleSize*sizeof(sysmelb_Value_t));
+
+    return sysmelb_value_makeReference(SysmelValueKindTupleReference, sysmelb_getBasicTypes()->tuple, tuple);
+}
+
 void sysmelb_bytecode_pushLiteral(sysmelb_FunctionBytecode_t *bytecode, sysmelb_Value_t *literal)
 {
     sysmelb_FunctionInstruction_t inst = {
         .opcode = SysmelFunctionOpcodePushLiteral,
-        .literalValue = *literal
+        .literalIndex = sysmelb_bytecode_addLiteral(bytecode, *literal)
     };
     sysmelb_bytecode_addInstruction(bytecode, inst);
 }
@@ -118,47 +245,53 @@ uint16_t sysmelb_bytecode_allocateTemporary(sysmelb_FunctionBytecode_t *bytecode
 }
 
 
-uint16_t sysmelb_bytecode_jump(sysmelb_FunctionBytecode_t *bytecode)
+uint32_t sysmelb_bytecode_jump(sysmelb_FunctionBytecode_t *bytecode)
 {
     sysmelb_FunctionInstruction_t inst = {
         .opcode = SysmelFunctionOpcodeJump,
-        .jumpOffset = 0
     };
-    return sysmelb_bytecode_addInstruction(bytecode, inst);
+    uint32_t jumpInstructionIndex = sysmelb_bytecode_addInstruction(bytecode, inst);
+    bytecode->instructions[jumpInstructionIndex].jumpOffset = (int32_t)bytecode->stackDepth;
+    return jumpInstructionIndex;
 }
 
-uint16_t sysmelb_bytecode_jumpIfFalse(sysmelb_FunctionBytecode_t *bytecode)
+uint32_t sysmelb_bytecode_jumpIfFalse(sysmelb_FunctionBytecode_t *bytecode)
 {
     sysmelb_FunctionInstruction_t inst = {
         .opcode = SysmelFunctionOpcodeJumpIfFalse,
-        .jumpOffset = 0
     };
-    return sysmelb_bytecode_addInstruction(bytecode, inst);
+    uint32_t jumpInstructionIndex = sysmelb_bytecode_addInstruction(bytecode, inst);
+    bytecode->instructions[jumpInstructionIndex].jumpOffset = (int32_t)bytecode->stackDepth;
+    return jumpInstructionIndex;
 }
 
-uint16_t sysmelb_bytecode_jumpIfTrue(sysmelb_FunctionBytecode_t *bytecode)
+uint32_t sysmelb_bytecode_jumpIfTrue(sysmelb_FunctionBytecode_t *bytecode)
 {
     sysmelb_FunctionInstruction_t inst = {
         .opcode = SysmelFunctionOpcodeJumpIfTrue,
-        .jumpOffset = 0
     };
-    return sysmelb_bytecode_addInstruction(bytecode, inst);
+    uint32_t jumpInstructionIndex = sysmelb_bytecode_addInstruction(bytecode, inst);
+    bytecode->instructions[jumpInstructionIndex].jumpOffset = (int32_t)bytecode->stackDepth;
+    return jumpInstructionIndex;
 }
 
-void sysmelb_bytecode_patchJumpToHere(sysmelb_FunctionBytecode_t *bytecode, uint16_t jumpInstructionIndex)
+// Until it is patched, a jump holds the operand stack depth after it, which is
+// also the depth at its target.
+void sysmelb_bytecode_patchJumpToHere(sysmelb_FunctionBytecode_t *bytecode, uint32_t jumpInstructionIndex)
 {
-    int16_t offset = bytecode->instructionSize - jumpInstructionIndex;
+    bytecode->stackDepth = (uint32_t)bytecode->instructions[jumpInstructionIndex].jumpOffset;
+    int32_t offset = (int32_t)(bytecode->instructionSize - jumpInstructionIndex);
     bytecode->instructions[jumpInstructionIndex].jumpOffset = offset;
 }
 
-uint16_t sysmelb_bytecode_label(sysmelb_FunctionBytecode_t *bytecode)
+uint32_t sysmelb_bytecode_label(sysmelb_FunctionBytecode_t *bytecode)
 {
     return bytecode->instructionSize;
 }
 
-void sysmelb_bytecode_patchJumpToLabel(sysmelb_FunctionBytecode_t *bytecode, uint16_t jumpInstructionIndex, uint16_t labelTarget)
+void sysmelb_bytecode_patchJumpToLabel(sysmelb_FunctionBytecode_t *bytecode, uint32_t jumpInstructionIndex, uint32_t labelTarget)
 {
-    int16_t offset = labelTarget - jumpInstructionIndex;
+    int32_t offset = (int32_t)(labelTarget - jumpInstructionIndex);
     bytecode->instructions[jumpInstructionIndex].jumpOffset = offset;
 }
 
@@ -181,11 +314,35 @@ void sysmelb_bytecode_applyFunction(sysmelb_FunctionBytecode_t *bytecode, uint16
     sysmelb_bytecode_addInstruction(bytecode, inst);
 }
 
+static uint32_t sysmelb_bytecode_addSendCache(sysmelb_FunctionBytecode_t *bytecode, sysmelb_symbol_t *selector)
+{
+    if(bytecode->sendCacheSize >= bytecode->sendCacheCapacity)
+    {
+        uint32_t newCapacity = bytecode->sendCacheCapacity * 2;
+        if(newCapacity < 4)
+            newCapacity = 4;
+
+        sysmelb_SendCache_t *newStorage = sysmelb_allocate(sizeof(sysmelb_SendCache_t) * newCapacity);
+        if(bytecode->sendCaches && bytecode->sendCacheSize > 0)
+            memcpy(newStorage, bytecode->sendCaches, sizeof(sysmelb_SendCache_t)*bytecode->sendCacheSize);
+
+        sysmelb_freeAllocation(bytecode->sendCaches);
+        bytecode->sendCacheCapacity = newCapacity;
+        bytecode->sendCaches = newStorage;
+    }
+
+    uint32_t sendCacheIndex = bytecode->sendCacheSize++;
+    sysmelb_SendCache_t *sendCache = bytecode->sendCaches + sendCacheIndex;
+    memset(sendCache, 0, sizeof(sysmelb_SendCache_t));
+    sendCache->selector = selector;
+    return sendCacheIndex;
+}
+
 void sysmelb_bytecode_sendMessage(sysmelb_FunctionBytecode_t *bytecode, sysmelb_symbol_t *selector, uint16_t argumentCount)
 {
     sysmelb_FunctionInstruction_t inst ={
         .opcode = SysmelFunctionOpcodeSendMessage,
-        .messageSendSelector = selector,
+        .sendCacheIndex = sysmelb_bytecode_addSendCache(bytecode, selector),
         .messageSendArguments = argumentCount
     };
 
@@ -240,6 +397,82 @@ void sysmelb_bytecode_makeTuple(sysmelb_FunctionBytecode_t *bytecode, uint16_t s
     sysmelb_bytecode_addInstruction(bytecode, inst);
 }
 
+bool sysmelb_bytecode_isSingleLiteralPushFrom(sysmelb_FunctionBytecode_t *bytecode, uint32_t instructionIndex)
+{
+    return bytecode->instructionSize == instructionIndex + 1
+        && bytecode->instructions[instructionIndex].opcode == SysmelFunctionOpcodePushLiteral;
+}
+
+// Constant aggregates are built once, and their trailing literal pushes are
+// replaced by a single push of the aggregate. Mutable aggregates are flagged
+// as literals, so that the mutation primitives reject them.
+static sysmelb_Value_t *sysmelb_bytecode_popLiteralPushes(sysmelb_FunctionBytecode_t *bytecode, uint16_t count)
+{
+    assert(bytecode->instructionSize >= count);
+    sysmelb_Value_t *literals = sysmelb_scratch_allocate(count*sizeof(sysmelb_Value_t));
+    sysmelb_FunctionInstruction_t *firstInstruction = bytecode->instructions + bytecode->instructionSize - count;
+    for(uint16_t i = 0; i < count; ++i)
+    {
+        assert(firstInstruction[i].opcode == SysmelFunctionOpcodePushLiteral);
+        literals[i] = bytecode->literals[firstInstruction[i].literalIndex];
+    }
+
+    // The pushed literals are the last ones in the pool, unless count is zero.
+    if(count > 0 && firstInstruction[0].literalIndex + count == bytecode->literalSize)
+        bytecode->literalSize -= count;
+
+    bytecode->instructionSize -= count;
+    bytecode->stackDepth -= count;
+    while(bytecode->sourcePositionSize > 0 && bytecode->sourcePositions[bytecode->sourcePositionSize - 1].pc > bytecode->instructionSize)
+        --bytecode->sourcePositionSize;
+    bytecode->threadedCode = NULL;
+    return literals;
+}
+
+void sysmelb_bytecode_makeLiteralAssociation(sysmelb_FunctionBytecode_t *bytecode)
+{
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+    sysmelb_Value_t *literals = sysmelb_bytecode_popLiteralPushes(bytecode, 2);
+    sysmelb_Value_t association = sysmelb_makeAssociationWith(literals[0], literals[1]);
+    sysmelb_scratch_endScope(scratchScope);
+    sysmelb_bytecode_pushLiteral(bytecode, &association);
+}
+
+void sysmelb_bytecode_makeLiteralArray(sysmelb_FunctionBytecode_t *bytecode, uint16_t size)
+{
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+    sysmelb_Value_t array = sysmelb_makeArrayWithElements(size, sysmelb_bytecode_popLiteralPushes(bytecode, size));
+    sysmelb_value_getReference(array, array)->isLiteral = true;
+    sysmelb_scratch_endScope(scratchScope);
+    sysmelb_bytecode_pushLiteral(bytecode, &array);
+}
+
+void sysmelb_bytecode_makeLiteralByteArray(sysmelb_FunctionBytecode_t *bytecode, uint16_t size)
+{
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+    sysmelb_Value_t byteArray = sysmelb_makeByteArrayWithElements(size, sysmelb_bytecode_popLiteralPushes(bytecode, size));
+    sysmelb_value_getReference(byteArray, byteArray)->isLiteral = true;
+    sysmelb_scratch_endScope(scratchScope);
+    sysmelb_bytecode_pushLiteral(bytecode, &byteArray);
+}
+
+void sysmelb_bytecode_makeLiteralImmutableDictionary(sysmelb_FunctionBytecode_t *bytecode, uint16_t size)
+{
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+    sysmelb_Value_t dictionary = sysmelb_makeImmutableDictionaryWithElements(size, sysmelb_bytecode_popLiteralPushes(bytecode, size));
+    sysmelb_scratch_endScope(scratchScope);
+    sysmelb_bytecode_pushLiteral(bytecode, &dictionary);
+}
+
+void sysmelb_bytecode_makeLiteralTuple(sysmelb_FunctionBytecode_t *bytecode, uint16_t size)
+{
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
+    sysmelb_Value_t tuple = sysmelb_makeTupleWithElements(size, sysmelb_bytecode_popLiteralPushes(bytecode, size));
+    sysmelb_value_getReference(tuple, tuple)->isLiteral = true;
+    sysmelb_scratch_endScope(scratchScope);
+    sysmelb_bytecode_pushLiteral(bytecode, &tuple);
+}
+
 void sysmelb_bytecode_getSumIndex(sysmelb_FunctionBytecode_t *bytecode)
 {
     sysmelb_FunctionInstruction_t inst ={
@@ -260,19 +493,59 @@ void sysmelb_bytecode_getSumInjectedValue(sysmelb_FunctionBytecode_t *bytecode)
 
 void sysmelb_bytecode_sourcePosition(sysmelb_FunctionBytecode_t *bytecode, sysmelb_SourcePosition_t sourcePosition)
 {
-    sysmelb_FunctionInstruction_t inst ={
-        .opcode = SysmelFunctionOpcodeSourcePosition,
-        .lastSourcePosition = sourcePosition
+    uint32_t pc = bytecode->instructionSize;
+    if(bytecode->sourcePositionSize > 0 && bytecode->sourcePositions[bytecode->sourcePositionSize - 1].pc == pc)
+    {
+        bytecode->sourcePositions[bytecode->sourcePositionSize - 1].sourcePosition = sourcePosition;
+        return;
+    }
+
+    if(bytecode->sourcePositionSize >= bytecode->sourcePositionCapacity)
+    {
+        uint32_t newCapacity = bytecode->sourcePositionCapacity * 2;
+        if(newCapacity < 8)
+            newCapacity = 8;
+
+        sysmelb_BytecodeSourcePosition_t *newStorage = sysmelb_allocate(sizeof(sysmelb_BytecodeSourcePosition_t) * newCapacity);
+        if(bytecode->sourcePositions && bytecode->sourcePositionSize > 0)
+            memcpy(newStorage, bytecode->sourcePositions, sizeof(sysmelb_BytecodeSourcePosition_t)*bytecode->sourcePositionSize);
+
+        sysmelb_freeAllocation(bytecode->sourcePositions);
+        bytecode->sourcePositionCapacity = newCapacity;
+        bytecode->sourcePositions = newStorage;
+    }
+
+    sysmelb_BytecodeSourcePosition_t entry = {
+        .pc = pc,
+        .sourcePosition = sourcePosition
     };
+    bytecode->sourcePositions[bytecode->sourcePositionSize++] = entry;
+}
 
-    sysmelb_bytecode_addInstruction(bytecode, inst);
+sysmelb_SourcePosition_t sysmelb_bytecode_sourcePositionAt(sysmelb_function_t *function, uint32_t pc)
+{
+    sysmelb_FunctionBytecode_t *bytecode = &function->bytecode;
+    uint32_t lower = 0;
+    uint32_t upper = bytecode->sourcePositionSize;
+    while(lower < upper)
+    {
+        uint32_t middle = lower + (upper - lower) / 2;
+        if(bytecode->sourcePositions[middle].pc <= pc)
+            lower = middle + 1;
+        else
+            upper = middle;
+    }
+
+    if(lower == 0)
+        return function->sourcePosition;
+    return bytecode->sourcePositions[lower - 1].sourcePosition;
 }
 
 void sysmelb_bytecode_assert(sysmelb_FunctionBytecode_t *bytecode, sysmelb_SourcePosition_t sourcePosition)
 {
+    sysmelb_bytecode_sourcePosition(bytecode, sourcePosition);
     sysmelb_FunctionInstruction_t inst ={
         .opcode = SysmelFunctionOpcodeAssert,
-        .assertPosition = sourcePosition
     };
 
     sysmelb_bytecode_addInstruction(bytecode, inst);
@@ -297,15 +570,128 @@ void sysmelb_bytecode_return(sysmelb_FunctionBytecode_t *bytecode)
 
 typedef struct sysmelb_bytecodeActivationContext_s
 {
-    sysmelb_Value_t calloutArguments[SYSMEL_MAX_ARGUMENT_COUNT + 1];
-    sysmelb_Value_t temporaryZone[SYSMEL_BYTECODE_MAX_TEMPORARY_COUNT];
-    sysmelb_Value_t stack[SYSMEL_BYTECODE_MAX_STACK_DEPTH];
+    struct sysmelb_bytecodeActivationContext_s *previousContext;
+    sysmelb_function_t *function;
+    size_t argumentCount;
+    sysmelb_Value_t *arguments;
+    uint32_t pc;
     uint32_t stackSize;
+
+    size_t frameSlotCount;
+    sysmelb_Value_t *temporaryZone;
+    sysmelb_Value_t *stack;
 } sysmelb_bytecodeActivationContext_t;
 
+#define SYSMELB_ACTIVATION_CONTEXT_SLOT_COUNT ((sizeof(sysmelb_bytecodeActivationContext_t) + sizeof(sysmelb_Value_t) - 1) / sizeof(sysmelb_Value_t))
+
+static sysmelb_bytecodeActivationContext_t *sysmelb_CurrentActivationContext;
+
+// The temporaries and the operand stack of each activation are allocated
+// with their exact size on the VM stack. The VM stack is a list of blocks
+// that are kept for reuse, so that frames never move.
+typedef struct sysmelb_VMStackBlock_s
+{
+    struct sysmelb_VMStackBlock_s *previousBlock;
+    struct sysmelb_VMStackBlock_s *nextBlock;
+    size_t capacity;
+    size_t used;
+    sysmelb_Value_t slots[];
+} sysmelb_VMStackBlock_t;
+
+static sysmelb_VMStackBlock_t *sysmelb_CurrentVMStackBlock;
+
+static sysmelb_VMStackBlock_t *sysmelb_vmStack_advanceBlock(size_t slotCount)
+{
+    sysmelb_VMStackBlock_t *nextBlock = sysmelb_CurrentVMStackBlock ? sysmelb_CurrentVMStackBlock->nextBlock : NULL;
+    if(nextBlock && nextBlock->capacity < slotCount)
+    {
+        sysmelb_CurrentVMStackBlock->nextBlock = NULL;
+        while(nextBlock)
+        {
+            sysmelb_VMStackBlock_t *blockToFree = nextBlock;
+            nextBlock = nextBlock->nextBlock;
+            free(blockToFree);
+        }
+    }
+
+    if(!nextBlock)
+    {
+        size_t capacity = slotCount > SYSMEL_VM_STACK_BLOCK_SLOT_COUNT ? slotCount : SYSMEL_VM_STACK_BLOCK_SLOT_COUNT;
+        nextBlock = malloc(sizeof(sysmelb_VMStackBlock_t) + capacity*sizeof(sysmelb_Value_t));
+        if(!nextBlock)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+
+        nextBlock->previousBlock = sysmelb_CurrentVMStackBlock;
+        nextBlock->nextBlock = NULL;
+        nextBlock->capacity = capacity;
+        if(sysmelb_CurrentVMStackBlock)
+            sysmelb_CurrentVMStackBlock->nextBlock = nextBlock;
+    }
+
+    nextBlock->used = 0;
+    sysmelb_CurrentVMStackBlock = nextBlock;
+    return nextBlock;
+}
+
+static sysmelb_Value_t *sysmelb_vmStack_allocateFrame(size_t slotCount)
+{
+    sysmelb_VMStackBlock_t *block = sysmelb_CurrentVMStackBlock;
+    if(!block || block->used + slotCount > block->capacity)
+        block = sysmelb_vmStack_advanceBlock(slotCount);
+
+    sysmelb_Value_t *frame = block->slots + block->used;
+    block->used += slotCount;
+    return frame;
+}
+
+static void sysmelb_vmStack_freeFrame(size_t slotCount)
+{
+    sysmelb_VMStackBlock_t *block = sysmelb_CurrentVMStackBlock;
+    assert(block->used >= slotCount);
+    block->used -= slotCount;
+    if(block->used == 0 && block->previousBlock)
+        sysmelb_CurrentVMStackBlock = block->previousBlock;
+}
+
+// An activation context is stored at the start of its frame, followed by the
+// temporaries and the operand stack.
+static sysmelb_bytecodeActivationContext_t *sysmelb_bytecodeActivationContext_enter(sysmelb_function_t *function, size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    uint32_t temporaryZoneSize = function->bytecode.temporaryZoneSize;
+    size_t frameSlotCount = SYSMELB_ACTIVATION_CONTEXT_SLOT_COUNT + temporaryZoneSize + function->bytecode.maxStackDepth;
+    sysmelb_Value_t *frame = sysmelb_vmStack_allocateFrame(frameSlotCount);
+
+    sysmelb_bytecodeActivationContext_t *context = (sysmelb_bytecodeActivationContext_t*)frame;
+    *context = (sysmelb_bytecodeActivationContext_t){
+        .previousContext = sysmelb_CurrentActivationContext,
+        .function = function,
+        .argumentCount = argumentCount,
+        .arguments = arguments,
+        .frameSlotCount = frameSlotCount,
+        .temporaryZone = frame + SYSMELB_ACTIVATION_CONTEXT_SLOT_COUNT,
+        .stack = frame + SYSMELB_ACTIVATION_CONTEXT_SLOT_COUNT + temporaryZoneSize,
+    };
+    memset(context->temporaryZone, 0, temporaryZoneSize*sizeof(sysmelb_Value_t));
+    sysmelb_CurrentActivationContext = context;
+
+    // The arguments of the call are marked through the new context.
+    sysmelb_gc_safePoint();
+    return context;
+}
+
+static void sysmelb_bytecodeActivationContext_leave(sysmelb_bytecodeActivationContext_t *context)
+{
+    assert(sysmelb_CurrentActivationContext == context);
+    sysmelb_CurrentActivationContext = context->previousContext;
+    sysmelb_vmStack_freeFrame(context->frameSlotCount);
+}
+
 void sysmelb_bytecodeActivationContext_push(sysmelb_bytecodeActivationContext_t *context, sysmelb_Value_t stackValue)
 {
-    assert(context->stackSize < SYSMEL_BYTECODE_MAX_STACK_DEPTH);
+    assert(context->stackSize < context->function->bytecode.maxStackDepth);
     context->stack[context->stackSize++] = stackValue;
 }
 
@@ -321,6 +707,52 @@ sysmelb_Value_t sysmelb_bytecodeActivationContext_top(sysmelb_bytecodeActivation
     return context->stack[context->stackSize - 1];
 }
 
+void sysmelb_bytecode_markReferences(sysmelb_FunctionBytecode_t *bytecode)
+{
+    sysmelb_gc_markPointer(bytecode->instructions);
+    sysmelb_gc_markPointer(bytecode->threadedCode);
+    sysmelb_gc_markPointer(bytecode->literals);
+    for(uint32_t i = 0; i < bytecode->literalSize; ++i)
+        sysmelb_gc_markValue(&bytecode->literals[i]);
+    sysmelb_gc_markPointer(bytecode->sourcePositions);
+    for(uint32_t i = 0; i < bytecode->sourcePositionSize; ++i)
+        sysmelb_gc_markSourcePosition(&bytecode->sourcePositions[i].sourcePosition);
+    sysmelb_gc_markPointer(bytecode->sendCaches);
+    for(uint32_t i = 0; i < bytecode->sendCacheSize; ++i)
+    {
+        sysmelb_SendCache_t *sendCache = bytecode->sendCaches + i;
+        sysmelb_gc_markPointer(sendCache->selector);
+        for(uint32_t j = 0; j < sendCache->entryCount && j < SYSMELB_SEND_CACHE_ENTRY_COUNT; ++j)
+            sysmelb_gc_markType(sendCache->entries[j].receiverType);
+    }
+}
+
+bool sysmelb_getCurrentInterpretedSourcePosition(sysmelb_SourcePosition_t *outSourcePosition)
+{
+    if(!sysmelb_CurrentActivationContext)
+        return false;
+
+    *outSourcePosition = sysmelb_bytecode_sourcePositionAt(sysmelb_CurrentActivationContext->function, sysmelb_CurrentActivationContext->pc);
+    return true;
+}
+
+void sysmelb_markActivationContexts(void)
+{
+    for(sysmelb_bytecodeActivationContext_t *context = sysmelb_CurrentActivationContext; context; context = context->previousContext)
+    {
+        sysmelb_Value_t functionValue = sysmelb_value_makeReference(
+            SysmelValueKindFunctionReference, sysmelb_getBasicTypes()->function, context->function);
+        sysmelb_gc_markValue(&functionValue);
+
+        for(size_t i = 0; i < context->argumentCount; ++i)
+            sysmelb_gc_markValue(&context->arguments[i]);
+        for(size_t i = 0; i < context->function->bytecode.temporaryZoneSize; ++i)
+            sysmelb_gc_markValue(&context->temporaryZone[i]);
+        for(size_t i = 0; i < context->stackSize; ++i)
+            sysmelb_gc_markValue(&context->stack[i]);
+    }
+}
+
 sysmelb_Value_t sysmelb_callFunctionWithArguments(sysmelb_function_t *function, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     switch(function->kind)
@@ -348,7 +780,7 @@ void sysmelb_disassemblyBytecodeFunction(sysmelb_function_t *function)
             printf("%04d Nop\n", pc);
             break;
         case SysmelFunctionOpcodePushLiteral:
-            printf("%04d PushLiteral\n", pc);
+            printf("%04d PushLiteral %d\n", pc, currentInstruction->literalIndex);
             break;
         case SysmelFunctionOpcodePushArgument:
             printf("%04d PushArgument %d\n", pc, currentInstruction->argumentIndex);
@@ -378,8 +810,11 @@ void sysmelb_disassemblyBytecodeFunction(sysmelb_function_t *function)
             printf("%04d ApplyFunction %d\n", pc, currentInstruction->applicationArgumentCount);
             break;
         case SysmelFunctionOpcodeSendMessage:
-            printf("%04d SendMessage %.*s %d\n", pc, currentInstruction->messageSendSelector->size, currentInstruction->messageSendSelector->string , currentInstruction->messageSendArguments);
+        {
+            sysmelb_symbol_t *selector = function->bytecode.sendCaches[currentInstruction->sendCacheIndex].selector;
+            printf("%04d SendMessage %.*s %d\n", pc, selector->size, selector->string , currentInstruction->messageSendArguments);
             break;
+        }
         case SysmelFunctionOpcodeJump:
             printf("%04d Jump %03d:%03d\n", pc, currentInstruction->jumpOffset,pc + currentInstruction->jumpOffset);
             break;
@@ -410,106 +845,197 @@ void sysmelb_disassemblyBytecodeFunction(sysmelb_function_t *function)
         case SysmelFunctionOpcodeAssert:
             printf("%04d Assert\n", pc);
             break;
-        case SysmelFunctionOpcodeSourcePosition:
-            printf("%04d SourcePosition\n", pc);
-            break;
         default: abort();
         }
     }
 }
 
+#ifdef SYSMELB_THREADED_DISPATCH
+// The handler of each instruction is resolved on the first call. An extra
+// handler after the last instruction ends the function.
+static void **sysmelb_bytecode_resolveThreadedCode(sysmelb_FunctionBytecode_t *bytecode, void *const *handlerAddresses, size_t handlerCount, void *endOfFunctionHandler)
+{
+    uint32_t instructionCount = bytecode->instructionSize;
+    void **threadedCode = sysmelb_allocate((instructionCount + 1) * sizeof(void*));
+    for(uint32_t i = 0; i < instructionCount; ++i)
+    {
+        sysmelb_FunctionOpcode_t opcode = bytecode->instructions[i].opcode;
+        if((size_t)opcode >= handlerCount || !handlerAddresses[opcode])
+            abort();
+        threadedCode[i] = handlerAddresses[opcode];
+    }
+    threadedCode[instructionCount] = endOfFunctionHandler;
+    bytecode->threadedCode = threadedCode;
+    return threadedCode;
+}
+#endif
+
+// Calls and returns between interpreted functions are done inside this loop,
+// with their frames on the VM stack. Only the calls to primitives, and the
+// primitives calling back into interpreted functions, nest on the C stack.
 sysmelb_Value_t sysmelb_interpretBytecodeFunction(sysmelb_function_t *function, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     //sysmelb_disassemblyBytecodeFunction(function);
-    sysmelb_SourcePosition_t lastSourcePosition = function->sourcePosition;
+    sysmelb_Value_t result;
+    sysmelb_bytecodeActivationContext_t *entryContext = sysmelb_bytecodeActivationContext_enter(function, argumentCount, arguments);
+    sysmelb_bytecodeActivationContext_t *context = entryContext;
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindNull,
-        .type = sysmelb_getBasicTypes()->null,
+    uint32_t pc = 0;
+    uint32_t temporaryZoneSize;
+    sysmelb_FunctionInstruction_t *instructions;
+    sysmelb_Value_t *literals;
+#ifdef SYSMELB_THREADED_DISPATCH
+    static void *const handlerAddresses[] = {
+#define SYSMELB_OPCODE_HANDLER_ADDRESS(opcode) [opcode] = &&opcode##Handler,
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeNop)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePushLiteral)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePushArgument)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePushCapture)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePushTemporary)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeStoreTemporary)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePopAndStoreTemporary)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodePop)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeReturn)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeIntegerEquals)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeApplyFunction)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeSendMessage)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeJump)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeJumpIfFalse)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeJumpIfTrue)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeMakeArray)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeMakeByteArray)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeMakeAssociation)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeMakeImmutableDictionary)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeMakeTuple)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeGetSumIndex)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeGetSumInjectedValue)
+        SYSMELB_OPCODE_HANDLER_ADDRESS(SysmelFunctionOpcodeAssert)
+#undef SYSMELB_OPCODE_HANDLER_ADDRESS
     };
-    
-    sysmelb_bytecodeActivationContext_t context = {};
 
-    uint32_t pc = 0;
-    uint32_t instructionCount = function->bytecode.instructionSize;
-    sysmelb_FunctionInstruction_t *instructions = function->bytecode.instructions;
-    while(pc < instructionCount)
+    void **threadedCode;
+    sysmelb_FunctionInstruction_t *currentInstruction;
+#define SYSMELB_RESOLVE_THREADED_CODE() do { \
+        threadedCode = function->bytecode.threadedCode; \
+        if(!threadedCode) \
+            threadedCode = sysmelb_bytecode_resolveThreadedCode(&function->bytecode, handlerAddresses, sizeof(handlerAddresses)/sizeof(handlerAddresses[0]), &&endOfFunction); \
+    } while(0)
+#define SYSMELB_OPCODE_HANDLER(opcode) opcode##Handler
+#define SYSMELB_DISPATCH_NEXT_OPCODE() do { \
+        currentInstruction = instructions + pc; \
+        goto *threadedCode[pc]; \
+    } while(0)
+#else
+#define SYSMELB_RESOLVE_THREADED_CODE() do {} while(0)
+#define SYSMELB_OPCODE_HANDLER(opcode) case opcode
+#define SYSMELB_DISPATCH_NEXT_OPCODE() break
+#endif
+
+    // Caches the current function in locals after a call or a return.
+#define SYSMELB_LOAD_ACTIVATION_CONTEXT() do { \
+        function = context->function; \
+        temporaryZoneSize = function->bytecode.temporaryZoneSize; \
+        instructions = function->bytecode.instructions; \
+        literals = function->bytecode.literals; \
+        SYSMELB_RESOLVE_THREADED_CODE(); \
+    } while(0)
+
+    sysmelb_function_t *calledFunction;
+    size_t calledArgumentCount;
+    sysmelb_Value_t *calledArguments;
+
+    SYSMELB_LOAD_ACTIVATION_CONTEXT();
+#ifdef SYSMELB_THREADED_DISPATCH
+    SYSMELB_DISPATCH_NEXT_OPCODE();
+#else
+dispatchLoop:
+    while(pc < function->bytecode.instructionSize)
     {
         sysmelb_FunctionInstruction_t *currentInstruction = instructions + pc;
         switch(currentInstruction->opcode)
         {
-        case SysmelFunctionOpcodeNop:
+#endif
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeNop):
             ++pc;
-            break;
-        case SysmelFunctionOpcodePushLiteral:
-            sysmelb_bytecodeActivationContext_push(&context, currentInstruction->literalValue);
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePushLiteral):
+            sysmelb_bytecodeActivationContext_push(context, literals[currentInstruction->literalIndex]);
             ++pc;
-            break;
-        case SysmelFunctionOpcodePushArgument:
-            assert(currentInstruction->argumentIndex < argumentCount);
-            sysmelb_bytecodeActivationContext_push(&context, arguments[currentInstruction->argumentIndex]);
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePushArgument):
+            assert(currentInstruction->argumentIndex < context->argumentCount);
+            sysmelb_bytecodeActivationContext_push(context, context->arguments[currentInstruction->argumentIndex]);
             ++pc;
-            break;
-        case SysmelFunctionOpcodePushCapture:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePushCapture):
             abort();
-        case SysmelFunctionOpcodePushTemporary:
-            assert(currentInstruction->temporaryIndex < SYSMEL_BYTECODE_MAX_TEMPORARY_COUNT);
-            sysmelb_bytecodeActivationContext_push(&context, context.temporaryZone[currentInstruction->temporaryIndex]);
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePushTemporary):
+            assert(currentInstruction->temporaryIndex < temporaryZoneSize);
+            sysmelb_bytecodeActivationContext_push(context, context->temporaryZone[currentInstruction->temporaryIndex]);
             ++pc;
-            break;
-        case SysmelFunctionOpcodeStoreTemporary:
-            assert(currentInstruction->temporaryIndex < SYSMEL_BYTECODE_MAX_TEMPORARY_COUNT);
-            context.temporaryZone[currentInstruction->temporaryIndex] = sysmelb_bytecodeActivationContext_top(&context);
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeStoreTemporary):
+            assert(currentInstruction->temporaryIndex < temporaryZoneSize);
+            context->temporaryZone[currentInstruction->temporaryIndex] = sysmelb_bytecodeActivationContext_top(context);
             ++pc;
-            break;
-        case SysmelFunctionOpcodePopAndStoreTemporary:
-            assert(currentInstruction->temporaryIndex < SYSMEL_BYTECODE_MAX_TEMPORARY_COUNT);
-            context.temporaryZone[currentInstruction->temporaryIndex] = sysmelb_bytecodeActivationContext_pop(&context);
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePopAndStoreTemporary):
+            assert(currentInstruction->temporaryIndex < temporaryZoneSize);
+            context->temporaryZone[currentInstruction->temporaryIndex] = sysmelb_bytecodeActivationContext_pop(context);
             ++pc;
-            break;
-        case SysmelFunctionOpcodePop:
-            sysmelb_bytecodeActivationContext_pop(&context);
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodePop):
+            sysmelb_bytecodeActivationContext_pop(context);
             ++pc;
-            break;
-        case SysmelFunctionOpcodeReturn:
-            result = sysmelb_bytecodeActivationContext_top(&context);
-            return result;
-        case SysmelFunctionOpcodeIntegerEquals:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeReturn):
+            result = sysmelb_bytecodeActivationContext_top(context);
+            goto returnFromFunction;
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeIntegerEquals):
         {
-            sysmelb_Value_t rightOperand = sysmelb_bytecodeActivationContext_pop(&context);
-            sysmelb_Value_t leftOperand = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(leftOperand.kind == SysmelValueKindInteger || leftOperand.kind == SysmelValueKindUnsignedInteger);
-            assert(rightOperand.kind == SysmelValueKindInteger || rightOperand.kind == SysmelValueKindUnsignedInteger);
+            sysmelb_Value_t rightOperand = sysmelb_bytecodeActivationContext_pop(context);
+            sysmelb_Value_t leftOperand = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(leftOperand) == SysmelValueKindInteger || sysmelb_value_getKind(leftOperand) == SysmelValueKindUnsignedInteger);
+            assert(sysmelb_value_getKind(rightOperand) == SysmelValueKindInteger || sysmelb_value_getKind(rightOperand) == SysmelValueKindUnsignedInteger);
             
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindBoolean,
-                .type = sysmelb_getBasicTypes()->boolean,
-                .boolean = leftOperand.integer == rightOperand.integer,
-            };
-            sysmelb_bytecodeActivationContext_push(&context, result);
+            sysmelb_Value_t result = sysmelb_value_makeBoolean(
+                sysmelb_value_getInteger(leftOperand) == sysmelb_value_getInteger(rightOperand));
+            sysmelb_bytecodeActivationContext_push(context, result);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeApplyFunction:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeApplyFunction):
             {
+                context->pc = pc;
+                // The arguments are passed in place, and popped after the call.
                 uint32_t applicationArgumentCount = currentInstruction->applicationArgumentCount;
                 uint32_t popCount = applicationArgumentCount;
-                for(uint32_t i = 0; i < popCount; ++i)
-                    context.calloutArguments[popCount - 1 - i] = sysmelb_bytecodeActivationContext_pop(&context);
-
-                sysmelb_Value_t calledFunction = sysmelb_bytecodeActivationContext_pop(&context);
-                switch(calledFunction.kind)
+                assert(context->stackSize >= popCount + 1);
+                sysmelb_Value_t *calloutArguments = context->stack + context->stackSize - popCount;
+                sysmelb_Value_t functionalValue = calloutArguments[-1];
+                switch(sysmelb_value_getKind(functionalValue))
                 {
                 case SysmelValueKindFunctionReference:
                     {
-                        sysmelb_Value_t value = sysmelb_callFunctionWithArguments(calledFunction.functionReference, popCount, context.calloutArguments);
-                        sysmelb_bytecodeActivationContext_push(&context, value);
+                        calledFunction = sysmelb_value_getReference(functionalValue, function);
+                        if(calledFunction->kind == SysmelFunctionKindInterpreted)
+                        {
+                            calledArgumentCount = popCount;
+                            calledArguments = calloutArguments;
+                            context->stackSize -= popCount + 1;
+                            goto callInterpretedFunction;
+                        }
+
+                        sysmelb_Value_t value = sysmelb_callFunctionWithArguments(calledFunction, popCount, calloutArguments);
+                        context->stackSize -= popCount + 1;
+                        sysmelb_bytecodeActivationContext_push(context, value);
                     }
                     break;
                 case SysmelValueKindTypeReference:
                 {
-                    sysmelb_Value_t instance = sysmelb_instantiateTypeWithArguments(calledFunction.typeReference, popCount, context.calloutArguments);
-                    sysmelb_bytecodeActivationContext_push(&context, instance);
+                    sysmelb_Value_t instance = sysmelb_instantiateTypeWithArguments(sysmelb_value_getReference(functionalValue, type), popCount, calloutArguments);
+                    context->stackSize -= popCount + 1;
+                    sysmelb_bytecodeActivationContext_push(context, instance);
                 }
                 break;
                 default:
@@ -517,332 +1043,303 @@ sysmelb_Value_t sysmelb_interpretBytecodeFunction(sysmelb_function_t *function,
                 }
 
                 ++pc;
-                break;
+                SYSMELB_DISPATCH_NEXT_OPCODE();
             }
-        case SysmelFunctionOpcodeSendMessage:
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeSendMessage):
             {
+                context->pc = pc;
+                sysmelb_SendCache_t *sendCache = function->bytecode.sendCaches + currentInstruction->sendCacheIndex;
+                sysmelb_symbol_t *selector = sendCache->selector;
                 uint32_t messageArgumentCount = currentInstruction->messageSendArguments;
                 uint32_t popCount = messageArgumentCount + /*receiver*/ 1;
-                for(uint32_t i = 0; i < popCount; ++i)
-                    context.calloutArguments[popCount - 1 - i] = sysmelb_bytecodeActivationContext_pop(&context);
-
-                sysmelb_Value_t receiver = context.calloutArguments[0];
-                if(receiver.kind == SysmelValueKindNull)
-                    receiver.type = sysmelb_getBasicTypes()->null;
-                assert(receiver.type != NULL);
-                sysmelb_function_t *method = sysmelb_type_lookupSelector(receiver.type, currentInstruction->messageSendSelector);
+                assert(context->stackSize >= popCount);
+                sysmelb_Value_t *calloutArguments = context->stack + context->stackSize - popCount;
+
+                sysmelb_Value_t receiver = calloutArguments[0];
+                if(sysmelb_value_getKind(receiver) == SysmelValueKindNull)
+                    sysmelb_value_setType(&receiver, sysmelb_getBasicTypes()->null);
+                assert(sysmelb_value_getType(receiver) != NULL);
+                sysmelb_function_t *method = sysmelb_sendCache_lookup(sendCache, sysmelb_value_getType(receiver));
+                sysmelb_Value_t sendResult;
                 bool isSynthetic = false;
                 if(!method)
                 {
-                    if(!strcmp("isNull", currentInstruction->messageSendSelector->string))
+                    if(selector == sysmelb_WellKnownSymbols.isNull)
                     {
-                        bool isNull = receiver.kind == SysmelValueKindNull;
-                        sysmelb_Value_t result = {
-                            .kind = SysmelValueKindBoolean,
-                            .boolean = isNull,
-                            .type = sysmelb_getBasicTypes()->boolean
-                        };
-                        sysmelb_bytecodeActivationContext_push(&context, result);
+                        bool isNull = sysmelb_value_getKind(receiver) == SysmelValueKindNull;
+                        sendResult = sysmelb_value_makeBoolean(isNull);
                         isSynthetic = true;
                     }
-                    else if (!strcmp("isNotNull", currentInstruction->messageSendSelector->string))
+                    else if (selector == sysmelb_WellKnownSymbols.isNotNull)
                     {
-                        bool isNotNull = receiver.kind != SysmelValueKindNull;
-                        sysmelb_Value_t result = {
-                            .kind = SysmelValueKindBoolean,
-                            .boolean = isNotNull,
-                            .type = sysmelb_getBasicTypes()->boolean
-                        };
-                        sysmelb_bytecodeActivationContext_push(&context, result);
+                        bool isNotNull = sysmelb_value_getKind(receiver) != SysmelValueKindNull;
+                        sendResult = sysmelb_value_makeBoolean(isNotNull);
                         isSynthetic = true;
                     }
-                    else if (!strcmp("==", currentInstruction->messageSendSelector->string))
+                    else if (selector == sysmelb_WellKnownSymbols.identityEquals)
                     {
-                        sysmelb_Value_t operand = context.calloutArguments[1];
-                        bool isIdentityEquals = receiver.kind == operand.kind
+                        sysmelb_Value_t operand = calloutArguments[1];
+                        bool isIdentityEquals = sysmelb_value_getKind(receiver) == sysmelb_value_getKind(operand)
                             && sysmelb_getValuePointer(receiver) == sysmelb_getValuePointer(operand);
 
-                        sysmelb_Value_t result = {
-                            .kind = SysmelValueKindBoolean,
-                            .boolean = isIdentityEquals,
-                            .type = sysmelb_getBasicTypes()->boolean
-                        };
-                        sysmelb_bytecodeActivationContext_push(&context, result);
+                        sendResult = sysmelb_value_makeBoolean(isIdentityEquals);
                         isSynthetic = true;
                     }
-                    else if (!strcmp("~~", currentInstruction->messageSendSelector->string))
+                    else if (selector == sysmelb_WellKnownSymbols.identityNotEquals)
                     {
-                        sysmelb_Value_t operand = context.calloutArguments[1];
-                        bool isIdentityEquals = receiver.kind == operand.kind
+                        sysmelb_Value_t operand = calloutArguments[1];
+                        bool isIdentityEquals = sysmelb_value_getKind(receiver) == sysmelb_value_getKind(operand)
                             && sysmelb_getValuePointer(receiver) == sysmelb_getValuePointer(operand);
 
-                        sysmelb_Value_t result = {
-                            .kind = SysmelValueKindBoolean,
-                            .boolean = !isIdentityEquals,
-                            .type = sysmelb_getBasicTypes()->boolean
-                        };
-                        sysmelb_bytecodeActivationContext_push(&context, result);
+                        sendResult = sysmelb_value_makeBoolean(!isIdentityEquals);
                         isSynthetic = true;
                     }
 
-                    if(receiver.kind == SysmelValueKindTupleReference && receiver.type->kind == SysmelTypeKindRecord)
+                    if(sysmelb_value_getKind(receiver) == SysmelValueKindTupleReference && sysmelb_value_getType(receiver)->kind == SysmelTypeKindRecord)
                     {
                         if (messageArgumentCount == 0)
                         {
-                            int recordFieldIndex = sysmelb_findIndexOfFieldNamed(receiver.type, currentInstruction->messageSendSelector);
+                            int recordFieldIndex = sysmelb_findIndexOfFieldNamed(sysmelb_value_getType(receiver), selector);
                             if(recordFieldIndex >= 0)
                             {
-                                sysmelb_Value_t fieldValue = receiver.tupleReference->elements[recordFieldIndex];
-                                sysmelb_bytecodeActivationContext_push(&context, fieldValue);
+                                sysmelb_Value_t fieldValue = sysmelb_value_getReference(receiver, tuple)->elements[recordFieldIndex];
+                                sendResult = fieldValue;
                                 isSynthetic = true;
                             }
                         }
                         else if(messageArgumentCount == 1)
                         {
                             // Remove the trailing:
-                            sysmelb_symbol_t *fieldName = currentInstruction->messageSendSelector;
-                            if(fieldName->size > 0 && fieldName->string[fieldName->size -1] == ':')
-                                fieldName = sysmelb_internSymbol(fieldName->size - 1, fieldName->string);
+                            sysmelb_symbol_t *fieldName = sysmelb_symbolWithoutTrailingColon(selector);
 
-                            int recordFieldIndex = sysmelb_findIndexOfFieldNamed(receiver.type, fieldName);
+                            int recordFieldIndex = sysmelb_findIndexOfFieldNamed(sysmelb_value_getType(receiver), fieldName);
                             if(recordFieldIndex >= 0)
                             {
-                                sysmelb_Value_t newFieldValue = context.calloutArguments[1];
-                                receiver.tupleReference->elements[recordFieldIndex] = newFieldValue;
-                                sysmelb_bytecodeActivationContext_push(&context, receiver);
+                                sysmelb_Value_t newFieldValue = calloutArguments[1];
+                                sysmelb_value_getReference(receiver, tuple)->elements[recordFieldIndex] = newFieldValue;
+                                sendResult = receiver;
                                 isSynthetic = true;
                             }
                         }
                     }
 
-                    if(receiver.kind == SysmelValueKindObjectReference && receiver.objectReference->clazz->kind == SysmelTypeKindClass)
+                    if(sysmelb_value_getKind(receiver) == SysmelValueKindObjectReference && sysmelb_value_getReference(receiver, object)->clazz->kind == SysmelTypeKindClass)
                     {
                         if (messageArgumentCount == 0)
                         {
-                            int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(receiver.objectReference->clazz, currentInstruction->messageSendSelector);
+                            int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(sysmelb_value_getReference(receiver, object)->clazz, selector);
                             if(objectFieldIndex >= 0)
                             {
-                                sysmelb_Value_t fieldValue = receiver.objectReference->elements[objectFieldIndex];
-                                sysmelb_bytecodeActivationContext_push(&context, fieldValue);
+                                sysmelb_Value_t fieldValue = sysmelb_value_getReference(receiver, object)->elements[objectFieldIndex];
+                                sendResult = fieldValue;
                                 isSynthetic = true;
                             }
                         }
                         else if(messageArgumentCount == 1)
                         {
                             // Remove the trailing:
-                            sysmelb_symbol_t *fieldName = currentInstruction->messageSendSelector;
-                            if(fieldName->size > 0 && fieldName->string[fieldName->size -1] == ':')
-                                fieldName = sysmelb_internSymbol(fieldName->size - 1, fieldName->string);
+                            sysmelb_symbol_t *fieldName = sysmelb_symbolWithoutTrailingColon(selector);
 
-                            int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(receiver.objectReference->clazz, fieldName);
+                            int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(sysmelb_value_getReference(receiver, object)->clazz, fieldName);
                             if(objectFieldIndex >= 0)
                             {
-                                sysmelb_Value_t newFieldValue = context.calloutArguments[1];
-                                receiver.objectReference->elements[objectFieldIndex] = newFieldValue;
-                                sysmelb_bytecodeActivationContext_push(&context, receiver);
+                                sysmelb_Value_t newFieldValue = calloutArguments[1];
+                                sysmelb_value_getReference(receiver, object)->elements[objectFieldIndex] = newFieldValue;
+                                sendResult = receiver;
                                 isSynthetic = true;
                             }
                         }
                     }
 
-                    if(receiver.kind == SysmelValueKindTypeReference)
+                    if(sysmelb_value_getKind(receiver) == SysmelValueKindTypeReference)
                     {
-                        if(receiver.typeReference->kind == SysmelTypeKindEnum)
+                        if(sysmelb_value_getReference(receiver, type)->kind == SysmelTypeKindEnum)
                         {
                             sysmelb_Value_t enumValue;
-                            if(sysmelb_findEnumValueWithName(receiver.typeReference, currentInstruction->messageSendSelector, &enumValue))
+                            if(sysmelb_findEnumValueWithName(sysmelb_value_getReference(receiver, type), selector, &enumValue))
                             {
-                                sysmelb_bytecodeActivationContext_push(&context, enumValue);
+                                sendResult = enumValue;
                                 isSynthetic = true;
                             }
                         }
                     }
                     if(!isSynthetic)
                     {
-                        sysmelb_errorPrintf(function->sourcePosition, "Message not understood. #%.*s", currentInstruction->messageSendSelector->size, currentInstruction->messageSendSelector->string);
+                        sysmelb_errorPrintf(function->sourcePosition, "Message not understood. #%.*s", selector->size, selector->string);
                         abort();
                     }
                 }
 
                 if(!isSynthetic)
                 {
-                    sysmelb_Value_t value = sysmelb_callFunctionWithArguments(method, popCount, context.calloutArguments);
-                    sysmelb_bytecodeActivationContext_push(&context, value);
+                    if(method->kind == SysmelFunctionKindInterpreted)
+                    {
+                        calledFunction = method;
+                        calledArgumentCount = popCount;
+                        calledArguments = calloutArguments;
+                        context->stackSize -= popCount;
+                        goto callInterpretedFunction;
+                    }
+                    sendResult = sysmelb_callFunctionWithArguments(method, popCount, calloutArguments);
                 }
+                context->stackSize -= popCount;
+                sysmelb_bytecodeActivationContext_push(context, sendResult);
                 ++pc;
-                break;
+                SYSMELB_DISPATCH_NEXT_OPCODE();
             }
-        case SysmelFunctionOpcodeJumpIfFalse:
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeJumpIfFalse):
         {
-            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(condition.kind == SysmelValueKindBoolean);
-            if(condition.boolean)
+            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(condition) == SysmelValueKindBoolean);
+            if(sysmelb_value_getBoolean(condition))
                 ++pc;
             else
                 pc += currentInstruction->jumpOffset;
-            break;
+            SYSMELB_DISPATCH_NEXT_OPCODE();
         }
-        case SysmelFunctionOpcodeJumpIfTrue:
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeJumpIfTrue):
         {
-            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(condition.kind == SysmelValueKindBoolean);
-            if(condition.boolean)
+            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(condition) == SysmelValueKindBoolean);
+            if(sysmelb_value_getBoolean(condition))
                 pc += currentInstruction->jumpOffset;
             else
                 ++pc;
         }
-            break;
-        case SysmelFunctionOpcodeJump:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeJump):
             pc += currentInstruction->jumpOffset;
-            break;
-        case SysmelFunctionOpcodeMakeAssociation:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeMakeAssociation):
         {
-            sysmelb_Value_t value = sysmelb_bytecodeActivationContext_pop(&context);
-            sysmelb_Value_t key = sysmelb_bytecodeActivationContext_pop(&context);
-
-            sysmelb_Association_t *assoc =  sysmelb_allocate(sizeof(sysmelb_Association_t));
-            assoc->key = key;
-            assoc->value = value;
-
-            sysmelb_Value_t assocReference =  {
-                .kind = SysmelValueKindAssociationReference,
-                .type = sysmelb_getBasicTypes()->association,
-                .associationReference = assoc
-            };
-
-            sysmelb_bytecodeActivationContext_push(&context, assocReference);
+            context->pc = pc;
+            sysmelb_Value_t value = sysmelb_bytecodeActivationContext_pop(context);
+            sysmelb_Value_t key = sysmelb_bytecodeActivationContext_pop(context);
+            sysmelb_bytecodeActivationContext_push(context, sysmelb_makeAssociationWith(key, value));
             ++pc;
         }
-            break;
-        case SysmelFunctionOpcodeMakeImmutableDictionary:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeMakeImmutableDictionary):
         {
+            context->pc = pc;
             uint16_t dictionarySize = currentInstruction->dictionarySize;
-            sysmelb_ImmutableDictionary_t *dictionary = sysmelb_allocate(sizeof(sysmelb_ImmutableDictionary_t) + dictionarySize*sizeof(sysmelb_Association_t));
-            dictionary->size = dictionarySize;
-            for(uint16_t i = 0; i < dictionarySize; ++i)
-            {
-                sysmelb_Value_t assoc = sysmelb_bytecodeActivationContext_pop(&context);
-                assert(assoc.kind == SysmelValueKindAssociationReference);
-                dictionary->elements[dictionarySize - 1 - i] = assoc.associationReference;
-            }
-
-            sysmelb_Value_t dictionaryValue = {
-                .kind = SysmelValueKindImmutableDictionaryReference,
-                .type = sysmelb_getBasicTypes()->immutableDictionary,
-                .immutableDictionaryReference = dictionary
-            };
-            sysmelb_bytecodeActivationContext_push(&context, dictionaryValue);
+            assert(context->stackSize >= dictionarySize);
+            sysmelb_Value_t dictionaryValue = sysmelb_makeImmutableDictionaryWithElements(dictionarySize, context->stack + context->stackSize - dictionarySize);
+            context->stackSize -= dictionarySize;
+            sysmelb_bytecodeActivationContext_push(context, dictionaryValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeMakeArray:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeMakeArray):
         {
+            context->pc = pc;
             uint16_t arraySize = currentInstruction->arraySize;
-            sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + arraySize*sizeof(sysmelb_Value_t));
-            array->size = arraySize;
-            for(uint16_t i = 0; i < arraySize; ++i)
-            {
-                sysmelb_Value_t element = sysmelb_bytecodeActivationContext_pop(&context);
-                array->elements[arraySize - 1 - i] = element;
-            }
-
-            sysmelb_Value_t arrayValue = {
-                .kind = SysmelValueKindArrayReference,
-                .type = sysmelb_getBasicTypes()->array,
-                .arrayReference = array
-            };
-            sysmelb_bytecodeActivationContext_push(&context, arrayValue);
+            assert(context->stackSize >= arraySize);
+            sysmelb_Value_t arrayValue = sysmelb_makeArrayWithElements(arraySize, context->stack + context->stackSize - arraySize);
+            context->stackSize -= arraySize;
+            sysmelb_bytecodeActivationContext_push(context, arrayValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeMakeByteArray:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeMakeByteArray):
         {
+            context->pc = pc;
             uint16_t byteArraySize = currentInstruction->arraySize;
-            sysmelb_ByteArrayHeader_t *byteArray = sysmelb_allocate(sizeof(sysmelb_ByteArrayHeader_t) + byteArraySize);
-            byteArray->size = byteArraySize;
-            for(uint16_t i = 0; i < byteArraySize; ++i)
-            {
-                sysmelb_Value_t element = sysmelb_bytecodeActivationContext_pop(&context);
-                byteArray->elements[byteArraySize - 1 - i] = element.integer;
-            }
-
-            sysmelb_Value_t byteArrayValue = {
-                .kind = SysmelValueKindByteArrayReference,
-                .type = sysmelb_getBasicTypes()->byteArray,
-                .byteArrayReference = byteArray
-            };
-            sysmelb_bytecodeActivationContext_push(&context, byteArrayValue);
+            assert(context->stackSize >= byteArraySize);
+            sysmelb_Value_t byteArrayValue = sysmelb_makeByteArrayWithElements(byteArraySize, context->stack + context->stackSize - byteArraySize);
+            context->stackSize -= byteArraySize;
+            sysmelb_bytecodeActivationContext_push(context, byteArrayValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeMakeTuple:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeMakeTuple):
         {
+            context->pc = pc;
             uint16_t tupleSize = currentInstruction->tupleSize;
-            sysmelb_TupleHeader_t *tuple = sysmelb_allocate(sizeof(sysmelb_TupleHeader_t) + tupleSize*sizeof(sysmelb_Value_t));
-            tuple->size = tupleSize;
-            for(uint16_t i = 0; i < tupleSize; ++i)
-            {
-                sysmelb_Value_t element = sysmelb_bytecodeActivationContext_pop(&context);
-                tuple->elements[tupleSize - 1 - i] = element;
-            }
-
-            sysmelb_Value_t tupleValue = {
-                .kind = SysmelValueKindTupleReference,
-                .type = sysmelb_getBasicTypes()->tuple,
-                .tupleReference = tuple
-            };
-            sysmelb_bytecodeActivationContext_push(&context, tupleValue);
+            assert(context->stackSize >= tupleSize);
+            sysmelb_Value_t tupleValue = sysmelb_makeTupleWithElements(tupleSize, context->stack + context->stackSize - tupleSize);
+            context->stackSize -= tupleSize;
+            sysmelb_bytecodeActivationContext_push(context, tupleValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeGetSumIndex:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeGetSumIndex):
         {
-            sysmelb_Value_t sumValue = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(sumValue.kind == SysmelValueKindSumValueReference);
+            sysmelb_Value_t sumValue = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(sumValue) == SysmelValueKindSumValueReference);
 
-            sysmelb_Value_t injectedIndex = {
-                .kind = SysmelValueKindInteger,
-                .type = sysmelb_getBasicTypes()->integer,
-                .integer = sumValue.sumTypeValueReference->alternativeIndex
-            };
+            sysmelb_Value_t injectedIndex = sysmelb_value_makeInteger(
+                sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(sumValue, sumTypeValue)->alternativeIndex);
 
-            sysmelb_bytecodeActivationContext_push(&context, injectedIndex);
+            sysmelb_bytecodeActivationContext_push(context, injectedIndex);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeGetSumInjectedValue:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeGetSumInjectedValue):
         {
-            sysmelb_Value_t sumValue = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(sumValue.kind == SysmelValueKindSumValueReference);
-            sysmelb_bytecodeActivationContext_push(&context, sumValue.sumTypeValueReference->alternativeValue);
+            sysmelb_Value_t sumValue = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(sumValue) == SysmelValueKindSumValueReference);
+            sysmelb_bytecodeActivationContext_push(context, sysmelb_value_getReference(sumValue, sumTypeValue)->alternativeValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeAssert:
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+        SYSMELB_OPCODE_HANDLER(SysmelFunctionOpcodeAssert):
         {
-            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(&context);
-            assert(condition.kind == SysmelValueKindBoolean);
-            if(!condition.boolean)
+            sysmelb_Value_t condition = sysmelb_bytecodeActivationContext_pop(context);
+            assert(sysmelb_value_getKind(condition) == SysmelValueKindBoolean);
+            if(!sysmelb_value_getBoolean(condition))
             {
-                sysmelb_errorPrintf(currentInstruction->assertPosition, "Assertion failure.");
+                sysmelb_errorPrintf(sysmelb_bytecode_sourcePositionAt(function, pc), "Assertion failure.");
             }
 
-            sysmelb_Value_t voidValue = {
-                .kind = SysmelValueKindVoid,
-                .type = sysmelb_getBasicTypes()->voidType
-            };
-            sysmelb_bytecodeActivationContext_push(&context, voidValue);
+            sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
+            sysmelb_bytecodeActivationContext_push(context, voidValue);
         }
             ++pc;
-            break;
-        case SysmelFunctionOpcodeSourcePosition:
-            lastSourcePosition = currentInstruction->lastSourcePosition;
-            ++pc;
-            break;
+            SYSMELB_DISPATCH_NEXT_OPCODE();
+#ifndef SYSMELB_THREADED_DISPATCH
         default:
             abort();
         }
     }
+#else
+endOfFunction:
+#endif
+    result = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
 
-    return result;
+returnFromFunction:
+    {
+        sysmelb_bytecodeActivationContext_t *returningContext = context;
+        context = returningContext->previousContext;
+        sysmelb_bytecodeActivationContext_leave(returningContext);
+        if(returningContext == entryContext)
+            return result;
+
+        // The arguments of the call were popped when it was made.
+        SYSMELB_LOAD_ACTIVATION_CONTEXT();
+        pc = context->pc + 1;
+        sysmelb_bytecodeActivationContext_push(context, result);
+    }
+#ifdef SYSMELB_THREADED_DISPATCH
+    SYSMELB_DISPATCH_NEXT_OPCODE();
+#else
+    goto dispatchLoop;
+#endif
+
+callInterpretedFunction:
+    // The arguments were already popped from the caller, because the callee
+    // marks them itself. The callee frame is allocated after the whole frame of
+    // the caller, so they are not overwritten.
+    context = sysmelb_bytecodeActivationContext_enter(calledFunction, calledArgumentCount, calledArguments);
+    pc = 0;
+    SYSMELB_LOAD_ACTIVATION_CONTEXT();
+#ifdef SYSMELB_THREADED_DISPATCH
+    SYSMELB_DISPATCH_NEXT_OPCODE();
+#else
+    goto dispatchLoop;
+#endif
+#undef SYSMELB_LOAD_ACTIVATION_CONTEXT
+#undef SYSMELB_RESOLVE_THREADED_CODE
+#undef SYSMELB_OPCODE_HANDLER
+#undef SYSMELB_DISPATCH_NEXT_OPCODE
 }
@@ -6,6 +6,7 @@
 #include "symbol.h"
 #include "source-code.h"
 #include <stddef.h>
+#include <stdbool.h>
 
 #define SYSMEL_MAX_ARGUMENT_COUNT 16
 
@@ -45,10 +46,11 @@ typedef enum sysmelb_FunctionOpcode_e
     SysmelFunctionOpcodeGetSumIndex,
     SysmelFunctionOpcodeGetSumInjectedValue,
     SysmelFunctionOpcodeAssert,
-    SysmelFunctionOpcodeSourcePosition,
 } sysmelb_FunctionOpcode_t;
 
 typedef struct sysmelb_FunctionInstruction_s sysmelb_FunctionInstruction_t;
+typedef struct sysmelb_BytecodeSourcePosition_s sysmelb_BytecodeSourcePosition_t;
+typedef struct sysmelb_SendCache_s sysmelb_SendCache_t;
 
 typedef struct sysmelb_MacroContext_s
 {
@@ -64,9 +66,24 @@ typedef struct sysmelb_FunctionBytecode_s
     uint16_t argumentCount;
     uint16_t captureCount;
     uint32_t temporaryZoneSize;
+    uint32_t stackDepth;
+    uint32_t maxStackDepth;
     uint32_t instructionCapacity;
     uint32_t instructionSize;
     sysmelb_FunctionInstruction_t *instructions;
+    void **threadedCode;
+
+    uint32_t literalCapacity;
+    uint32_t literalSize;
+    sysmelb_Value_t *literals;
+
+    uint32_t sourcePositionCapacity;
+    uint32_t sourcePositionSize;
+    sysmelb_BytecodeSourcePosition_t *sourcePositions;
+
+    uint32_t sendCacheCapacity;
+    uint32_t sendCacheSize;
+    sysmelb_SendCache_t *sendCaches;
 } sysmelb_FunctionBytecode_t;
 
 typedef struct sysmelb_function_s
@@ -83,7 +100,7 @@ typedef struct sysmelb_function_s
     };
 } sysmelb_function_t;
 
-uint16_t sysmelb_bytecode_addInstruction(sysmelb_FunctionBytecode_t *bytecode, sysmelb_FunctionInstruction_t instructionToAdd);
+uint32_t sysmelb_bytecode_addInstruction(sysmelb_FunctionBytecode_t *bytecode, sysmelb_FunctionInstruction_t instructionToAdd);
 void sysmelb_bytecode_pushLiteral(sysmelb_FunctionBytecode_t *bytecode, sysmelb_Value_t *literal);
 void sysmelb_bytecode_pushArgument(sysmelb_FunctionBytecode_t *bytecode, uint16_t argumentIndex);
 void sysmelb_bytecode_pushCapture(sysmelb_FunctionBytecode_t *bytecode, uint16_t captureIndex);
@@ -95,13 +112,13 @@ uint16_t sysmelb_bytecode_allocateTemporary(sysmelb_FunctionBytecode_t *bytecode
 void sysmelb_bytecode_storeTemporary(sysmelb_FunctionBytecode_t *bytecode, uint16_t tempIndex);
 void sysmelb_bytecode_popAndStoreTemporary(sysmelb_FunctionBytecode_t *bytecode, uint16_t tempIndex);
 
-uint16_t sysmelb_bytecode_jump(sysmelb_FunctionBytecode_t *bytecode);
-uint16_t sysmelb_bytecode_jumpIfFalse(sysmelb_FunctionBytecode_t *bytecode);
-uint16_t sysmelb_bytecode_jumpIfTrue(sysmelb_FunctionBytecode_t *bytecode);
-void sysmelb_bytecode_patchJumpToHere(sysmelb_FunctionBytecode_t *bytecode, uint16_t jumpInstructionIndex);
+uint32_t sysmelb_bytecode_jump(sysmelb_FunctionBytecode_t *bytecode);
+uint32_t sysmelb_bytecode_jumpIfFalse(sysmelb_FunctionBytecode_t *bytecode);
+uint32_t sysmelb_bytecode_jumpIfTrue(sysmelb_FunctionBytecode_t *bytecode);
+void sysmelb_bytecode_patchJumpToHere(sysmelb_FunctionBytecode_t *bytecode, uint32_t jumpInstructionIndex);
 
-uint16_t sysmelb_bytecode_label(sysmelb_FunctionBytecode_t *bytecode);
-void sysmelb_bytecode_patchJumpToLabel(sysmelb_FunctionBytecode_t *bytecode, uint16_t jumpInstructionIndex, uint16_t labelTarget);
+uint32_t sysmelb_bytecode_label(sysmelb_FunctionBytecode_t *bytecode);
+void sysmelb_bytecode_patchJumpToLabel(sysmelb_FunctionBytecode_t *bytecode, uint32_t jumpInstructionIndex, uint32_t labelTarget);
 
 void sysmelb_bytecode_integerEquals(sysmelb_FunctionBytecode_t *bytecode);
     
@@ -114,13 +131,25 @@ void sysmelb_bytecode_makeByteArray(sysmelb_FunctionBytecode_t *bytecode, uint16
 void sysmelb_bytecode_makeImmutableDictionary(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
 void sysmelb_bytecode_makeTuple(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
 
+bool sysmelb_bytecode_isSingleLiteralPushFrom(sysmelb_FunctionBytecode_t *bytecode, uint32_t instructionIndex);
+void sysmelb_bytecode_makeLiteralAssociation(sysmelb_FunctionBytecode_t *bytecode);
+void sysmelb_bytecode_makeLiteralArray(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
+void sysmelb_bytecode_makeLiteralByteArray(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
+void sysmelb_bytecode_makeLiteralImmutableDictionary(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
+void sysmelb_bytecode_makeLiteralTuple(sysmelb_FunctionBytecode_t *bytecode, uint16_t size);
+
 void sysmelb_bytecode_getSumIndex(sysmelb_FunctionBytecode_t *bytecode);
 void sysmelb_bytecode_getSumInjectedValue(sysmelb_FunctionBytecode_t *bytecode);
 
 void sysmelb_bytecode_sourcePosition(sysmelb_FunctionBytecode_t *bytecode, sysmelb_SourcePosition_t sourcePosition);
+sysmelb_SourcePosition_t sysmelb_bytecode_sourcePositionAt(sysmelb_function_t *function, uint32_t pc);
 
 void sysmelb_bytecode_assert(sysmelb_FunctionBytecode_t *bytecode, sysmelb_SourcePosition_t);
 
+void sysmelb_bytecode_markReferences(sysmelb_FunctionBytecode_t *bytecode);
+void sysmelb_markActivationContexts(void);
+bool sysmelb_getCurrentInterpretedSourcePosition(sysmelb_SourcePosition_t *outSourcePosition);
+
 sysmelb_Value_t sysmelb_callFunctionWithArguments(sysmelb_function_t *function, size_t argumentCount, sysmelb_Value_t *arguments);
 sysmelb_Value_t sysmelb_interpretBytecodeFunction(sysmelb_function_t *function, size_t argumentCount, sysmelb_Value_t *arguments);
 #endif // SYSMELB_FUNCTION_H
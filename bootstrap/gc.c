@@ -0,0 +1,741 @@
+#include "gc.h"
+#include "allocation-profile.h"
+#include "memory.h"
+#include "environment.h"
+#include "function.h"
+#include "module.h"
+#include "namespace.h"
+#include "parse-tree.h"
+#include "types.h"
+#include "value.h"
+#include <assert.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define SYSMELB_GC_MINIMUM_COLLECTION_THRESHOLD (4*1024*1024)
+
+typedef enum sysmelb_GCObjectKind_e
+{
+    SysmelGCObjectType,
+    SysmelGCObjectFunction,
+    SysmelGCObjectParseTreeNode,
+    SysmelGCObjectSourceCode,
+    SysmelGCObjectEnvironment,
+    SysmelGCObjectSymbolBinding,
+    SysmelGCObjectNamespace,
+    SysmelGCObjectModule,
+    SysmelGCObjectValue,
+    SysmelGCObjectValueArray,
+    SysmelGCObjectObject,
+    SysmelGCObjectAssociation,
+    SysmelGCObjectImmutableDictionary,
+    SysmelGCObjectSymbolHashtable,
+    SysmelGCObjectOrderedCollection,
+    SysmelGCObjectByteOrderedCollection,
+    SysmelGCObjectStringBuilder,
+    SysmelGCObjectSumValue,
+    SysmelGCObjectIdentityHashset,
+    SysmelGCObjectIdentityDictionary,
+    SysmelGCObjectConservative,
+} sysmelb_GCObjectKind_t;
+
+typedef struct sysmelb_GCGrayObject_s
+{
+    sysmelb_GCObjectKind_t kind;
+    void *pointer;
+    void *allocationStart;
+    size_t allocationSize;
+} sysmelb_GCGrayObject_t;
+
+static sysmelb_GCGrayObject_t *sysmelb_GCGrayStack;
+static size_t sysmelb_GCGrayStackSize;
+static size_t sysmelb_GCGrayStackCapacity;
+static sysmelb_GCStatistics_t sysmelb_GCStatistics;
+static void *sysmelb_GCNativeStackBottom;
+
+static void sysmelb_gc_visit(sysmelb_GCObjectKind_t kind, void *pointer)
+{
+    void *allocationStart;
+    size_t allocationSize;
+    if(!sysmelb_memory_markAllocation(pointer, &allocationStart, &allocationSize))
+        return;
+
+    if(sysmelb_GCGrayStackSize >= sysmelb_GCGrayStackCapacity)
+    {
+        sysmelb_GCGrayStackCapacity = sysmelb_GCGrayStackCapacity ? sysmelb_GCGrayStackCapacity*2 : 1024;
+        sysmelb_GCGrayStack = realloc(sysmelb_GCGrayStack, sysmelb_GCGrayStackCapacity * sizeof(sysmelb_GCGrayObject_t));
+        if(!sysmelb_GCGrayStack)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+    }
+
+    sysmelb_GCGrayObject_t grayObject = {
+        .kind = kind,
+        .pointer = pointer,
+        .allocationStart = allocationStart,
+        .allocationSize = allocationSize,
+    };
+    sysmelb_GCGrayStack[sysmelb_GCGrayStackSize++] = grayObject;
+}
+
+void sysmelb_gc_markPointer(void *pointer)
+{
+    void *allocationStart;
+    size_t allocationSize;
+    sysmelb_memory_markAllocation(pointer, &allocationStart, &allocationSize);
+}
+
+void sysmelb_gc_markSourcePosition(sysmelb_SourcePosition_t *sourcePosition)
+{
+    sysmelb_gc_visit(SysmelGCObjectSourceCode, sourcePosition->sourceCode);
+}
+
+void sysmelb_gc_markType(sysmelb_Type_t *type)
+{
+    sysmelb_gc_visit(SysmelGCObjectType, type);
+}
+
+void sysmelb_gc_markValue(sysmelb_Value_t *value)
+{
+#ifdef SYSMELB_TAGGED_VALUES
+    if(sysmelb_value_isEscaped(*value))
+        sysmelb_gc_markPointer(sysmelb_value_getEscaped(*value));
+#endif
+    if(sysmelb_value_getKind(*value) != SysmelValueKindStringReference)
+        sysmelb_gc_visit(SysmelGCObjectType, sysmelb_type_getFromIndex(sysmelb_value_getTypeIndex(*value)));
+
+    switch(sysmelb_value_getKind(*value))
+    {
+    case SysmelValueKindNull:
+    case SysmelValueKindVoid:
+    case SysmelValueKindBoolean:
+    case SysmelValueKindCharacter:
+    case SysmelValueKindInteger:
+    case SysmelValueKindUnsignedInteger:
+    case SysmelValueKindFloatingPoint:
+        break;
+    case SysmelValueKindTypeReference:
+        sysmelb_gc_visit(SysmelGCObjectType, sysmelb_value_getReference(*value, type));
+        break;
+    case SysmelValueKindFunctionReference:
+        sysmelb_gc_visit(SysmelGCObjectFunction, sysmelb_value_getReference(*value, function));
+        break;
+    case SysmelValueKindParseTreeReference:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, sysmelb_value_getReference(*value, parseTree));
+        break;
+    case SysmelValueKindSymbolReference:
+        sysmelb_gc_markPointer(sysmelb_value_getReference(*value, symbol));
+        break;
+    case SysmelValueKindStringReference:
+        sysmelb_gc_markPointer(sysmelb_value_getString(*value));
+        break;
+    case SysmelValueKindArrayReference:
+        sysmelb_gc_visit(SysmelGCObjectValueArray, sysmelb_value_getReference(*value, array));
+        break;
+    case SysmelValueKindByteArrayReference:
+        sysmelb_gc_markPointer(sysmelb_value_getReference(*value, byteArray));
+        break;
+    case SysmelValueKindTupleReference:
+        sysmelb_gc_visit(SysmelGCObjectValueArray, sysmelb_value_getReference(*value, tuple));
+        break;
+    case SysmelValueKindObjectReference:
+        sysmelb_gc_visit(SysmelGCObjectObject, sysmelb_value_getReference(*value, object));
+        break;
+    case SysmelValueKindAssociationReference:
+        sysmelb_gc_visit(SysmelGCObjectAssociation, sysmelb_value_getReference(*value, association));
+        break;
+    case SysmelValueKindImmutableDictionaryReference:
+        sysmelb_gc_visit(SysmelGCObjectImmutableDictionary, sysmelb_value_getReference(*value, immutableDictionary));
+        break;
+    case SysmelValueKindSymbolHashtableReference:
+        sysmelb_gc_visit(SysmelGCObjectSymbolHashtable, sysmelb_value_getReference(*value, symbolHashtable));
+        break;
+    case SysmelValueKindValueBoxReference:
+        sysmelb_gc_visit(SysmelGCObjectValue, &sysmelb_value_getReference(*value, valueBox)->currentValue);
+        break;
+    case SysmelValueKindNamespaceReference:
+        sysmelb_gc_visit(SysmelGCObjectNamespace, sysmelb_value_getReference(*value, namespace));
+        break;
+    case SysmelValueKindOrderedCollectionReference:
+        sysmelb_gc_visit(SysmelGCObjectOrderedCollection, sysmelb_value_getReference(*value, orderedCollection));
+        break;
+    case SysmelValueKindByteOrderedCollectionReference:
+        sysmelb_gc_visit(SysmelGCObjectByteOrderedCollection, sysmelb_value_getReference(*value, byteOrderedCollection));
+        break;
+    case SysmelValueKindStringBuilderReference:
+        sysmelb_gc_visit(SysmelGCObjectStringBuilder, sysmelb_value_getReference(*value, stringBuilder));
+        break;
+    case SysmelValueKindSumValueReference:
+        sysmelb_gc_visit(SysmelGCObjectSumValue, sysmelb_value_getReference(*value, sumTypeValue));
+        break;
+    case SysmelValueKindIdentityHashsetReference:
+        sysmelb_gc_visit(SysmelGCObjectIdentityHashset, sysmelb_value_getReference(*value, identityHashset));
+        break;
+    case SysmelValueKindIdentityDictionaryReference:
+        sysmelb_gc_visit(SysmelGCObjectIdentityDictionary, sysmelb_value_getReference(*value, identityDictionary));
+        break;
+    default:
+        abort();
+    }
+}
+
+static void sysmelb_gc_traceSymbolHashtable(sysmelb_SymbolHashtable_t *table, sysmelb_GCObjectKind_t valueKind)
+{
+    sysmelb_gc_markPointer(table->keys);
+    for(size_t i = 0; i < table->capacity; ++i)
+    {
+        if(!table->keys[i])
+            continue;
+
+        sysmelb_gc_markPointer(table->keys[i]);
+        sysmelb_gc_visit(valueKind, table->values[i]);
+    }
+}
+
+static void sysmelb_gc_traceParseTreeNodeDynArray(sysmelb_ParseTreeNodeDynArray_t *dynArray)
+{
+    sysmelb_gc_markPointer(dynArray->elements);
+    for(size_t i = 0; i < dynArray->size; ++i)
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, dynArray->elements[i]);
+}
+
+static void sysmelb_gc_traceType(sysmelb_Type_t *type)
+{
+    sysmelb_gc_markPointer(type->name);
+    sysmelb_gc_markPointer((void*)type->printingSuffix);
+    sysmelb_gc_visit(SysmelGCObjectType, type->supertype);
+    sysmelb_gc_traceSymbolHashtable(&type->methodDict, SysmelGCObjectFunction);
+
+    switch(type->kind)
+    {
+    case SysmelTypeKindFixedArray:
+        sysmelb_gc_visit(SysmelGCObjectType, type->fixedArray.baseType);
+        break;
+    case SysmelTypeKindTuple:
+    case SysmelTypeKindRecord:
+        sysmelb_gc_markPointer(type->tupleAndRecords.fields);
+        sysmelb_gc_markPointer(type->tupleAndRecords.fieldNames);
+        for(uint32_t i = 0; i < type->tupleAndRecords.fieldCount; ++i)
+        {
+            sysmelb_gc_visit(SysmelGCObjectType, type->tupleAndRecords.fields[i]);
+            sysmelb_gc_markPointer(type->tupleAndRecords.fieldNames[i]);
+        }
+        break;
+    case SysmelTypeKindClass:
+        sysmelb_gc_markPointer(type->clazz.fields);
+        sysmelb_gc_markPointer(type->clazz.fieldNames);
+        for(uint32_t i = 0; i < type->clazz.fieldCount; ++i)
+        {
+            sysmelb_gc_visit(SysmelGCObjectType, type->clazz.fields[i]);
+            sysmelb_gc_markPointer(type->clazz.fieldNames[i]);
+        }
+        break;
+    case SysmelTypeKindEnum:
+        sysmelb_gc_visit(SysmelGCObjectType, type->enumValues.baseType);
+        sysmelb_gc_markPointer(type->enumValues.values);
+        sysmelb_gc_markPointer(type->enumValues.valueNames);
+        for(uint32_t i = 0; i < type->enumValues.valueCount; ++i)
+        {
+            sysmelb_gc_markValue(&type->enumValues.values[i]);
+            sysmelb_gc_markPointer(type->enumValues.valueNames[i]);
+        }
+        break;
+    case SysmelTypeKindSum:
+        sysmelb_gc_markPointer(type->sumType.alternatives);
+        for(uint32_t i = 0; i < type->sumType.alternativeCount; ++i)
+            sysmelb_gc_visit(SysmelGCObjectType, type->sumType.alternatives[i]);
+        break;
+    default:
+        break;
+    }
+}
+
+static void sysmelb_gc_traceFunction(sysmelb_function_t *function)
+{
+    sysmelb_gc_markPointer(function->name);
+    sysmelb_gc_markSourcePosition(&function->sourcePosition);
+    if(function->kind == SysmelFunctionKindInterpreted || function->kind == SysmelFunctionKindInterpretedMacro)
+        sysmelb_bytecode_markReferences(&function->bytecode);
+}
+
+static void sysmelb_gc_traceParseTreeNode(sysmelb_ParseTreeNode_t *node)
+{
+    sysmelb_gc_markSourcePosition(&node->sourcePosition);
+    switch(node->kind)
+    {
+    case ParseTreeErrorNode:
+        sysmelb_gc_markPointer((void*)node->errorNode.errorMessage);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->errorNode.innerNode);
+        break;
+    case ParseTreeAssertNode:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->assertNode.condition);
+        break;
+
+    // Literals
+    case ParseTreeLiteralIntegerNode:
+    case ParseTreeLiteralCharacterNode:
+    case ParseTreeLiteralFloatNode:
+        break;
+    case ParseTreeLiteralStringNode:
+        sysmelb_gc_markPointer(node->literalString.string);
+        break;
+    case ParseTreeLiteralSymbolNode:
+        sysmelb_gc_markPointer(node->literalSymbol.internedSymbol);
+        break;
+    case ParseTreeLiteralValueNode:
+        sysmelb_gc_markValue(&node->literalValue.value);
+        break;
+
+    // Identifiers
+    case ParseTreeIdentifierReference:
+        sysmelb_gc_markPointer(node->identifierReference.identifier);
+        break;
+
+    // Functions and message send
+    case ParseTreeFunctionApplication:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->functionApplication.functional);
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->functionApplication.arguments);
+        break;
+    case ParseTreeMessageSend:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->messageSend.receiver);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->messageSend.selector);
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->messageSend.arguments);
+        break;
+    case ParseTreeMessageCascade:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->messageCascade.receiver);
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->messageCascade.cascadedMessages);
+        break;
+    case ParseTreeCascadedMessage:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->cascadedMessage.selector);
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->cascadedMessage.arguments);
+        break;
+    case ParseTreeBinaryOperatorSequence:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->binaryOperatorSequence.elements);
+        break;
+
+    // Sequences, array, tuples
+    case ParseTreeSequence:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->sequence.elements);
+        break;
+    case ParseTreeTuple:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->tuple.elements);
+        break;
+    case ParseTreeArray:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->array.elements);
+        break;
+    case ParseTreeByteArray:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->byteArray.elements);
+        break;
+
+    // ImmutableDictionary
+    case ParseTreeAssociation:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->association.key);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->association.value);
+        break;
+    case ParseTreeImmutableDictionary:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->dictionary.elements);
+        break;
+
+    // Blocks
+    case ParseTreeBlockClosure:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->blockClosure.functionType);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->blockClosure.body);
+        break;
+    case ParseTreeLexicalBlock:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->lexicalBlock.expression);
+        break;
+
+    // Macro operators
+    case ParseTreeQuote:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->quote.expression);
+        break;
+    case ParseTreeQuasiQuote:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->quasiQuote.expression);
+        break;
+    case ParseTreeQuasiUnquote:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->quasiUnquote.expression);
+        break;
+    case ParseTreeSplice:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->splice.expression);
+        break;
+
+    // Binding and pattern matching
+    case ParseTreeFunctionalDependentType:
+        sysmelb_gc_traceParseTreeNodeDynArray(&node->functionalDependentType.argumentDefinition);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->functionalDependentType.resultTypeExpression);
+        break;
+    case ParseTreeBindableName:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->bindableName.typeExpression);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->bindableName.nameExpression);
+        break;
+
+    // Assignment
+    case ParseTreeAssignment:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->assignment.store);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->assignment.value);
+        break;
+
+    // Closure and functions
+    case ParseTreeFunction:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->function.functionDependentType);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->function.bodyExpression);
+        sysmelb_gc_markPointer(node->function.name);
+        break;
+
+    // Control flow.
+    case ParseTreeIfSelection:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->ifSelection.condition);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->ifSelection.trueExpression);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->ifSelection.falseExpression);
+        break;
+    case ParseTreeWhileLoop:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->whileLoop.condition);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->whileLoop.body);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->whileLoop.continueExpression);
+        break;
+    case ParseTreeDoWhileLoop:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->doWhileLoop.body);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->doWhileLoop.continueExpression);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->doWhileLoop.condition);
+        break;
+    case ParseTreeReturnValue:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->returnExpression.valueExpression);
+        break;
+    case ParseTreeSwitch:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->switchExpression.value);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->switchExpression.cases);
+        break;
+    case ParseTreeSwitchPatternMatching:
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->switchPatternMatching.value);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->switchPatternMatching.valueSumType);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->switchPatternMatching.cases);
+        break;
+
+    // Sum type
+    case ParseTreeGetSumAlternativeIndex:
+    case ParseTreeExtractSumAlternativeWithTypes:
+        break;
+
+    // Namespaces
+    case ParseTreeNamespaceDefinition:
+        sysmelb_gc_visit(SysmelGCObjectNamespace, node->namespaceDefinition.namespace);
+        sysmelb_gc_visit(SysmelGCObjectParseTreeNode, node->namespaceDefinition.definition);
+        break;
+    default:
+        abort();
+    }
+}
+
+static void sysmelb_gc_traceEnvironment(sysmelb_Environment_t *environment)
+{
+    sysmelb_gc_visit(SysmelGCObjectEnvironment, environment->parent);
+    sysmelb_gc_traceSymbolHashtable(&environment->localSymbolTable, SysmelGCObjectSymbolBinding);
+    switch(environment->kind)
+    {
+    case SysmelEnvKindModule:
+        sysmelb_gc_visit(SysmelGCObjectModule, environment->ownerModule);
+        break;
+    case SysmelEnvKindNamespace:
+        sysmelb_gc_visit(SysmelGCObjectNamespace, environment->ownerNamespace);
+        break;
+    default:
+        break;
+    }
+}
+
+static void sysmelb_gc_traceSymbolBinding(sysmelb_SymbolBinding_t *binding)
+{
+    switch(binding->kind)
+    {
+    case SysmelSymbolValueBinding:
+        sysmelb_gc_markValue(&binding->value);
+        break;
+    case SysmelSymbolArgumentBinding:
+        sysmelb_gc_visit(SysmelGCObjectType, binding->argumentType);
+        break;
+    case SysmelSymbolCaptureBinding:
+        sysmelb_gc_visit(SysmelGCObjectType, binding->captureType);
+        break;
+    case SysmelSymbolTemporaryBinding:
+        sysmelb_gc_visit(SysmelGCObjectType, binding->temporaryType);
+        break;
+    }
+}
+
+static void sysmelb_gc_traceModule(sysmelb_Module_t *module)
+{
+    sysmelb_gc_markPointer(module->name);
+    sysmelb_gc_visit(SysmelGCObjectNamespace, module->globalNamespace);
+    sysmelb_gc_markValue(&module->mainEntryPointFunction);
+    sysmelb_gc_visit(SysmelGCObjectEnvironment, module->moduleEnvironment);
+    sysmelb_gc_visit(SysmelGCObjectEnvironment, module->globalNamespaceEnvironment);
+    sysmelb_gc_visit(SysmelGCObjectModule, module->nextModule);
+}
+
+// A wide value keeps its type index in the upper half of its first word, so a
+// word that looks like the start of a value also keeps that type alive.
+_Static_assert(offsetof(sysmelb_WideValue_t, typeIndex) == 4, "The type index is expected in the upper half of the first word of a value.");
+
+static void sysmelb_gc_visitConservativeWord(uintptr_t word)
+{
+    sysmelb_gc_visit(SysmelGCObjectConservative, (void*)word);
+
+    uint32_t typeIndex = (uint32_t)((uint64_t)word >> 32);
+    if((word & 0xFF) <= SysmelValueKindIdentityDictionaryReference && typeIndex < sysmelb_TypeTableSize)
+        sysmelb_gc_visit(SysmelGCObjectType, sysmelb_TypeTable[typeIndex]);
+
+#ifdef SYSMELB_TAGGED_VALUES
+    // A tagged value keeps its payload in the low bits, and its type index
+    // next to its kind. Escaped values are found through their wide copy.
+    sysmelb_Value_t value = {.bits = word};
+    if(sysmelb_value_getKind(value) > SysmelValueKindIdentityDictionaryReference)
+        return;
+
+    sysmelb_gc_visit(SysmelGCObjectConservative, (void*)(uintptr_t)(word & SYSMELB_TAGGED_VALUE_PAYLOAD_MASK));
+    if(!sysmelb_value_isEscaped(value) && sysmelb_value_getKind(value) != SysmelValueKindStringReference && sysmelb_value_getSlot(value) < sysmelb_TypeTableSize)
+        sysmelb_gc_visit(SysmelGCObjectType, sysmelb_TypeTable[sysmelb_value_getSlot(value)]);
+#endif
+}
+
+static void sysmelb_gc_traceConservatively(void *start, size_t size)
+{
+    uintptr_t *words = start;
+    size_t wordCount = size / sizeof(uintptr_t);
+    for(size_t i = 0; i < wordCount; ++i)
+        sysmelb_gc_visitConservativeWord(words[i]);
+}
+
+static void sysmelb_gc_traceGrayObject(sysmelb_GCGrayObject_t *grayObject)
+{
+    void *pointer = grayObject->pointer;
+    switch(grayObject->kind)
+    {
+    case SysmelGCObjectType:
+        sysmelb_gc_traceType(pointer);
+        break;
+    case SysmelGCObjectFunction:
+        sysmelb_gc_traceFunction(pointer);
+        break;
+    case SysmelGCObjectParseTreeNode:
+        sysmelb_gc_traceParseTreeNode(pointer);
+        break;
+    case SysmelGCObjectSourceCode:
+    {
+        sysmelb_SourceCode_t *sourceCode = pointer;
+        sysmelb_gc_markPointer((void*)sourceCode->directory);
+        sysmelb_gc_markPointer((void*)sourceCode->name);
+        sysmelb_gc_markPointer((void*)sourceCode->text);
+        break;
+    }
+    case SysmelGCObjectEnvironment:
+        sysmelb_gc_traceEnvironment(pointer);
+        break;
+    case SysmelGCObjectSymbolBinding:
+        sysmelb_gc_traceSymbolBinding(pointer);
+        break;
+    case SysmelGCObjectNamespace:
+    {
+        sysmelb_Namespace_t *namespace = pointer;
+        sysmelb_gc_markPointer(namespace->name);
+        sysmelb_gc_traceSymbolHashtable(&namespace->exportedObjects, SysmelGCObjectSymbolBinding);
+        break;
+    }
+    case SysmelGCObjectModule:
+        sysmelb_gc_traceModule(pointer);
+        break;
+    case SysmelGCObjectValue:
+        sysmelb_gc_markValue(pointer);
+        break;
+    case SysmelGCObjectValueArray:
+    {
+        sysmelb_ArrayHeader_t *array = pointer;
+        for(size_t i = 0; i < array->size; ++i)
+            sysmelb_gc_markValue(&array->elements[i]);
+        break;
+    }
+    case SysmelGCObjectObject:
+    {
+        sysmelb_ObjectHeader_t *object = pointer;
+        sysmelb_gc_visit(SysmelGCObjectType, object->clazz);
+        for(size_t i = 0; i < object->size; ++i)
+            sysmelb_gc_markValue(&object->elements[i]);
+        break;
+    }
+    case SysmelGCObjectAssociation:
+    {
+        sysmelb_Association_t *association = pointer;
+        sysmelb_gc_markValue(&association->key);
+        sysmelb_gc_markValue(&association->value);
+        break;
+    }
+    case SysmelGCObjectImmutableDictionary:
+    {
+        sysmelb_ImmutableDictionary_t *dictionary = pointer;
+        for(size_t i = 0; i < dictionary->size; ++i)
+            sysmelb_gc_visit(SysmelGCObjectAssociation, dictionary->elements[i]);
+        break;
+    }
+    case SysmelGCObjectSymbolHashtable:
+        sysmelb_gc_traceSymbolHashtable(pointer, SysmelGCObjectValue);
+        break;
+    case SysmelGCObjectOrderedCollection:
+    {
+        sysmelb_OrderedCollection_t *collection = pointer;
+        sysmelb_gc_markPointer(collection->elements);
+        for(size_t i = 0; i < collection->size; ++i)
+            sysmelb_gc_markValue(&collection->elements[i]);
+        break;
+    }
+    case SysmelGCObjectByteOrderedCollection:
+    {
+        sysmelb_ByteOrderedCollection_t *collection = pointer;
+        sysmelb_gc_markPointer(collection->elements);
+        break;
+    }
+    case SysmelGCObjectStringBuilder:
+    {
+        sysmelb_StringBuilder_t *builder = pointer;
+        sysmelb_gc_markPointer(builder->data);
+        break;
+    }
+    case SysmelGCObjectSumValue:
+    {
+        sysmelb_SumTypeValue_t *sumValue = pointer;
+        sysmelb_gc_markValue(&sumValue->alternativeValue);
+        break;
+    }
+    // Identity hashsets keep their element values next to the probed
+    // pointers. Identity dictionaries only keep raw pointers without their
+    // types, so their entries are traced conservatively.
+    case SysmelGCObjectIdentityHashset:
+    {
+        sysmelb_IdentityHashset_t *set = pointer;
+        sysmelb_gc_markPointer(set->data);
+        for(size_t i = 0; i < set->capacity; ++i)
+        {
+            if(set->data[i])
+                sysmelb_gc_markValue(&set->elements[i]);
+        }
+        break;
+    }
+    case SysmelGCObjectIdentityDictionary:
+    {
+        sysmelb_IdentityDictionary_t *dictionary = pointer;
+        sysmelb_gc_markPointer(dictionary->keys);
+        for(size_t i = 0; i < dictionary->capacity; ++i)
+        {
+            sysmelb_gc_visit(SysmelGCObjectConservative, dictionary->keys[i]);
+            sysmelb_gc_visit(SysmelGCObjectConservative, dictionary->values[i]);
+        }
+        break;
+    }
+    case SysmelGCObjectConservative:
+        sysmelb_gc_traceConservatively(grayObject->allocationStart, grayObject->allocationSize);
+        break;
+    default:
+        abort();
+    }
+}
+
+void sysmelb_gc_setNativeStackBottom(void *stackBottom)
+{
+    sysmelb_GCNativeStackBottom = stackBottom;
+}
+
+// The C evaluator and the primitives that call back into interpreted code keep
+// references in native locals, so the native stack is scanned conservatively.
+// Saving the context spills the registers into this frame.
+static void __attribute__((noinline)) sysmelb_gc_markNativeStack(void)
+{
+    if(!sysmelb_GCNativeStackBottom)
+        return;
+
+    jmp_buf registers;
+    setjmp(registers);
+
+    uintptr_t stackTop = (uintptr_t)&registers & ~(uintptr_t)(sizeof(uintptr_t) - 1);
+    uintptr_t stackBottom = (uintptr_t)sysmelb_GCNativeStackBottom;
+    assert(stackTop <= stackBottom);
+    for(uintptr_t *word = (uintptr_t*)stackTop; word < (uintptr_t*)stackBottom; ++word)
+        sysmelb_gc_visitConservativeWord(*word);
+}
+
+static void sysmelb_gc_markRoots(void)
+{
+    // These are lazily created, so fetch them before marking anything.
+    const sysmelb_BasicTypes_t *basicTypes = sysmelb_getBasicTypes();
+    sysmelb_Environment_t *intrinsicsEnvironment = sysmelb_getOrCreateIntrinsicsEnvironment();
+
+    sysmelb_markInternedSymbols();
+
+    // The type table does not keep types alive. They are marked through the
+    // values that refer to them, except for the basic types, which are always
+    // alive.
+    sysmelb_Type_t * const *basicTypeList = (sysmelb_Type_t * const *)basicTypes;
+    for(size_t i = 0; i < sizeof(sysmelb_BasicTypes_t) / sizeof(sysmelb_Type_t*); ++i)
+        sysmelb_gc_visit(SysmelGCObjectType, basicTypeList[i]);
+
+    sysmelb_gc_traceEnvironment(intrinsicsEnvironment);
+    sysmelb_gc_visit(SysmelGCObjectModule, sysmelb_getRegisteredModules());
+    sysmelb_markActivationContexts();
+    sysmelb_allocationProfile_markReferences();
+    sysmelb_gc_markNativeStack();
+}
+
+void sysmelb_gc_collect(void)
+{
+    assert(!sysmelb_scratch_isInScope());
+    clock_t startTime = clock();
+
+    sysmelb_gc_markRoots();
+    while(sysmelb_GCGrayStackSize > 0)
+    {
+        sysmelb_GCGrayObject_t grayObject = sysmelb_GCGrayStack[--sysmelb_GCGrayStackSize];
+        sysmelb_gc_traceGrayObject(&grayObject);
+    }
+
+    sysmelb_type_sweepTypeTable();
+    size_t reclaimedBytes = sysmelb_memory_sweep();
+    double pauseTime = (double)(clock() - startTime) / CLOCKS_PER_SEC;
+
+    ++sysmelb_GCStatistics.collectionCount;
+    sysmelb_GCStatistics.reclaimedBytes += reclaimedBytes;
+    sysmelb_GCStatistics.lastLiveBytes = sysmelb_memory_getLiveBytes();
+    sysmelb_GCStatistics.totalPauseTime += pauseTime;
+    if(pauseTime > sysmelb_GCStatistics.maxPauseTime)
+        sysmelb_GCStatistics.maxPauseTime = pauseTime;
+}
+
+void sysmelb_gc_safePoint(void)
+{
+    // Scratch allocations are not traced, and can refer to the heap.
+    if(sysmelb_scratch_isInScope())
+        return;
+
+    size_t threshold = sysmelb_GCStatistics.lastLiveBytes;
+    if(threshold < SYSMELB_GC_MINIMUM_COLLECTION_THRESHOLD)
+        threshold = SYSMELB_GC_MINIMUM_COLLECTION_THRESHOLD;
+
+    if(sysmelb_memory_getAllocatedBytesSinceSweep() >= threshold)
+        sysmelb_gc_collect();
+}
+
+const sysmelb_GCStatistics_t *sysmelb_gc_getStatistics(void)
+{
+    return &sysmelb_GCStatistics;
+}
+
+void sysmelb_gc_printStatistics(void)
+{
+    fprintf(stderr, "GC collections: %zu\n", sysmelb_GCStatistics.collectionCount);
+    fprintf(stderr, "GC total pause: %.3f ms\n", sysmelb_GCStatistics.totalPauseTime * 1000.0);
+    fprintf(stderr, "GC max pause: %.3f ms\n", sysmelb_GCStatistics.maxPauseTime * 1000.0);
+    fprintf(stderr, "GC bytes reclaimed: %zu\n", sysmelb_GCStatistics.reclaimedBytes);
+    fprintf(stderr, "GC live bytes: %zu\n", sysmelb_memory_getLiveBytes());
+}
@@ -0,0 +1,38 @@
+#ifndef SYSMELB_GC_H
+#define SYSMELB_GC_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct sysmelb_Value_s sysmelb_Value_t;
+typedef struct sysmelb_SourcePosition_s sysmelb_SourcePosition_t;
+typedef struct sysmelb_Type_s sysmelb_Type_t;
+
+typedef struct sysmelb_GCStatistics_s
+{
+    size_t collectionCount;
+    size_t reclaimedBytes;
+    size_t lastLiveBytes;
+    double totalPauseTime;
+    double maxPauseTime;
+} sysmelb_GCStatistics_t;
+
+void sysmelb_gc_markPointer(void *pointer);
+void sysmelb_gc_markType(sysmelb_Type_t *type);
+void sysmelb_gc_markValue(sysmelb_Value_t *value);
+void sysmelb_gc_markSourcePosition(sysmelb_SourcePosition_t *sourcePosition);
+
+// Collections are only performed at safe points: between the top-level
+// command line items, after loading a file, and when entering an interpreted
+// function. The native stack is scanned conservatively, from the point of the
+// collection up to the bottom set by main.
+void sysmelb_gc_setNativeStackBottom(void *stackBottom);
+void sysmelb_gc_collect(void);
+void sysmelb_gc_safePoint(void);
+
+const sysmelb_GCStatistics_t *sysmelb_gc_getStatistics(void);
+void sysmelb_gc_printStatistics(void);
+
+#endif //SYSMELB_GC_H
@@ -0,0 +1,116 @@
+#ifndef SYSMELB_HASH_H
+#define SYSMELB_HASH_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Hashtables have power of two capacities, and take their starting index
+// from the low bits of the hash. This is the MurmurHash3 finaliser, which
+// spreads every input bit to those low bits. Pointers need it the most,
+// since their low bits are always zero due to alignment.
+static inline uint64_t sysmelb_hashMix64(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+static inline uint64_t sysmelb_hashPointer(const void *pointer)
+{
+    return sysmelb_hashMix64((uintptr_t)pointer);
+}
+
+// Strings are hashed with wyhash (final version 4), which reads eight bytes
+// at a time and mixes them with 64x64->128 bit multiplications.
+static inline uint64_t sysmelb_hashMultiplyMix(uint64_t a, uint64_t b)
+{
+    __uint128_t product = (__uint128_t)a * b;
+    return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+static inline uint64_t sysmelb_hashRead64(const uint8_t *bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t sysmelb_hashRead32(const uint8_t *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
+
+static inline uint64_t sysmelb_hashBytes(size_t size, const void *data)
+{
+    static const uint64_t secret[4] = {
+        0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+    };
+
+    const uint8_t *bytes = data;
+    uint64_t seed = sysmelb_hashMultiplyMix(secret[0], secret[1]);
+    uint64_t a;
+    uint64_t b;
+    if(size <= 16)
+    {
+        if(size >= 4)
+        {
+            size_t middle = (size >> 3) << 2;
+            a = (sysmelb_hashRead32(bytes) << 32) | sysmelb_hashRead32(bytes + middle);
+            b = (sysmelb_hashRead32(bytes + size - 4) << 32) | sysmelb_hashRead32(bytes + size - 4 - middle);
+        }
+        else if(size > 0)
+        {
+            a = ((uint64_t)bytes[0] << 16) | ((uint64_t)bytes[size >> 1] << 8) | bytes[size - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
+    {
+        size_t remaining = size;
+        if(remaining > 48)
+        {
+            uint64_t seed1 = seed;
+            uint64_t seed2 = seed;
+            do
+            {
+                seed = sysmelb_hashMultiplyMix(sysmelb_hashRead64(bytes) ^ secret[1], sysmelb_hashRead64(bytes + 8) ^ seed);
+                seed1 = sysmelb_hashMultiplyMix(sysmelb_hashRead64(bytes + 16) ^ secret[2], sysmelb_hashRead64(bytes + 24) ^ seed1);
+                seed2 = sysmelb_hashMultiplyMix(sysmelb_hashRead64(bytes + 32) ^ secret[3], sysmelb_hashRead64(bytes + 40) ^ seed2);
+                bytes += 48;
+                remaining -= 48;
+            } while(remaining > 48);
+            seed ^= seed1 ^ seed2;
+        }
+
+        while(remaining > 16)
+        {
+            seed = sysmelb_hashMultiplyMix(sysmelb_hashRead64(bytes) ^ secret[1], sysmelb_hashRead64(bytes + 8) ^ seed);
+            bytes += 16;
+            remaining -= 16;
+        }
+
+        a = sysmelb_hashRead64(bytes + remaining - 16);
+        b = sysmelb_hashRead64(bytes + remaining - 8);
+    }
+
+    a ^= secret[1];
+    b ^= seed;
+    __uint128_t product = (__uint128_t)a * b;
+    a = (uint64_t)product;
+    b = (uint64_t)(product >> 64);
+    return sysmelb_hashMultiplyMix(a ^ secret[0] ^ size, b ^ secret[1]);
+}
+
+#endif //SYSMELB_HASH_H
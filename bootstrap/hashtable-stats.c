@@ -0,0 +1,283 @@
+#include "hashtable-stats.h"
+#include "hash.h"
+#include "environment.h"
+#include "module.h"
+#include "namespace.h"
+#include "types.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct sysmelb_HashtableRecord_s
+{
+    const void *table;
+    sysmelb_HashtableKind_t kind;
+    size_t resizeCount;
+    size_t wastedBytes;
+} sysmelb_HashtableRecord_t;
+
+typedef struct sysmelb_HashtableKindStats_s
+{
+    size_t tableCount;
+    size_t resizeCount;
+    size_t wastedBytes;
+    size_t resizedElementCount;
+    size_t totalProbeLength;
+    size_t maxProbeLength;
+} sysmelb_HashtableKindStats_t;
+
+typedef struct sysmelb_OwnedHashtable_s
+{
+    char owner[128];
+    sysmelb_HashtableMeasure_t measure;
+    sysmelb_HashtableRecord_t *record;
+} sysmelb_OwnedHashtable_t;
+
+bool sysmelb_HashtableStatsEnabled;
+
+static const char *sysmelb_HashtableKindNames[SysmelHashtableKindCount] = {
+    "Interned symbols",
+    "Symbol hashtables",
+    "Identity hashsets",
+    "Identity dictionaries",
+};
+
+// The records are kept outside of the collected heap, and refer to the
+// tables by their address. A table that starts empty at the address of a
+// collected one takes over its record.
+static sysmelb_HashtableRecord_t *sysmelb_HashtableRecords;
+static size_t sysmelb_HashtableRecordCount;
+static size_t sysmelb_HashtableRecordCapacity;
+static sysmelb_HashtableKindStats_t sysmelb_HashtableKindStats[SysmelHashtableKindCount];
+
+static sysmelb_OwnedHashtable_t *sysmelb_OwnedHashtables;
+static size_t sysmelb_OwnedHashtableCount;
+static size_t sysmelb_OwnedHashtableCapacity;
+
+void sysmelb_hashtableStats_enable(void)
+{
+    sysmelb_HashtableStatsEnabled = true;
+}
+
+static sysmelb_HashtableRecord_t *sysmelb_hashtableStats_scanFor(const void *table)
+{
+    if(!sysmelb_HashtableRecordCapacity)
+        return NULL;
+
+    size_t mask = sysmelb_HashtableRecordCapacity - 1;
+    size_t index = sysmelb_hashPointer(table) & mask;
+    for(;;)
+    {
+        sysmelb_HashtableRecord_t *record = sysmelb_HashtableRecords + index;
+        if(!record->table || record->table == table)
+            return record;
+        index = (index + 1) & mask;
+    }
+}
+
+static void sysmelb_hashtableStats_increaseCapacity(void)
+{
+    sysmelb_HashtableRecord_t *oldRecords = sysmelb_HashtableRecords;
+    size_t oldCapacity = sysmelb_HashtableRecordCapacity;
+
+    sysmelb_HashtableRecordCapacity = oldCapacity ? oldCapacity*2 : 1024;
+    sysmelb_HashtableRecords = calloc(sysmelb_HashtableRecordCapacity, sizeof(sysmelb_HashtableRecord_t));
+    if(!sysmelb_HashtableRecords)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        abort();
+    }
+
+    for(size_t i = 0; i < oldCapacity; ++i)
+    {
+        if(oldRecords[i].table)
+            *sysmelb_hashtableStats_scanFor(oldRecords[i].table) = oldRecords[i];
+    }
+
+    free(oldRecords);
+}
+
+void sysmelb_hashtableStats_recordResize(const void *table, sysmelb_HashtableKind_t kind, const sysmelb_HashtableMeasure_t *measure)
+{
+    if(sysmelb_HashtableRecordCount*4 >= sysmelb_HashtableRecordCapacity*3)
+        sysmelb_hashtableStats_increaseCapacity();
+
+    sysmelb_HashtableKindStats_t *kindStats = sysmelb_HashtableKindStats + kind;
+    sysmelb_HashtableRecord_t *record = sysmelb_hashtableStats_scanFor(table);
+    if(!record->table)
+    {
+        record->table = table;
+        ++sysmelb_HashtableRecordCount;
+        ++kindStats->tableCount;
+    }
+    else if(!measure->capacity)
+    {
+        ++kindStats->tableCount;
+        record->resizeCount = 0;
+        record->wastedBytes = 0;
+    }
+    record->kind = kind;
+
+    // Allocating the first storage is not a resize.
+    if(!measure->capacity)
+        return;
+
+    ++record->resizeCount;
+    record->wastedBytes += measure->storageBytes;
+
+    ++kindStats->resizeCount;
+    kindStats->wastedBytes += measure->storageBytes;
+    kindStats->resizedElementCount += measure->size;
+    kindStats->totalProbeLength += measure->totalProbeLength;
+    if(measure->maxProbeLength > kindStats->maxProbeLength)
+        kindStats->maxProbeLength = measure->maxProbeLength;
+}
+
+static sysmelb_OwnedHashtable_t *sysmelb_hashtableStats_addOwnedTable(const void *table)
+{
+    if(sysmelb_OwnedHashtableCount >= sysmelb_OwnedHashtableCapacity)
+    {
+        sysmelb_OwnedHashtableCapacity = sysmelb_OwnedHashtableCapacity ? sysmelb_OwnedHashtableCapacity*2 : 256;
+        sysmelb_OwnedHashtables = realloc(sysmelb_OwnedHashtables, sysmelb_OwnedHashtableCapacity * sizeof(sysmelb_OwnedHashtable_t));
+        if(!sysmelb_OwnedHashtables)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+    }
+
+    sysmelb_OwnedHashtable_t *ownedTable = sysmelb_OwnedHashtables + sysmelb_OwnedHashtableCount++;
+    memset(ownedTable, 0, sizeof(sysmelb_OwnedHashtable_t));
+    ownedTable->record = sysmelb_hashtableStats_scanFor(table);
+    if(ownedTable->record && !ownedTable->record->table)
+        ownedTable->record = NULL;
+    return ownedTable;
+}
+
+static void sysmelb_hashtableStats_addOwnedSymbolHashtable(sysmelb_SymbolHashtable_t *table, const char *owner)
+{
+    if(!table->size)
+        return;
+
+    sysmelb_OwnedHashtable_t *ownedTable = sysmelb_hashtableStats_addOwnedTable(table);
+    snprintf(ownedTable->owner, sizeof(ownedTable->owner), "%s", owner);
+    sysmelb_SymbolHashtable_measure(table, &ownedTable->measure);
+}
+
+static int sysmelb_hashtableStats_nameSize(sysmelb_symbol_t *name)
+{
+    return name ? (int)name->size : 0;
+}
+
+static const char *sysmelb_hashtableStats_nameString(sysmelb_symbol_t *name)
+{
+    return name ? name->string : "";
+}
+
+static void sysmelb_hashtableStats_addNamespace(sysmelb_Namespace_t *namespace, const char *path, const char *separator)
+{
+    char owner[128];
+    snprintf(owner, sizeof(owner), "%s%s%.*s", path, separator, sysmelb_hashtableStats_nameSize(namespace->name), sysmelb_hashtableStats_nameString(namespace->name));
+    sysmelb_hashtableStats_addOwnedSymbolHashtable(&namespace->exportedObjects, owner);
+
+    // Child namespaces are exported by their parent.
+    for(size_t i = 0; i < namespace->exportedObjects.capacity; ++i)
+    {
+        sysmelb_SymbolBinding_t *binding = namespace->exportedObjects.values[i];
+        if(namespace->exportedObjects.keys[i] && binding && binding->kind == SysmelSymbolValueBinding
+            && sysmelb_value_getKind(binding->value) == SysmelValueKindNamespaceReference && sysmelb_value_getReference(binding->value, namespace) != namespace)
+            sysmelb_hashtableStats_addNamespace(sysmelb_value_getReference(binding->value, namespace), owner, ".");
+    }
+}
+
+static void sysmelb_hashtableStats_collectOwnedTables(void)
+{
+    sysmelb_OwnedHashtable_t *symbolsTable = sysmelb_hashtableStats_addOwnedTable(NULL);
+    strcpy(symbolsTable->owner, "interned symbols");
+    sysmelb_measureInternedSymbols(&symbolsTable->measure);
+    for(size_t i = 0; i < sysmelb_HashtableRecordCapacity; ++i)
+    {
+        if(sysmelb_HashtableRecords[i].table && sysmelb_HashtableRecords[i].kind == SysmelHashtableKindInternedSymbols)
+            symbolsTable->record = sysmelb_HashtableRecords + i;
+    }
+
+    sysmelb_hashtableStats_addOwnedSymbolHashtable(&sysmelb_getOrCreateIntrinsicsEnvironment()->localSymbolTable, "intrinsics environment");
+
+    char owner[128];
+    for(uint32_t i = 1; i < sysmelb_TypeTableSize; ++i)
+    {
+        sysmelb_Type_t *type = sysmelb_TypeTable[i];
+        if(!type)
+            continue;
+
+        snprintf(owner, sizeof(owner), "type %.*s methods", sysmelb_hashtableStats_nameSize(type->name), sysmelb_hashtableStats_nameString(type->name));
+        sysmelb_hashtableStats_addOwnedSymbolHashtable(&type->methodDict, owner);
+    }
+
+    for(sysmelb_Module_t *module = sysmelb_getRegisteredModules(); module; module = module->nextModule)
+    {
+        int moduleNameSize = sysmelb_hashtableStats_nameSize(module->name);
+        const char *moduleName = sysmelb_hashtableStats_nameString(module->name);
+        if(module->moduleEnvironment)
+        {
+            snprintf(owner, sizeof(owner), "module %.*s environment", moduleNameSize, moduleName);
+            sysmelb_hashtableStats_addOwnedSymbolHashtable(&module->moduleEnvironment->localSymbolTable, owner);
+        }
+        if(module->globalNamespaceEnvironment)
+        {
+            snprintf(owner, sizeof(owner), "module %.*s global namespace environment", moduleNameSize, moduleName);
+            sysmelb_hashtableStats_addOwnedSymbolHashtable(&module->globalNamespaceEnvironment->localSymbolTable, owner);
+        }
+        if(module->globalNamespace)
+        {
+            snprintf(owner, sizeof(owner), "module %.*s namespace", moduleNameSize, moduleName);
+            sysmelb_hashtableStats_addNamespace(module->globalNamespace, owner, " ");
+        }
+    }
+}
+
+static int sysmelb_hashtableStats_compareOwnedTables(const void *a, const void *b)
+{
+    const sysmelb_OwnedHashtable_t *tableA = a;
+    const sysmelb_OwnedHashtable_t *tableB = b;
+    if(tableA->measure.size != tableB->measure.size)
+        return tableA->measure.size < tableB->measure.size ? 1 : -1;
+    return strcmp(tableA->owner, tableB->owner);
+}
+
+void sysmelb_hashtableStats_print(void)
+{
+    sysmelb_hashtableStats_collectOwnedTables();
+    qsort(sysmelb_OwnedHashtables, sysmelb_OwnedHashtableCount, sizeof(sysmelb_OwnedHashtable_t), sysmelb_hashtableStats_compareOwnedTables);
+
+    fprintf(stderr, "%10s %10s %6s %9s %9s %8s %12s  %s\n", "Size", "Capacity", "Load", "AvgProbe", "MaxProbe", "Resizes", "Wasted", "Owner");
+    for(size_t i = 0; i < sysmelb_OwnedHashtableCount; ++i)
+    {
+        sysmelb_OwnedHashtable_t *ownedTable = sysmelb_OwnedHashtables + i;
+        sysmelb_HashtableMeasure_t *measure = &ownedTable->measure;
+        fprintf(stderr, "%10zu %10zu %6.2f %9.2f %9zu %8zu %12zu  %s\n", measure->size, measure->capacity,
+            measure->capacity ? (double)measure->size / measure->capacity : 0.0,
+            measure->size ? (double)measure->totalProbeLength / measure->size : 0.0,
+            measure->maxProbeLength,
+            ownedTable->record ? ownedTable->record->resizeCount : 0,
+            ownedTable->record ? ownedTable->record->wastedBytes : 0,
+            ownedTable->owner);
+    }
+
+    fprintf(stderr, "\nProbe lengths measured at resize time:\n");
+    fprintf(stderr, "%10s %10s %12s %9s %9s  %s\n", "Tables", "Resizes", "Wasted", "AvgProbe", "MaxProbe", "Kind");
+    for(int kind = 0; kind < SysmelHashtableKindCount; ++kind)
+    {
+        sysmelb_HashtableKindStats_t *kindStats = sysmelb_HashtableKindStats + kind;
+        fprintf(stderr, "%10zu %10zu %12zu %9.2f %9zu  %s\n", kindStats->tableCount, kindStats->resizeCount, kindStats->wastedBytes,
+            kindStats->resizedElementCount ? (double)kindStats->totalProbeLength / kindStats->resizedElementCount : 0.0,
+            kindStats->maxProbeLength,
+            sysmelb_HashtableKindNames[kind]);
+    }
+
+    free(sysmelb_OwnedHashtables);
+    sysmelb_OwnedHashtables = NULL;
+    sysmelb_OwnedHashtableCount = 0;
+    sysmelb_OwnedHashtableCapacity = 0;
+}
@@ -0,0 +1,38 @@
+#ifndef SYSMELB_HASHTABLE_STATS_H
+#define SYSMELB_HASHTABLE_STATS_H
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef enum sysmelb_HashtableKind_e
+{
+    SysmelHashtableKindInternedSymbols,
+    SysmelHashtableKindSymbolHashtable,
+    SysmelHashtableKindIdentityHashset,
+    SysmelHashtableKindIdentityDictionary,
+    SysmelHashtableKindCount,
+} sysmelb_HashtableKind_t;
+
+// The probe length of an element is the number of slots that a lookup visits
+// to find it, or the number of groups for the symbol hashtables.
+typedef struct sysmelb_HashtableMeasure_s
+{
+    size_t size;
+    size_t capacity;
+    size_t storageBytes;
+    size_t totalProbeLength;
+    size_t maxProbeLength;
+} sysmelb_HashtableMeasure_t;
+
+extern bool sysmelb_HashtableStatsEnabled;
+
+// Tables are measured each time that they are resized, just before it, which
+// is when they are the fullest. The tables that are still reachable from the
+// interned symbols, the types and the modules are measured again at exit.
+void sysmelb_hashtableStats_enable(void);
+void sysmelb_hashtableStats_recordResize(const void *table, sysmelb_HashtableKind_t kind, const sysmelb_HashtableMeasure_t *measure);
+void sysmelb_hashtableStats_print(void);
+
+#endif //SYSMELB_HASHTABLE_STATS_H
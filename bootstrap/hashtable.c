@@ -1,149 +1,534 @@
 #include "hashtable.h"
+#include "hash.h"
 #include "memory.h"
 #include "value.h"
 #include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SYSMELB_SYMBOL_HASHTABLE_EMPTY 0
+#define SYSMELB_SYMBOL_HASHTABLE_TOMBSTONE 1
+
+// Returns the slot holding the key, or the first empty or removed slot where
+// it should be inserted. Groups are probed with triangular increments, which
+// visit every group when their count is a power of two. A group with an
+// empty slot ends the probe sequence, but a removed slot does not.
 int sysmelb_SymbolHashtable_scanFor(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *key)
 {
-    size_t index = key->hash % table->capacity;
-    for(size_t i = index; i < table->capacity; ++i)
+    uint64_t hash = key->hash;
+    uint8_t controlByte = 0x80 | (hash & 0x7F);
+    size_t groupCount = table->capacity / SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE;
+    size_t groupMask = groupCount - 1;
+    size_t groupIndex = (hash >> 7) & groupMask;
+    int availableIndex = -1;
+#ifdef __SSE2__
+    __m128i pattern = _mm_set1_epi32((int)(controlByte * 0x01010101u));
+#endif
+    for(size_t i = 1; i <= groupCount; ++i)
     {
-        if(!table->data[i].key || table->data[i].key == key)
-            return i;
+        size_t groupStart = groupIndex * SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE;
+        const uint8_t *groupControlBytes = table->controlBytes + groupStart;
+
+        // The available slots are those without the high bit set.
+#ifdef __SSE2__
+        __m128i group = _mm_load_si128((const __m128i*)groupControlBytes);
+        uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi8(group, pattern));
+        uint32_t emptySlots = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_setzero_si128()));
+        uint32_t availableSlots = ~_mm_movemask_epi8(group) & 0xFFFF;
+#else
+        uint32_t matches = 0;
+        uint32_t emptySlots = 0;
+        uint32_t availableSlots = 0;
+        for(int j = 0; j < SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE; ++j)
+        {
+            if(groupControlBytes[j] == controlByte)
+                matches |= 1u << j;
+            else if(!(groupControlBytes[j] & 0x80))
+                availableSlots |= 1u << j;
+            if(groupControlBytes[j] == SYSMELB_SYMBOL_HASHTABLE_EMPTY)
+                emptySlots |= 1u << j;
+        }
+#endif
+        while(matches)
+        {
+            size_t index = groupStart + __builtin_ctz(matches);
+            if(table->keys[index] == key)
+                return index;
+            matches &= matches - 1;
+        }
+
+        if(availableIndex < 0 && availableSlots)
+            availableIndex = groupStart + __builtin_ctz(availableSlots);
+        if(emptySlots)
+            return availableIndex;
+
+        groupIndex = (groupIndex + i) & groupMask;
     }
 
-    for(size_t i = 0; i < index; ++i)
+    return availableIndex;
+}
+
+void sysmelb_SymbolHashtable_measure(sysmelb_SymbolHashtable_t *table, sysmelb_HashtableMeasure_t *measure)
+{
+    memset(measure, 0, sizeof(sysmelb_HashtableMeasure_t));
+    measure->size = table->size;
+    measure->capacity = table->capacity;
+    if(!table->capacity)
+        return;
+
+    if(table->displacements)
     {
-        if(!table->data[i].key || table->data[i].key == key)
-            return i;
+        measure->storageBytes = table->capacity*(sizeof(sysmelb_symbol_t*) + sizeof(void*)) + (table->displacementMask + 1)*sizeof(uint32_t);
+        measure->totalProbeLength = table->size;
+        measure->maxProbeLength = table->size ? 1 : 0;
+        return;
     }
 
-    return -1;
+    measure->storageBytes = table->capacity*(sizeof(sysmelb_symbol_t*) + sizeof(void*) + 1);
+    size_t groupCount = table->capacity / SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE;
+    size_t groupMask = groupCount - 1;
+    for(size_t i = 0; i < table->capacity; ++i)
+    {
+        if(!table->keys[i])
+            continue;
+
+        size_t elementGroup = i / SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE;
+        size_t groupIndex = (table->keys[i]->hash >> 7) & groupMask;
+        size_t probeLength = 1;
+        while(groupIndex != elementGroup && probeLength < groupCount)
+        {
+            groupIndex = (groupIndex + probeLength) & groupMask;
+            ++probeLength;
+        }
+
+        measure->totalProbeLength += probeLength;
+        if(probeLength > measure->maxProbeLength)
+            measure->maxProbeLength = probeLength;
+    }
 }
 
-void sysmelb_SymbolHashtable_incrementCapacity(sysmelb_SymbolHashtable_t *table)
+static void sysmelb_SymbolHashtable_recordResize(sysmelb_SymbolHashtable_t *table)
 {
-    size_t newCapacity = table->capacity*2;
-    if(newCapacity < 32)
-        newCapacity = 32;
+    sysmelb_HashtableMeasure_t measure;
+    sysmelb_SymbolHashtable_measure(table, &measure);
+    sysmelb_hashtableStats_recordResize(table, SysmelHashtableKindSymbolHashtable, &measure);
+}
 
-    sysmelb_SymbolHashtablePair_t *oldData = table->data;
+static void sysmelb_SymbolHashtable_allocateStorage(sysmelb_SymbolHashtable_t *table, size_t capacity)
+{
+    table->capacity = capacity;
+    table->targetCapacity = capacity * 7 / 8;
+    table->size = 0;
+    table->tombstoneCount = 0;
+    table->keys = sysmelb_allocate((sizeof(sysmelb_symbol_t*) + sizeof(void*) + 1)*capacity);
+    table->values = (void**)(table->keys + capacity);
+    table->controlBytes = (uint8_t*)(table->values + capacity);
+    table->displacements = NULL;
+    table->displacementMask = 0;
+}
+
+// Called when the elements and tombstones reach the target capacity. The new
+// capacity only depends on the number of elements, so a table full of
+// tombstones is rehashed in place, or even shrunk.
+void sysmelb_SymbolHashtable_rehash(sysmelb_SymbolHashtable_t *table)
+{
+    // Thawed tables are recorded before losing their displacements.
+    if(sysmelb_HashtableStatsEnabled && table->controlBytes)
+        sysmelb_SymbolHashtable_recordResize(table);
+
+    sysmelb_symbol_t **oldKeys = table->keys;
+    void **oldValues = table->values;
     size_t oldCapacity = table->capacity;
 
-    table->capacity = newCapacity;
-    table->targetCapacity = newCapacity * 80 / 100;
-    table->size = 0;
-    table->data = sysmelb_allocate(sizeof(sysmelb_SymbolHashtablePair_t)*newCapacity);
+    size_t newCapacity = SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE;
+    while(newCapacity * 7 / 16 < table->size)
+        newCapacity *= 2;
+    sysmelb_SymbolHashtable_allocateStorage(table, newCapacity);
 
     // Reinsert the old elements.
     for(size_t i = 0; i < oldCapacity; ++i)
     {
-        if(oldData[i].key)
-            sysmelb_SymbolHashtable_addSymbolWithValue(table, oldData[i].key, oldData[i].value);
+        if(oldKeys[i])
+            sysmelb_SymbolHashtable_addSymbolWithValue(table, oldKeys[i], oldValues[i]);
     }
 
-    sysmelb_freeAllocation(oldData);
+    sysmelb_freeAllocation(oldKeys);
+}
+
+static void sysmelb_SymbolHashtable_thaw(sysmelb_SymbolHashtable_t *table)
+{
+    if(sysmelb_HashtableStatsEnabled)
+        sysmelb_SymbolHashtable_recordResize(table);
+    table->displacements = NULL;
+    sysmelb_SymbolHashtable_rehash(table);
 }
 
 void sysmelb_SymbolHashtable_addSymbolWithValue(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *key, void *value)
 {
+    if(table->displacements)
+        sysmelb_SymbolHashtable_thaw(table);
     if(!table->capacity)
     {
-        table->capacity = 32;
-        table->targetCapacity = 32*80/100;
-        table->data = sysmelb_allocate(sizeof(sysmelb_SymbolHashtablePair_t) * table->capacity);
+        if(sysmelb_HashtableStatsEnabled)
+            sysmelb_SymbolHashtable_recordResize(table);
+        sysmelb_SymbolHashtable_allocateStorage(table, SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE);
     }
 
     int bucketIndex = sysmelb_SymbolHashtable_scanFor(table, key);
-    if(bucketIndex < 0 || table->size + 1 >= table->targetCapacity)
+    if(bucketIndex < 0 ||
+        (table->controlBytes[bucketIndex] == SYSMELB_SYMBOL_HASHTABLE_EMPTY && table->size + table->tombstoneCount + 1 > table->targetCapacity))
     {
-        sysmelb_SymbolHashtable_incrementCapacity(table);
+        sysmelb_SymbolHashtable_rehash(table);
         bucketIndex = sysmelb_SymbolHashtable_scanFor(table, key);
         assert(bucketIndex >= 0);
     }
 
-    sysmelb_SymbolHashtablePair_t *bucket = table->data + bucketIndex;
-    if(!bucket->key)
+    if(!table->keys[bucketIndex])
+    {
+        if(table->controlBytes[bucketIndex] == SYSMELB_SYMBOL_HASHTABLE_TOMBSTONE)
+            --table->tombstoneCount;
+        table->controlBytes[bucketIndex] = 0x80 | (key->hash & 0x7F);
         ++table->size;
-    bucket->key = key;
-    bucket->value = value;
+    }
+    table->keys[bucketIndex] = key;
+    table->values[bucketIndex] = value;
 }
 
-const sysmelb_SymbolHashtablePair_t *sysmelb_SymbolHashtable_lookupSymbol(sysmelb_SymbolHashtable_t *table,  sysmelb_symbol_t *key)
+bool sysmelb_SymbolHashtable_removeSymbol(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *key)
 {
     if(table->size == 0)
-        return NULL;
+        return false;
+    if(table->displacements)
+        sysmelb_SymbolHashtable_thaw(table);
 
     int bucketIndex = sysmelb_SymbolHashtable_scanFor(table, key);
-    if(bucketIndex < 0)
-        return NULL;
+    if(bucketIndex < 0 || !table->keys[bucketIndex])
+        return false;
+
+    // No probe sequence goes past a group with an empty slot, so the slot
+    // can be emptied instead of leaving a tombstone in that case.
+    size_t groupStart = bucketIndex & ~(SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE - 1);
+    bool groupHasEmptySlot = false;
+    for(size_t i = 0; i < SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE; ++i)
+        groupHasEmptySlot = groupHasEmptySlot || table->controlBytes[groupStart + i] == SYSMELB_SYMBOL_HASHTABLE_EMPTY;
+
+    if(groupHasEmptySlot)
+    {
+        table->controlBytes[bucketIndex] = SYSMELB_SYMBOL_HASHTABLE_EMPTY;
+    }
+    else
+    {
+        table->controlBytes[bucketIndex] = SYSMELB_SYMBOL_HASHTABLE_TOMBSTONE;
+        ++table->tombstoneCount;
+    }
 
-    sysmelb_SymbolHashtablePair_t *bucket = table->data + bucketIndex;
-    if(!bucket->key)
-        return NULL;
-    return bucket;
+    table->keys[bucketIndex] = NULL;
+    table->values[bucketIndex] = NULL;
+    --table->size;
+    return true;
 }
 
-int sysmelb_IdentityHashset_scanFor(sysmelb_IdentityHashset_t *table, void *key)
+static inline size_t sysmelb_SymbolHashtable_frozenSlotFor(uint64_t keyHash, uint32_t displacement, size_t slotMask)
+{
+    return sysmelb_hashMix64(keyHash + displacement) & slotMask;
+}
+
+bool sysmelb_SymbolHashtable_lookupSymbol(sysmelb_SymbolHashtable_t *table,  sysmelb_symbol_t *key, void **outValue)
+{
+    if(table->size == 0)
+        return false;
+
+    int bucketIndex;
+    if(table->displacements)
+    {
+        uint64_t keyHash = sysmelb_hashPointer(key);
+        uint32_t displacement = table->displacements[keyHash & table->displacementMask];
+        bucketIndex = sysmelb_SymbolHashtable_frozenSlotFor(keyHash, displacement, table->capacity - 1);
+    }
+    else if(table->capacity == SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE)
+    {
+        // A single group has no probe sequence, so only its matching control
+        // bytes are checked.
+        uint8_t controlByte = 0x80 | (key->hash & 0x7F);
+#ifdef __SSE2__
+        __m128i group = _mm_load_si128((const __m128i*)table->controlBytes);
+        uint32_t matches = _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)controlByte)));
+#else
+        uint32_t matches = 0;
+        for(int j = 0; j < SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE; ++j)
+            matches |= (uint32_t)(table->controlBytes[j] == controlByte) << j;
+#endif
+        for(; matches; matches &= matches - 1)
+        {
+            size_t index = __builtin_ctz(matches);
+            if(table->keys[index] == key)
+            {
+                *outValue = table->values[index];
+                return true;
+            }
+        }
+        return false;
+    }
+    else
+    {
+        bucketIndex = sysmelb_SymbolHashtable_scanFor(table, key);
+        if(bucketIndex < 0)
+            return false;
+    }
+
+    if(table->keys[bucketIndex] != key)
+        return false;
+    *outValue = table->values[bucketIndex];
+    return true;
+}
+
+typedef struct sysmelb_SymbolHashtableFrozenKey_s
+{
+    uint64_t hash;
+    size_t bucket;
+    size_t bucketSize;
+    sysmelb_symbol_t *key;
+    void *value;
+} sysmelb_SymbolHashtableFrozenKey_t;
+
+static int sysmelb_SymbolHashtable_compareFrozenKeys(const void *a, const void *b)
 {
-    uintptr_t identityHash = (uintptr_t)key*1664525;
+    const sysmelb_SymbolHashtableFrozenKey_t *keyA = a;
+    const sysmelb_SymbolHashtableFrozenKey_t *keyB = b;
+    if(keyA->bucketSize != keyB->bucketSize)
+        return keyA->bucketSize < keyB->bucketSize ? 1 : -1;
+    if(keyA->bucket != keyB->bucket)
+        return keyA->bucket < keyB->bucket ? -1 : 1;
+    return 0;
+}
+
+// Places the buckets from the largest one, looking for a displacement that
+// sends all of the bucket keys to free slots. The keys are sorted by bucket.
+static bool sysmelb_SymbolHashtable_findDisplacements(sysmelb_SymbolHashtableFrozenKey_t *keys, size_t keyCount, uint32_t *displacements, size_t slotCount, int32_t *keyIndexPerSlot)
+{
+    size_t slotMask = slotCount - 1;
+    for(size_t i = 0; i < slotCount; ++i)
+        keyIndexPerSlot[i] = -1;
 
-    size_t index = identityHash % table->capacity;
-    for(size_t i = index; i < table->capacity; ++i)
+    size_t bucketStart = 0;
+    while(bucketStart < keyCount)
     {
-        if(!table->data[i] || table->data[i] == key)
-            return i;
+        size_t bucketEnd = bucketStart + keys[bucketStart].bucketSize;
+        bool placed = false;
+        for(uint32_t displacement = 0; displacement < (1u << 16) && !placed; ++displacement)
+        {
+            placed = true;
+            size_t i = bucketStart;
+            for(; i < bucketEnd; ++i)
+            {
+                size_t slot = sysmelb_SymbolHashtable_frozenSlotFor(keys[i].hash, displacement, slotMask);
+                if(keyIndexPerSlot[slot] >= 0)
+                {
+                    placed = false;
+                    break;
+                }
+                keyIndexPerSlot[slot] = i;
+            }
+
+            if(placed)
+            {
+                displacements[keys[bucketStart].bucket] = displacement;
+            }
+            else
+            {
+                // Undo the partial placement.
+                for(size_t j = bucketStart; j < i; ++j)
+                    keyIndexPerSlot[sysmelb_SymbolHashtable_frozenSlotFor(keys[j].hash, displacement, slotMask)] = -1;
+            }
+        }
+
+        if(!placed)
+            return false;
+        bucketStart = bucketEnd;
     }
 
-    for(size_t i = 0; i < index; ++i)
+    return true;
+}
+
+void sysmelb_SymbolHashtable_freeze(sysmelb_SymbolHashtable_t *table)
+{
+    if(table->displacements || table->size == 0)
+        return;
+    if(sysmelb_HashtableStatsEnabled)
+        sysmelb_SymbolHashtable_recordResize(table);
+
+    size_t keyCount = table->size;
+    size_t bucketCount = 1;
+    while(bucketCount*4 < keyCount)
+        bucketCount *= 2;
+    size_t bucketMask = bucketCount - 1;
+
+    sysmelb_SymbolHashtableFrozenKey_t *keys = calloc(keyCount, sizeof(sysmelb_SymbolHashtableFrozenKey_t));
+    size_t *bucketSizes = calloc(bucketCount, sizeof(size_t));
+    if(!keys || !bucketSizes)
+    {
+        fprintf(stderr, "Out of memory.\n");
+        abort();
+    }
+
+    size_t keyIndex = 0;
+    for(size_t i = 0; i < table->capacity; ++i)
     {
-        if(!table->data[i] || table->data[i] == key)
-            return i;
+        if(!table->keys[i])
+            continue;
+
+        keys[keyIndex].hash = sysmelb_hashPointer(table->keys[i]);
+        keys[keyIndex].bucket = keys[keyIndex].hash & bucketMask;
+        keys[keyIndex].key = table->keys[i];
+        keys[keyIndex].value = table->values[i];
+        ++bucketSizes[keys[keyIndex].bucket];
+        ++keyIndex;
+    }
+    assert(keyIndex == keyCount);
+
+    for(size_t i = 0; i < keyCount; ++i)
+        keys[i].bucketSize = bucketSizes[keys[i].bucket];
+    qsort(keys, keyCount, sizeof(sysmelb_SymbolHashtableFrozenKey_t), sysmelb_SymbolHashtable_compareFrozenKeys);
+
+    // Start at a load factor of at most 4/5, and make room until every bucket fits.
+    size_t slotCount = 1;
+    while(slotCount*4 < keyCount*5)
+        slotCount *= 2;
+
+    uint32_t *displacements = calloc(bucketCount, sizeof(uint32_t));
+    int32_t *keyIndexPerSlot = NULL;
+    for(;;)
+    {
+        keyIndexPerSlot = realloc(keyIndexPerSlot, slotCount * sizeof(int32_t));
+        if(!displacements || !keyIndexPerSlot)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+
+        if(sysmelb_SymbolHashtable_findDisplacements(keys, keyCount, displacements, slotCount, keyIndexPerSlot))
+            break;
+        slotCount *= 2;
+    }
+
+    sysmelb_symbol_t **oldKeys = table->keys;
+    table->capacity = slotCount;
+    table->targetCapacity = slotCount;
+    table->tombstoneCount = 0;
+    table->keys = sysmelb_allocate(slotCount*(sizeof(sysmelb_symbol_t*) + sizeof(void*)) + bucketCount*sizeof(uint32_t));
+    table->values = (void**)(table->keys + slotCount);
+    table->controlBytes = NULL;
+    table->displacements = (uint32_t*)(table->values + slotCount);
+    table->displacementMask = bucketMask;
+    memcpy(table->displacements, displacements, bucketCount*sizeof(uint32_t));
+    for(size_t i = 0; i < slotCount; ++i)
+    {
+        if(keyIndexPerSlot[i] >= 0)
+        {
+            table->keys[i] = keys[keyIndexPerSlot[i]].key;
+            table->values[i] = keys[keyIndexPerSlot[i]].value;
+        }
+    }
+
+    sysmelb_freeAllocation(oldKeys);
+    free(keyIndexPerSlot);
+    free(displacements);
+    free(bucketSizes);
+    free(keys);
+}
+
+int sysmelb_IdentityHashset_scanFor(sysmelb_IdentityHashset_t *table, void *key)
+{
+    size_t mask = table->capacity - 1;
+    size_t index = sysmelb_hashPointer(key) & mask;
+    for(size_t i = 0; i < table->capacity; ++i)
+    {
+        if(!table->data[index] || table->data[index] == key)
+            return index;
+        index = (index + 1) & mask;
     }
 
     return -1;
 }
 
+void sysmelb_IdentityHashset_measure(sysmelb_IdentityHashset_t *set, sysmelb_HashtableMeasure_t *measure)
+{
+    memset(measure, 0, sizeof(sysmelb_HashtableMeasure_t));
+    measure->size = set->size;
+    measure->capacity = set->capacity;
+    measure->storageBytes = set->capacity*(sizeof(void*) + sizeof(sysmelb_Value_t));
+
+    size_t mask = set->capacity - 1;
+    for(size_t i = 0; i < set->capacity; ++i)
+    {
+        if(!set->data[i])
+            continue;
+
+        size_t probeLength = ((i - sysmelb_hashPointer(set->data[i])) & mask) + 1;
+        measure->totalProbeLength += probeLength;
+        if(probeLength > measure->maxProbeLength)
+            measure->maxProbeLength = probeLength;
+    }
+}
+
 void sysmelb_IdentityHashset_incrementCapacity(sysmelb_IdentityHashset_t *set)
 {
+    if(sysmelb_HashtableStatsEnabled)
+    {
+        sysmelb_HashtableMeasure_t measure;
+        sysmelb_IdentityHashset_measure(set, &measure);
+        sysmelb_hashtableStats_recordResize(set, SysmelHashtableKindIdentityHashset, &measure);
+    }
+
     size_t newCapacity = set->capacity*2;
     if(newCapacity < 32)
         newCapacity = 32;
 
     void **oldData = set->data;
+    sysmelb_Value_t *oldElements = set->elements;
     size_t oldCapacity = set->capacity;
 
     set->capacity = newCapacity;
     set->targetCapacity = newCapacity * 80 / 100;
     set->size = 0;
-    set->data = sysmelb_allocate(sizeof(sysmelb_SymbolHashtablePair_t)*newCapacity);
+    set->data = sysmelb_allocate((sizeof(void*) + sizeof(sysmelb_Value_t))*newCapacity);
+    set->elements = (sysmelb_Value_t*)(set->data + newCapacity);
 
     // Reinsert the old elements.
     for(size_t i = 0; i < oldCapacity; ++i)
     {
         if(oldData[i])
-            sysmelb_IdentityHashset_add(set, oldData[i]);
+            sysmelb_IdentityHashset_add(set, oldElements[i]);
     }
 
     sysmelb_freeAllocation(oldData);
 }
 
-void sysmelb_IdentityHashset_add(sysmelb_IdentityHashset_t *set, void *value)
+void sysmelb_IdentityHashset_add(sysmelb_IdentityHashset_t *set, sysmelb_Value_t element)
 {
     if(set->capacity == 0 || set->size + 1 > set->capacity*80/100)
         sysmelb_IdentityHashset_incrementCapacity(set);
+    void *value = sysmelb_getValuePointer(element);
+    assert(value);
     int slot = sysmelb_IdentityHashset_scanFor(set, value);
     assert(slot >= 0);
     if(set->data[slot] != value)
     {
         set->data[slot] = value;
+        set->elements[slot] = element;
         ++set->size;
     }
 }
 
 bool sysmelb_IdentityHashset_includes(sysmelb_IdentityHashset_t *set, void *valuePointer)
 {
-    if(set->size == 0)
+    // Null marks the empty slots, so it is never an element.
+    if(set->size == 0 || !valuePointer)
         return false;
 
     int valueSlot = sysmelb_IdentityHashset_scanFor(set, valuePointer);
@@ -152,86 +537,205 @@ bool sysmelb_IdentityHashset_includes(sysmelb_IdentityHashset_t *set, void *valu
     return set->data[valueSlot] == valuePointer; 
 }
 
-int sysmelb_IdentityDictionary_scanFor(sysmelb_IdentityDictionary_t *table, void *key)
+// Linear probing allows removing without tombstones, by shifting back the
+// following elements of the cluster that would no longer be reachable.
+bool sysmelb_IdentityHashset_remove(sysmelb_IdentityHashset_t *set, void *value)
 {
-    if(!table->data)
-        return -1;
-    uintptr_t identityHash = (uintptr_t)key*1664525;
+    if(set->size == 0 || !value)
+        return false;
 
-    size_t index = identityHash % table->capacity;
-    for(size_t i = index; i < table->capacity; ++i)
+    int slot = sysmelb_IdentityHashset_scanFor(set, value);
+    if(slot < 0 || set->data[slot] != value)
+        return false;
+
+    size_t mask = set->capacity - 1;
+    size_t hole = slot;
+    for(size_t index = (hole + 1) & mask; set->data[index]; index = (index + 1) & mask)
     {
-        if(!table->data[i*2] || table->data[i*2] == key)
-            return i;
+        size_t home = sysmelb_hashPointer(set->data[index]) & mask;
+        if(((index - home) & mask) >= ((index - hole) & mask))
+        {
+            set->data[hole] = set->data[index];
+            set->elements[hole] = set->elements[index];
+            hole = index;
+        }
     }
 
-    for(size_t i = 0; i < index; ++i)
+    set->data[hole] = NULL;
+    memset(set->elements + hole, 0, sizeof(sysmelb_Value_t));
+    --set->size;
+    return true;
+}
+
+int sysmelb_IdentityDictionary_scanFor(sysmelb_IdentityDictionary_t *dictionary, void *key)
+{
+    if(dictionary->size == 0)
+        return -1;
+
+    size_t mask = dictionary->capacity - 1;
+    size_t index = sysmelb_hashPointer(key) & mask;
+    for(uint8_t probeLength = 1; dictionary->probeLengths[index] >= probeLength; ++probeLength)
     {
-        if(!table->data[i*2] || table->data[i*2] == key)
-            return i;
+        if(dictionary->keys[index] == key)
+            return index;
+        index = (index + 1) & mask;
     }
 
     return -1;
 }
 
-void sysmelb_IdentityDictionary_incrementCapacity(sysmelb_IdentityDictionary_t *dictionary)
+static void sysmelb_IdentityDictionary_incrementCapacity(sysmelb_IdentityDictionary_t *dictionary);
+
+// Inserts a key that is not in the dictionary, without counting it.
+static void sysmelb_IdentityDictionary_insertAbsent(sysmelb_IdentityDictionary_t *dictionary, void *key, void *value)
+{
+    size_t mask = dictionary->capacity - 1;
+    size_t index = sysmelb_hashPointer(key) & mask;
+    uint8_t probeLength = 1;
+    for(;;)
+    {
+        uint8_t slotProbeLength = dictionary->probeLengths[index];
+        if(!slotProbeLength)
+        {
+            dictionary->keys[index] = key;
+            dictionary->values[index] = value;
+            dictionary->probeLengths[index] = probeLength;
+            return;
+        }
+
+        if(slotProbeLength < probeLength)
+        {
+            void *displacedKey = dictionary->keys[index];
+            void *displacedValue = dictionary->values[index];
+            dictionary->keys[index] = key;
+            dictionary->values[index] = value;
+            dictionary->probeLengths[index] = probeLength;
+            key = displacedKey;
+            value = displacedValue;
+            probeLength = slotProbeLength;
+        }
+
+        if(probeLength == SYSMELB_IDENTITY_DICTIONARY_MAX_PROBE_LENGTH)
+        {
+            // The element being carried is not in the table at this point.
+            sysmelb_IdentityDictionary_incrementCapacity(dictionary);
+            sysmelb_IdentityDictionary_insertAbsent(dictionary, key, value);
+            return;
+        }
+
+        index = (index + 1) & mask;
+        ++probeLength;
+    }
+}
+
+void sysmelb_IdentityDictionary_measure(sysmelb_IdentityDictionary_t *dictionary, sysmelb_HashtableMeasure_t *measure)
+{
+    memset(measure, 0, sizeof(sysmelb_HashtableMeasure_t));
+    measure->size = dictionary->size;
+    measure->capacity = dictionary->capacity;
+    measure->storageBytes = dictionary->capacity*(sizeof(void*)*2 + 1);
+    for(size_t i = 0; i < dictionary->capacity; ++i)
+    {
+        size_t probeLength = dictionary->probeLengths[i];
+        measure->totalProbeLength += probeLength;
+        if(probeLength > measure->maxProbeLength)
+            measure->maxProbeLength = probeLength;
+    }
+}
+
+static void sysmelb_IdentityDictionary_incrementCapacity(sysmelb_IdentityDictionary_t *dictionary)
 {
+    if(sysmelb_HashtableStatsEnabled)
+    {
+        sysmelb_HashtableMeasure_t measure;
+        sysmelb_IdentityDictionary_measure(dictionary, &measure);
+        sysmelb_hashtableStats_recordResize(dictionary, SysmelHashtableKindIdentityDictionary, &measure);
+    }
+
     size_t newCapacity = dictionary->capacity*2;
     if(newCapacity < 32)
         newCapacity = 32;
 
-    void **oldData = dictionary->data;
+    void **oldKeys = dictionary->keys;
+    void **oldValues = dictionary->values;
+    uint8_t *oldProbeLengths = dictionary->probeLengths;
     size_t oldCapacity = dictionary->capacity;
 
     dictionary->capacity = newCapacity;
     dictionary->targetCapacity = newCapacity * 80 / 100;
-    dictionary->size = 0;
-    dictionary->data = sysmelb_allocate(sizeof(void*)*newCapacity*2);
+    dictionary->keys = sysmelb_allocate((sizeof(void*)*2 + 1)*newCapacity);
+    dictionary->values = dictionary->keys + newCapacity;
+    dictionary->probeLengths = (uint8_t*)(dictionary->values + newCapacity);
 
     // Reinsert the old elements.
     for(size_t i = 0; i < oldCapacity; ++i)
     {
-        if(oldData[i*2])
-            sysmelb_IdentityDictionary_atPut(dictionary, oldData[i*2], oldData[i*2 + 1]);
+        if(oldProbeLengths[i])
+            sysmelb_IdentityDictionary_insertAbsent(dictionary, oldKeys[i], oldValues[i]);
     }
 
-    sysmelb_freeAllocation(oldData);
+    sysmelb_freeAllocation(oldKeys);
 }
 
 bool sysmelb_IdentityDictionary_includesKey(sysmelb_IdentityDictionary_s *dictionary, void *key)
 {
-    int index = sysmelb_IdentityDictionary_scanFor(dictionary, key);
-    return index >= 0 && dictionary->data[index*2] == key;
+    return sysmelb_IdentityDictionary_scanFor(dictionary, key) >= 0;
 }
 
 void sysmelb_IdentityDictionary_atPut(sysmelb_IdentityDictionary_s *dictionary, void *key, void *value)
 {
-    if(!dictionary->data)
-        sysmelb_IdentityDictionary_incrementCapacity(dictionary);
     int index = sysmelb_IdentityDictionary_scanFor(dictionary, key);
-    assert(index >= 0);
-
-    if(!dictionary->data[index*2])
-    {
-        dictionary->data[index*2] = key;
-        dictionary->data[index*2 + 1] = value;
-        ++dictionary->size;
-        if(dictionary->size >= dictionary->targetCapacity)
-        sysmelb_IdentityDictionary_incrementCapacity(dictionary);
-    }
-    else
+    if(index >= 0)
     {
-        dictionary->data[index*2] = key;
-        dictionary->data[index*2 + 1] = value;
+        dictionary->values[index] = value;
+        return;
     }
+
+    if(dictionary->size + 1 > dictionary->targetCapacity)
+        sysmelb_IdentityDictionary_incrementCapacity(dictionary);
+    sysmelb_IdentityDictionary_insertAbsent(dictionary, key, value);
+    ++dictionary->size;
+}
+
+bool sysmelb_IdentityDictionary_lookup(sysmelb_IdentityDictionary_s *dictionary, void *key, void **outValue)
+{
+    int index = sysmelb_IdentityDictionary_scanFor(dictionary, key);
+    if(index < 0)
+        return false;
+
+    *outValue = dictionary->values[index];
+    return true;
 }
 
 void* sysmelb_IdentityDictionary_at(sysmelb_IdentityDictionary_s *dictionary, void *key)
 {
-    if(!dictionary->data) return NULL;
+    void *value = NULL;
+    sysmelb_IdentityDictionary_lookup(dictionary, key, &value);
+    return value;
+}
 
+bool sysmelb_IdentityDictionary_removeKey(sysmelb_IdentityDictionary_s *dictionary, void *key)
+{
     int index = sysmelb_IdentityDictionary_scanFor(dictionary, key);
-    assert(index >= 0);
+    if(index < 0)
+        return false;
+
+    // Shift back the following elements that are away from their home slot.
+    size_t mask = dictionary->capacity - 1;
+    size_t hole = index;
+    size_t next = (hole + 1) & mask;
+    while(dictionary->probeLengths[next] > 1)
+    {
+        dictionary->keys[hole] = dictionary->keys[next];
+        dictionary->values[hole] = dictionary->values[next];
+        dictionary->probeLengths[hole] = dictionary->probeLengths[next] - 1;
+        hole = next;
+        next = (next + 1) & mask;
+    }
 
-    return dictionary->data[index*2 + 1];
+    dictionary->keys[hole] = NULL;
+    dictionary->values[hole] = NULL;
+    dictionary->probeLengths[hole] = 0;
+    --dictionary->size;
+    return true;
 }
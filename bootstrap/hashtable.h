@@ -4,46 +4,82 @@
 #pragma once
 
 #include "symbol.h"
+#include "hashtable-stats.h"
 #include <stdbool.h>
 
-typedef struct sysmelb_SymbolHashtablePair_s
-{
-    sysmelb_symbol_t *key;
-    void *value;
-} sysmelb_SymbolHashtablePair_t;
+// Symbol hashtables keep a control byte per slot, which is zero for an empty
+// slot, one for a removed element, or has the high bit set and seven bits of
+// the key hash. Lookups compare the control bytes of a group of slots at once,
+// and only look at the keys whose control byte matches. Keys, values and
+// control bytes are separate arrays in the same allocation.
+//
+// A table that is read much more often than modified can be frozen. It is
+// then rebuilt with a perfect hash: the keys are split in buckets, and each
+// bucket has a displacement that sends its keys to distinct slots, so that a
+// lookup probes a single slot. The displacements replace the control bytes,
+// and adding or removing a key thaws the table back.
+#define SYSMELB_SYMBOL_HASHTABLE_GROUP_SIZE 16
 
 typedef struct sysmelb_SymbolHashtable_s
 {
     size_t capacity;
     size_t targetCapacity;
     size_t size;
-    sysmelb_SymbolHashtablePair_t *data;
+    size_t tombstoneCount;
+    sysmelb_symbol_t **keys;
+    void **values;
+    uint8_t *controlBytes;
+    uint32_t *displacements;
+    size_t displacementMask;
 } sysmelb_SymbolHashtable_t;
 
+typedef struct sysmelb_Value_s sysmelb_Value_t;
+
+// Identity hashsets are probed with the pointers of their elements, and keep
+// the elements themselves in a parallel array, so that they can be iterated.
 typedef struct sysmelb_IdentityHashset_s
 {
     size_t capacity;
     size_t targetCapacity;
     size_t size;
     void **data;
+    sysmelb_Value_t *elements;
 } sysmelb_IdentityHashset_t;
 
+// Identity dictionaries use Robin Hood probing: an element being inserted
+// takes the slot of any element that is closer to its home slot, which keeps
+// the probe lengths short and even, and lets a lookup stop at the first slot
+// with a shorter probe length than its own. The probe lengths are counted
+// from one, so that zero marks an empty slot. Keys, values and probe lengths
+// are separate arrays in the same allocation.
+#define SYSMELB_IDENTITY_DICTIONARY_MAX_PROBE_LENGTH 32
+
 typedef struct sysmelb_IdentityDictionary_s
 {
     size_t capacity;
     size_t targetCapacity;
     size_t size;
-    void **data;
+    void **keys;
+    void **values;
+    uint8_t *probeLengths;
 } sysmelb_IdentityDictionary_s;
 
 void sysmelb_SymbolHashtable_addSymbolWithValue(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *key, void *value);
-const sysmelb_SymbolHashtablePair_t *sysmelb_SymbolHashtable_lookupSymbol(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *keyToLookup);
+bool sysmelb_SymbolHashtable_lookupSymbol(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *keyToLookup, void **outValue);
+bool sysmelb_SymbolHashtable_removeSymbol(sysmelb_SymbolHashtable_t *table, sysmelb_symbol_t *key);
+void sysmelb_SymbolHashtable_freeze(sysmelb_SymbolHashtable_t *table);
+void sysmelb_SymbolHashtable_measure(sysmelb_SymbolHashtable_t *table, sysmelb_HashtableMeasure_t *measure);
 
-void sysmelb_IdentityHashset_add(sysmelb_IdentityHashset_t *set, void *value);
+void sysmelb_IdentityHashset_add(sysmelb_IdentityHashset_t *set, sysmelb_Value_t element);
 bool sysmelb_IdentityHashset_includes(sysmelb_IdentityHashset_t *set, void *value);
+bool sysmelb_IdentityHashset_remove(sysmelb_IdentityHashset_t *set, void *value);
+void sysmelb_IdentityHashset_measure(sysmelb_IdentityHashset_t *set, sysmelb_HashtableMeasure_t *measure);
 
 bool sysmelb_IdentityDictionary_includesKey(sysmelb_IdentityDictionary_s *dictionary, void *key);
 void sysmelb_IdentityDictionary_atPut(sysmelb_IdentityDictionary_s *dictionary, void *key, void *value);
+bool sysmelb_IdentityDictionary_lookup(sysmelb_IdentityDictionary_s *dictionary, void *key, void **outValue);
 void* sysmelb_IdentityDictionary_at(sysmelb_IdentityDictionary_s *dictionary, void *key);
+bool sysmelb_IdentityDictionary_removeKey(sysmelb_IdentityDictionary_s *dictionary, void *key);
+void sysmelb_IdentityDictionary_measure(sysmelb_IdentityDictionary_s *dictionary, sysmelb_HashtableMeasure_t *measure);
 
 #endif //SYSMELB_HASHTABLE_H
\ No newline at end of file
@@ -1,4 +1,8 @@
 #include "memory.h"
+#include "allocation-profile.h"
+#include "gc.h"
+#include "hashtable-stats.h"
+#include "method-cache.h"
 #include "scanner.h"
 #include "parser.h"
 #include "module.h"
@@ -8,6 +12,7 @@
 #include <stdio.h>
 
 static sysmelb_Module_t *currentModule = NULL;
+static bool printGCStatistics = false;
 
 void printHelp()
 {
@@ -22,20 +27,24 @@ void printVersion()
 void scanOnlyText(const char *text)
 {
     sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromString("CLI", text);
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
     sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
     printf("Scanned %d tokens:", (int)scannedTokens.size);
     for(size_t i = 0; i < scannedTokens.size; ++i)
     {
         printf(" %s", sysmelb_TokenKindToString(scannedTokens.tokens[i].kind));
     }
+    sysmelb_scratch_endScope(scratchScope);
 }
 
 void parseOnlyText(const char *text)
 {
     sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromString("CLI", text);
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
     sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
 
     sysmelb_ParseTreeNode_t *parseTree = parseTokenList(sourceCode, scannedTokens.size, scannedTokens.tokens);
+    sysmelb_scratch_endScope(scratchScope);
     sysmelb_dumpParseTree(parseTree);
     printf("\n");
 }
@@ -43,9 +52,11 @@ void parseOnlyText(const char *text)
 void evaluateText(const char *text)
 {
     sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromString("CLI", text);
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
     sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
 
     sysmelb_ParseTreeNode_t *parseTree = parseTokenList(sourceCode, scannedTokens.size, scannedTokens.tokens);
+    sysmelb_scratch_endScope(scratchScope);
     if(sysmelb_visitForDisplayingAndCountingErrors(parseTree) != 0)
         return;
 
@@ -58,8 +69,10 @@ void evaluateText(const char *text)
 void evaluateTextFileNamed(const char *textFileName)
 {
     sysmelb_SourceCode_t *sourceCode = sysmelb_makeSourceCodeFromFileNamed(textFileName);
+    sysmelb_ScratchScope_t scratchScope = sysmelb_scratch_beginScope();
     sysmelb_TokenDynarray_t scannedTokens = sysmelb_scanSourceCode(sourceCode);
     sysmelb_ParseTreeNode_t *parseTree = parseTokenList(sourceCode, scannedTokens.size, scannedTokens.tokens);
+    sysmelb_scratch_endScope(scratchScope);
     if(sysmelb_visitForDisplayingAndCountingErrors(parseTree) != 0)
         return;
     
@@ -71,6 +84,7 @@ void evaluateTextFileNamed(const char *textFileName)
 
 int main(int argc, const char **argv)
 {
+    sysmelb_gc_setNativeStackBottom(__builtin_frame_address(0));
     for(int i = 1; i < argc; ++i)
     {
         const char *arg = argv[i];
@@ -86,6 +100,22 @@ int main(int argc, const char **argv)
                 printVersion();
                 return 0;
             }
+            else if(!strcmp(arg, "-gc-stats"))
+            {
+                printGCStatistics = true;
+            }
+            else if(!strcmp(arg, "-alloc-profile"))
+            {
+                sysmelb_allocationProfile_enable();
+            }
+            else if(!strcmp(arg, "-hashtable-stats"))
+            {
+                sysmelb_hashtableStats_enable();
+            }
+            else if(!strcmp(arg, "-method-cache-stats"))
+            {
+                sysmelb_methodCacheStats_enable();
+            }
             else if(!strcmp(arg, "-scan-only") && i + 1 < argc)
             {
                 scanOnlyText(argv[++i]);
@@ -114,25 +144,25 @@ int main(int argc, const char **argv)
                     size_t stringSize = strlen(argv[i + j]);
                     char *stringData = sysmelb_allocate(stringSize + 1);
                     memcpy(stringData, argv[i + j], stringSize);
-                    sysmelb_Value_t stringValue = {
-                        .kind = SysmelValueKindStringReference,
-                        .type = sysmelb_getBasicTypes()->string,
-                        .string = stringData,
-                        .stringSize = stringSize,
-                    };
+                    sysmelb_Value_t stringValue = sysmelb_value_makeString(stringSize, stringData);
 
                     array->elements[j] = stringValue;
                 }
 
-                if(currentModule->mainEntryPointFunction.kind == SysmelValueKindFunctionReference)
+                if(sysmelb_value_getKind(currentModule->mainEntryPointFunction) == SysmelValueKindFunctionReference)
                 {
-                    sysmelb_Value_t arrayArgument = {
-                        .kind = SysmelValueKindArrayReference,
-                        .type = sysmelb_getBasicTypes()->array,
-                        .arrayReference = array,
-                    };
-                    sysmelb_Value_t result = sysmelb_callFunctionWithArguments(currentModule->mainEntryPointFunction.functionReference, 1, &arrayArgument);
-                    return result.integer;
+                    sysmelb_Value_t arrayArgument = sysmelb_value_makeReference(
+                        SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, array);
+                    sysmelb_Value_t result = sysmelb_callFunctionWithArguments(sysmelb_value_getReference(currentModule->mainEntryPointFunction, function), 1, &arrayArgument);
+                    if(printGCStatistics)
+                        sysmelb_gc_printStatistics();
+                    if(sysmelb_AllocationProfileEnabled)
+                        sysmelb_allocationProfile_print();
+                    if(sysmelb_HashtableStatsEnabled)
+                        sysmelb_hashtableStats_print();
+                    if(sysmelb_MethodCacheStatsEnabled)
+                        sysmelb_methodCacheStats_print();
+                    return sysmelb_value_getInteger(result);
                 }
             }
         }
@@ -141,7 +171,17 @@ int main(int argc, const char **argv)
             evaluateTextFileNamed(arg);            
         }
 
+        sysmelb_gc_safePoint();
     }
+
+    if(printGCStatistics)
+        sysmelb_gc_printStatistics();
+    if(sysmelb_AllocationProfileEnabled)
+        sysmelb_allocationProfile_print();
+    if(sysmelb_HashtableStatsEnabled)
+        sysmelb_hashtableStats_print();
+    if(sysmelb_MethodCacheStatsEnabled)
+        sysmelb_methodCacheStats_print();
     sysmelb_freeAll();
     return 0;
 }
@@ -1,42 +1,574 @@
 #include "memory.h"
+#include "allocation-profile.h"
 #include <stdlib.h>
+#include <stdint.h>
 #include <string.h>
+#include <stdio.h>
+#include <assert.h>
 
-typedef struct sysmelb_AllocationHeader_s sysmelb_AllocationHeader_t;
+#define SYSMELB_MEMORY_CHUNK_SIZE (256*1024)
+#define SYSMELB_MEMORY_ALIGNMENT 16
+#define SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT 256
+#define SYSMELB_MEMORY_SMALL_SIZE_CLASS_COUNT (SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT / SYSMELB_MEMORY_ALIGNMENT)
+#define SYSMELB_MEMORY_LARGE_SIZE_CLASS_COUNT 7
+#define SYSMELB_MEMORY_SIZE_CLASS_COUNT (SYSMELB_MEMORY_SMALL_SIZE_CLASS_COUNT + SYSMELB_MEMORY_LARGE_SIZE_CLASS_COUNT)
+#define SYSMELB_MEMORY_LARGEST_SIZE_CLASS (SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT << SYSMELB_MEMORY_LARGE_SIZE_CLASS_COUNT)
+#define SYSMELB_MEMORY_DEDICATED_CHUNK_CLASS UINT32_MAX
+#define SYSMELB_SCRATCH_BLOCK_SIZE (256*1024)
 
-static sysmelb_AllocationHeader_t *sysmelb_LastMemoryAllocation;
+typedef struct sysmelb_MemoryChunk_s sysmelb_MemoryChunk_t;
+typedef struct sysmelb_FreeObject_s sysmelb_FreeObject_t;
+typedef struct sysmelb_ScratchBlock_s sysmelb_ScratchBlock_t;
 
-struct sysmelb_AllocationHeader_s
+// Chunks are aligned to their size, so the chunk owning an allocation is
+// found by masking its address. Each chunk only holds objects from a single
+// size class. Allocations bigger than the largest size class get a dedicated
+// chunk of their own.
+struct sysmelb_MemoryChunk_s
 {
-    struct sysmelb_AllocationHeader_s *nextAllocation;
-    size_t allocationSize;
+    sysmelb_MemoryChunk_t *nextChunk;
+    sysmelb_MemoryChunk_t *previousChunk;
+    uint32_t sizeClass;
+    uint32_t objectSize;
+    size_t used;
+    size_t capacity;
+    size_t slotCount;
+    uint32_t *allocatedBits;
+    uint32_t *markBits;
+    uint32_t *sharedBits;
+    _Alignas(SYSMELB_MEMORY_ALIGNMENT) uint8_t data[];
 };
 
-void *sysmelb_allocate(size_t allocationSize)
+struct sysmelb_FreeObject_s
 {
-    size_t sizeWithHeader = sizeof(sysmelb_AllocationHeader_t) + allocationSize;
-    sysmelb_AllocationHeader_t *header = malloc(sizeWithHeader);
-    memset(header, 0, sizeWithHeader);
-    header->nextAllocation = sysmelb_LastMemoryAllocation;
-    header->allocationSize = allocationSize;
-    sysmelb_LastMemoryAllocation = header;
-    return header + 1;
+    sysmelb_FreeObject_t *nextFreeObject;
+};
+
+typedef struct sysmelb_MemorySizeClass_s
+{
+    sysmelb_MemoryChunk_t *currentChunk;
+    sysmelb_FreeObject_t *freeList;
+} sysmelb_MemorySizeClass_t;
+
+static sysmelb_MemorySizeClass_t sysmelb_MemorySizeClasses[SYSMELB_MEMORY_SIZE_CLASS_COUNT];
+static sysmelb_MemoryChunk_t *sysmelb_DedicatedMemoryChunks;
+
+// Address sorted list of every chunk, used for finding the allocation that
+// contains an arbitrary pointer while tracing.
+static sysmelb_MemoryChunk_t **sysmelb_ChunkRegistry;
+static size_t sysmelb_ChunkRegistrySize;
+static size_t sysmelb_ChunkRegistryCapacity;
+
+static size_t sysmelb_LiveAllocationBytes;
+static size_t sysmelb_AllocatedBytesSinceSweep;
+
+// Scratch blocks form a list that is used as a stack. Blocks past the current
+// one are kept around after a scope ends, for being reused by the next scope.
+struct sysmelb_ScratchBlock_s
+{
+    sysmelb_ScratchBlock_t *nextBlock;
+    size_t used;
+    size_t capacity;
+    uint8_t data[];
+};
+
+static sysmelb_ScratchBlock_t *sysmelb_FirstScratchBlock;
+static sysmelb_ScratchBlock_t *sysmelb_CurrentScratchBlock;
+static size_t sysmelb_ScratchScopeDepth;
+
+static uint32_t sysmelb_sizeClassForAllocationSize(size_t allocationSize)
+{
+    if(allocationSize <= SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT)
+        return allocationSize <= SYSMELB_MEMORY_ALIGNMENT ? 0 : (uint32_t)((allocationSize - 1) / SYSMELB_MEMORY_ALIGNMENT);
+
+    uint32_t sizeClass = SYSMELB_MEMORY_SMALL_SIZE_CLASS_COUNT;
+    size_t classSize = SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT*2;
+    while(classSize < allocationSize)
+    {
+        classSize *= 2;
+        ++sizeClass;
+    }
+
+    return sizeClass;
+}
+
+static size_t sysmelb_sizeClassObjectSize(uint32_t sizeClass)
+{
+    if(sizeClass < SYSMELB_MEMORY_SMALL_SIZE_CLASS_COUNT)
+        return (sizeClass + 1) * SYSMELB_MEMORY_ALIGNMENT;
+    return (size_t)SYSMELB_MEMORY_SMALL_SIZE_CLASS_LIMIT << (sizeClass - SYSMELB_MEMORY_SMALL_SIZE_CLASS_COUNT + 1);
+}
+
+static void sysmelb_outOfMemory(void)
+{
+    fprintf(stderr, "Out of memory.\n");
+    abort();
 }
 
+static size_t sysmelb_chunkRegistryLowerBound(void *address)
+{
+    size_t low = 0;
+    size_t high = sysmelb_ChunkRegistrySize;
+    while(low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if((uintptr_t)sysmelb_ChunkRegistry[middle] < (uintptr_t)address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+static void sysmelb_registerChunk(sysmelb_MemoryChunk_t *chunk)
+{
+    if(sysmelb_ChunkRegistrySize >= sysmelb_ChunkRegistryCapacity)
+    {
+        sysmelb_ChunkRegistryCapacity = sysmelb_ChunkRegistryCapacity ? sysmelb_ChunkRegistryCapacity*2 : 64;
+        sysmelb_ChunkRegistry = realloc(sysmelb_ChunkRegistry, sysmelb_ChunkRegistryCapacity * sizeof(sysmelb_MemoryChunk_t*));
+        if(!sysmelb_ChunkRegistry)
+            sysmelb_outOfMemory();
+    }
+
+    size_t index = sysmelb_chunkRegistryLowerBound(chunk);
+    memmove(sysmelb_ChunkRegistry + index + 1, sysmelb_ChunkRegistry + index, (sysmelb_ChunkRegistrySize - index) * sizeof(sysmelb_MemoryChunk_t*));
+    sysmelb_ChunkRegistry[index] = chunk;
+    ++sysmelb_ChunkRegistrySize;
+}
+
+static void sysmelb_unregisterChunk(sysmelb_MemoryChunk_t *chunk)
+{
+    size_t index = sysmelb_chunkRegistryLowerBound(chunk);
+    assert(index < sysmelb_ChunkRegistrySize && sysmelb_ChunkRegistry[index] == chunk);
+    memmove(sysmelb_ChunkRegistry + index, sysmelb_ChunkRegistry + index + 1, (sysmelb_ChunkRegistrySize - index - 1) * sizeof(sysmelb_MemoryChunk_t*));
+    --sysmelb_ChunkRegistrySize;
+}
+
+static sysmelb_MemoryChunk_t *sysmelb_allocateChunk(size_t dataSize, size_t objectSize)
+{
+    size_t chunkSize = (sizeof(sysmelb_MemoryChunk_t) + dataSize + SYSMELB_MEMORY_CHUNK_SIZE - 1) & ~(size_t)(SYSMELB_MEMORY_CHUNK_SIZE - 1);
+    sysmelb_MemoryChunk_t *chunk = aligned_alloc(SYSMELB_MEMORY_CHUNK_SIZE, chunkSize);
+    if(!chunk)
+        sysmelb_outOfMemory();
+
+    memset(chunk, 0, sizeof(sysmelb_MemoryChunk_t));
+    chunk->capacity = chunkSize - sizeof(sysmelb_MemoryChunk_t);
+    chunk->objectSize = (uint32_t)objectSize;
+    chunk->slotCount = objectSize ? chunk->capacity / objectSize : 1;
+
+    size_t bitmapWordCount = (chunk->slotCount + 31) / 32;
+    chunk->allocatedBits = calloc(bitmapWordCount*3, sizeof(uint32_t));
+    if(!chunk->allocatedBits)
+        sysmelb_outOfMemory();
+    chunk->markBits = chunk->allocatedBits + bitmapWordCount;
+    chunk->sharedBits = chunk->markBits + bitmapWordCount;
+
+    sysmelb_registerChunk(chunk);
+    return chunk;
+}
+
+static void sysmelb_releaseChunk(sysmelb_MemoryChunk_t *chunk)
+{
+    sysmelb_unregisterChunk(chunk);
+    free(chunk->allocatedBits);
+    free(chunk);
+}
+
+static sysmelb_MemoryChunk_t *sysmelb_chunkForAllocation(void *allocation)
+{
+    return (sysmelb_MemoryChunk_t*)((uintptr_t)allocation & ~(uintptr_t)(SYSMELB_MEMORY_CHUNK_SIZE - 1));
+}
+
+static size_t sysmelb_chunkSlotIndex(sysmelb_MemoryChunk_t *chunk, void *allocation)
+{
+    if(chunk->sizeClass == SYSMELB_MEMORY_DEDICATED_CHUNK_CLASS)
+        return 0;
+    return ((uint8_t*)allocation - chunk->data) / chunk->objectSize;
+}
+
+static void *sysmelb_allocateInDedicatedChunk(size_t allocationSize)
+{
+    sysmelb_MemoryChunk_t *chunk = sysmelb_allocateChunk(allocationSize, 0);
+    chunk->sizeClass = SYSMELB_MEMORY_DEDICATED_CHUNK_CLASS;
+    chunk->used = allocationSize;
+    chunk->allocatedBits[0] = 1;
+    chunk->nextChunk = sysmelb_DedicatedMemoryChunks;
+    if(sysmelb_DedicatedMemoryChunks)
+        sysmelb_DedicatedMemoryChunks->previousChunk = chunk;
+    sysmelb_DedicatedMemoryChunks = chunk;
+
+    sysmelb_LiveAllocationBytes += allocationSize;
+    sysmelb_AllocatedBytesSinceSweep += allocationSize;
+    memset(chunk->data, 0, allocationSize);
+    return chunk->data;
+}
+
+void *sysmelb_allocateAtSite(size_t allocationSize, const char *fileName, int line)
+{
+    if(sysmelb_AllocationProfileEnabled)
+        sysmelb_allocationProfile_record(fileName, line, allocationSize);
+
+    if(allocationSize > SYSMELB_MEMORY_LARGEST_SIZE_CLASS)
+        return sysmelb_allocateInDedicatedChunk(allocationSize);
+
+    uint32_t sizeClassIndex = sysmelb_sizeClassForAllocationSize(allocationSize);
+    sysmelb_MemorySizeClass_t *sizeClass = &sysmelb_MemorySizeClasses[sizeClassIndex];
+    size_t objectSize = sysmelb_sizeClassObjectSize(sizeClassIndex);
+
+    void *result = sizeClass->freeList;
+    if(result)
+    {
+        sizeClass->freeList = sizeClass->freeList->nextFreeObject;
+    }
+    else
+    {
+        sysmelb_MemoryChunk_t *chunk = sizeClass->currentChunk;
+        if(!chunk || chunk->used + objectSize > chunk->capacity)
+        {
+            chunk = sysmelb_allocateChunk(SYSMELB_MEMORY_CHUNK_SIZE - sizeof(sysmelb_MemoryChunk_t), objectSize);
+            chunk->sizeClass = sizeClassIndex;
+            chunk->nextChunk = sizeClass->currentChunk;
+            sizeClass->currentChunk = chunk;
+        }
+
+        result = chunk->data + chunk->used;
+        chunk->used += objectSize;
+    }
+
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForAllocation(result);
+    size_t slotIndex = sysmelb_chunkSlotIndex(chunk, result);
+    chunk->allocatedBits[slotIndex / 32] |= 1u << (slotIndex % 32);
+
+    sysmelb_LiveAllocationBytes += objectSize;
+    sysmelb_AllocatedBytesSinceSweep += objectSize;
+    memset(result, 0, allocationSize);
+    return result;
+}
 
 void sysmelb_freeAllocation(void *allocation)
 {
-    // TODO: Implement this properly.
-    (void)allocation;
+    if(!allocation)
+        return;
+
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForAllocation(allocation);
+    if(chunk->sizeClass == SYSMELB_MEMORY_DEDICATED_CHUNK_CLASS)
+    {
+        if(chunk->previousChunk)
+            chunk->previousChunk->nextChunk = chunk->nextChunk;
+        else
+            sysmelb_DedicatedMemoryChunks = chunk->nextChunk;
+        if(chunk->nextChunk)
+            chunk->nextChunk->previousChunk = chunk->previousChunk;
+        sysmelb_LiveAllocationBytes -= chunk->used;
+        sysmelb_releaseChunk(chunk);
+        return;
+    }
+
+    assert(chunk->sizeClass < SYSMELB_MEMORY_SIZE_CLASS_COUNT);
+    size_t slotIndex = sysmelb_chunkSlotIndex(chunk, allocation);
+    chunk->allocatedBits[slotIndex / 32] &= ~(1u << (slotIndex % 32));
+    chunk->sharedBits[slotIndex / 32] &= ~(1u << (slotIndex % 32));
+    sysmelb_LiveAllocationBytes -= chunk->objectSize;
+
+    sysmelb_MemorySizeClass_t *sizeClass = &sysmelb_MemorySizeClasses[chunk->sizeClass];
+    sysmelb_FreeObject_t *freeObject = allocation;
+    freeObject->nextFreeObject = sizeClass->freeList;
+    sizeClass->freeList = freeObject;
+}
+
+// Finds the allocated slot that contains an arbitrary pointer, which may point
+// into the middle of the allocation.
+static sysmelb_MemoryChunk_t *sysmelb_chunkForPointer(void *pointer, size_t *outSlotIndex)
+{
+    if(!pointer || sysmelb_ChunkRegistrySize == 0)
+        return NULL;
+
+    // Find the last chunk that starts at or before the pointer.
+    size_t index = sysmelb_chunkRegistryLowerBound(pointer);
+    if(index < sysmelb_ChunkRegistrySize && sysmelb_ChunkRegistry[index] == pointer)
+        return NULL;
+    if(index == 0)
+        return NULL;
+
+    sysmelb_MemoryChunk_t *chunk = sysmelb_ChunkRegistry[index - 1];
+    uint8_t *bytePointer = pointer;
+    if(bytePointer < chunk->data || bytePointer >= chunk->data + chunk->used)
+        return NULL;
+
+    size_t slotIndex = sysmelb_chunkSlotIndex(chunk, pointer);
+    if(!(chunk->allocatedBits[slotIndex / 32] & (1u << (slotIndex % 32))))
+        return NULL;
+
+    *outSlotIndex = slotIndex;
+    return chunk;
+}
+
+bool sysmelb_memory_markAllocation(void *pointer, void **outStart, size_t *outSize)
+{
+    size_t slotIndex;
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForPointer(pointer, &slotIndex);
+    if(!chunk)
+        return false;
+
+    uint32_t slotBit = 1u << (slotIndex % 32);
+    if(chunk->markBits[slotIndex / 32] & slotBit)
+        return false;
+
+    chunk->markBits[slotIndex / 32] |= slotBit;
+    if(chunk->sizeClass == SYSMELB_MEMORY_DEDICATED_CHUNK_CLASS)
+    {
+        *outStart = chunk->data;
+        *outSize = chunk->used;
+    }
+    else
+    {
+        *outStart = chunk->data + slotIndex * chunk->objectSize;
+        *outSize = chunk->objectSize;
+    }
+    return true;
+}
+
+static size_t sysmelb_sweepSizeClass(sysmelb_MemorySizeClass_t *sizeClass)
+{
+    size_t reclaimedBytes = 0;
+    sysmelb_FreeObject_t *freeList = NULL;
+    sysmelb_MemoryChunk_t **chunkLink = &sizeClass->currentChunk;
+    while(*chunkLink)
+    {
+        sysmelb_MemoryChunk_t *chunk = *chunkLink;
+        size_t usedSlotCount = chunk->used / chunk->objectSize;
+        size_t bitmapWordCount = (usedSlotCount + 31) / 32;
+        size_t liveSlotCount = 0;
+        for(size_t i = 0; i < bitmapWordCount; ++i)
+        {
+            uint32_t deadBits = chunk->allocatedBits[i] & ~chunk->markBits[i];
+            for(uint32_t bits = deadBits; bits; bits &= bits - 1)
+                reclaimedBytes += chunk->objectSize;
+
+            chunk->allocatedBits[i] &= chunk->markBits[i];
+            chunk->sharedBits[i] &= chunk->markBits[i];
+            chunk->markBits[i] = 0;
+            for(uint32_t bits = chunk->allocatedBits[i]; bits; bits &= bits - 1)
+                ++liveSlotCount;
+        }
+
+        if(liveSlotCount == 0 && chunk != sizeClass->currentChunk)
+        {
+            *chunkLink = chunk->nextChunk;
+            sysmelb_releaseChunk(chunk);
+            continue;
+        }
+
+        for(size_t i = usedSlotCount; i > 0; --i)
+        {
+            size_t slotIndex = i - 1;
+            if(chunk->allocatedBits[slotIndex / 32] & (1u << (slotIndex % 32)))
+                continue;
+
+            sysmelb_FreeObject_t *freeObject = (sysmelb_FreeObject_t*)(chunk->data + slotIndex * chunk->objectSize);
+            freeObject->nextFreeObject = freeList;
+            freeList = freeObject;
+        }
+
+        chunkLink = &chunk->nextChunk;
+    }
+
+    sizeClass->freeList = freeList;
+    return reclaimedBytes;
+}
+
+bool sysmelb_memory_markShared(void *pointer)
+{
+    size_t slotIndex;
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForPointer(pointer, &slotIndex);
+    if(!chunk)
+        return false;
+
+    chunk->sharedBits[slotIndex / 32] |= 1u << (slotIndex % 32);
+    return true;
+}
+
+bool sysmelb_memory_isShared(void *pointer)
+{
+    size_t slotIndex;
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForPointer(pointer, &slotIndex);
+    return chunk && (chunk->sharedBits[slotIndex / 32] & (1u << (slotIndex % 32))) != 0;
+}
+
+bool sysmelb_memory_isMarked(void *allocation)
+{
+    sysmelb_MemoryChunk_t *chunk = sysmelb_chunkForAllocation(allocation);
+    size_t slotIndex = sysmelb_chunkSlotIndex(chunk, allocation);
+    return (chunk->markBits[slotIndex / 32] & (1u << (slotIndex % 32))) != 0;
+}
+
+size_t sysmelb_memory_sweep(void)
+{
+    size_t reclaimedBytes = 0;
+    for(size_t i = 0; i < SYSMELB_MEMORY_SIZE_CLASS_COUNT; ++i)
+        reclaimedBytes += sysmelb_sweepSizeClass(&sysmelb_MemorySizeClasses[i]);
+    sysmelb_LiveAllocationBytes -= reclaimedBytes;
+
+    sysmelb_MemoryChunk_t *chunk = sysmelb_DedicatedMemoryChunks;
+    while(chunk)
+    {
+        sysmelb_MemoryChunk_t *nextChunk = chunk->nextChunk;
+        if(chunk->markBits[0])
+        {
+            chunk->markBits[0] = 0;
+        }
+        else
+        {
+            reclaimedBytes += chunk->used;
+            sysmelb_freeAllocation(chunk->data);
+        }
+        chunk = nextChunk;
+    }
+
+    sysmelb_AllocatedBytesSinceSweep = 0;
+    return reclaimedBytes;
+}
+
+size_t sysmelb_memory_getLiveBytes(void)
+{
+    return sysmelb_LiveAllocationBytes;
+}
+
+size_t sysmelb_memory_getAllocatedBytesSinceSweep(void)
+{
+    return sysmelb_AllocatedBytesSinceSweep;
+}
+
+sysmelb_ScratchScope_t sysmelb_scratch_beginScope(void)
+{
+    sysmelb_ScratchScope_t scope = {
+        .block = sysmelb_CurrentScratchBlock,
+        .used = sysmelb_CurrentScratchBlock ? sysmelb_CurrentScratchBlock->used : 0,
+    };
+    ++sysmelb_ScratchScopeDepth;
+    return scope;
+}
+
+void sysmelb_scratch_endScope(sysmelb_ScratchScope_t scope)
+{
+    assert(sysmelb_ScratchScopeDepth > 0);
+    --sysmelb_ScratchScopeDepth;
+
+    sysmelb_CurrentScratchBlock = scope.block ? scope.block : sysmelb_FirstScratchBlock;
+    if(sysmelb_CurrentScratchBlock)
+        sysmelb_CurrentScratchBlock->used = scope.used;
+}
+
+bool sysmelb_scratch_isInScope(void)
+{
+    return sysmelb_ScratchScopeDepth > 0;
+}
+
+static void sysmelb_freeScratchBlockList(sysmelb_ScratchBlock_t *block)
+{
+    while(block)
+    {
+        sysmelb_ScratchBlock_t *nextBlock = block->nextBlock;
+        free(block);
+        block = nextBlock;
+    }
+}
+
+static sysmelb_ScratchBlock_t *sysmelb_scratch_advanceBlock(size_t allocationSize)
+{
+    sysmelb_ScratchBlock_t **nextBlockLink = sysmelb_CurrentScratchBlock ? &sysmelb_CurrentScratchBlock->nextBlock : &sysmelb_FirstScratchBlock;
+    sysmelb_ScratchBlock_t *nextBlock = *nextBlockLink;
+    if(nextBlock && nextBlock->capacity < allocationSize)
+    {
+        sysmelb_freeScratchBlockList(nextBlock);
+        nextBlock = NULL;
+    }
+
+    if(!nextBlock)
+    {
+        size_t capacity = allocationSize > SYSMELB_SCRATCH_BLOCK_SIZE ? allocationSize : SYSMELB_SCRATCH_BLOCK_SIZE;
+        nextBlock = malloc(sizeof(sysmelb_ScratchBlock_t) + capacity);
+        if(!nextBlock)
+            sysmelb_outOfMemory();
+        nextBlock->nextBlock = NULL;
+        nextBlock->capacity = capacity;
+        *nextBlockLink = nextBlock;
+    }
+
+    nextBlock->used = 0;
+    sysmelb_CurrentScratchBlock = nextBlock;
+    return nextBlock;
+}
+
+void *sysmelb_scratch_allocate(size_t allocationSize)
+{
+    allocationSize = (allocationSize + SYSMELB_MEMORY_ALIGNMENT - 1) & ~(size_t)(SYSMELB_MEMORY_ALIGNMENT - 1);
+    sysmelb_ScratchBlock_t *block = sysmelb_CurrentScratchBlock;
+    if(!block || block->used + allocationSize > block->capacity)
+        block = sysmelb_scratch_advanceBlock(allocationSize);
+
+    void *result = block->data + block->used;
+    block->used += allocationSize;
+    memset(result, 0, allocationSize);
+    return result;
+}
+
+void *sysmelb_scratch_reallocate(void *allocation, size_t oldSize, size_t newSize)
+{
+    if(!allocation)
+        return sysmelb_scratch_allocate(newSize);
+
+    // Growing the last allocation of the current block is done in place.
+    size_t alignedOldSize = (oldSize + SYSMELB_MEMORY_ALIGNMENT - 1) & ~(size_t)(SYSMELB_MEMORY_ALIGNMENT - 1);
+    size_t alignedNewSize = (newSize + SYSMELB_MEMORY_ALIGNMENT - 1) & ~(size_t)(SYSMELB_MEMORY_ALIGNMENT - 1);
+    sysmelb_ScratchBlock_t *block = sysmelb_CurrentScratchBlock;
+    if(block && (uint8_t*)allocation + alignedOldSize == block->data + block->used &&
+        block->used - alignedOldSize + alignedNewSize <= block->capacity)
+    {
+        block->used = block->used - alignedOldSize + alignedNewSize;
+        if(newSize > oldSize)
+            memset((uint8_t*)allocation + oldSize, 0, newSize - oldSize);
+        return allocation;
+    }
+
+    void *result = sysmelb_scratch_allocate(newSize);
+    memcpy(result, allocation, oldSize < newSize ? oldSize : newSize);
+    return result;
+}
+
+static void sysmelb_freeChunkList(sysmelb_MemoryChunk_t *chunk)
+{
+    while(chunk)
+    {
+        sysmelb_MemoryChunk_t *nextChunk = chunk->nextChunk;
+        free(chunk->allocatedBits);
+        free(chunk);
+        chunk = nextChunk;
+    }
 }
 
 void sysmelb_freeAll(void)
 {
-    sysmelb_AllocationHeader_t *position = sysmelb_LastMemoryAllocation;
-    while(position)
+    for(size_t i = 0; i < SYSMELB_MEMORY_SIZE_CLASS_COUNT; ++i)
     {
-        sysmelb_LastMemoryAllocation = sysmelb_LastMemoryAllocation->nextAllocation;
-        free(position);
-        position = sysmelb_LastMemoryAllocation;
+        sysmelb_freeChunkList(sysmelb_MemorySizeClasses[i].currentChunk);
+        sysmelb_MemorySizeClasses[i].currentChunk = NULL;
+        sysmelb_MemorySizeClasses[i].freeList = NULL;
     }
+
+    sysmelb_freeChunkList(sysmelb_DedicatedMemoryChunks);
+    sysmelb_DedicatedMemoryChunks = NULL;
+
+    sysmelb_freeScratchBlockList(sysmelb_FirstScratchBlock);
+    sysmelb_FirstScratchBlock = NULL;
+    sysmelb_CurrentScratchBlock = NULL;
+    sysmelb_ScratchScopeDepth = 0;
+
+    free(sysmelb_ChunkRegistry);
+    sysmelb_ChunkRegistry = NULL;
+    sysmelb_ChunkRegistrySize = 0;
+    sysmelb_ChunkRegistryCapacity = 0;
+    sysmelb_LiveAllocationBytes = 0;
+    sysmelb_AllocatedBytesSinceSweep = 0;
 }
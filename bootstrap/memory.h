@@ -4,9 +4,42 @@
 #pragma once
 
 #include <stddef.h>
+#include <stdbool.h>
 
-void *sysmelb_allocate(size_t allocationSize);
+// The allocation site is recorded for the allocation profiler.
+#define sysmelb_allocate(allocationSize) sysmelb_allocateAtSite((allocationSize), __FILE__, __LINE__)
+
+void *sysmelb_allocateAtSite(size_t allocationSize, const char *fileName, int line);
 void sysmelb_freeAllocation(void *allocation);
 void sysmelb_freeAll(void);
 
-#endif //SYSMELB_MEMORY_H
\ No newline at end of file
+bool sysmelb_memory_markAllocation(void *pointer, void **outStart, size_t *outSize);
+bool sysmelb_memory_isMarked(void *allocation);
+
+// An allocation is marked as shared when several values use its storage, such
+// as the slices of a string, so that it is not modified under them. The
+// pointer may point into the middle of the allocation. Marking fails for
+// memory that is not in the collected heap.
+bool sysmelb_memory_markShared(void *pointer);
+bool sysmelb_memory_isShared(void *pointer);
+
+size_t sysmelb_memory_sweep(void);
+size_t sysmelb_memory_getLiveBytes(void);
+size_t sysmelb_memory_getAllocatedBytesSinceSweep(void);
+
+// Scratch memory is carved from a stack of blocks that are outside of the
+// collected heap. Everything allocated after beginning a scope is released in
+// bulk when it ends, so it must not be referenced once the scope is over.
+typedef struct sysmelb_ScratchScope_s
+{
+    void *block;
+    size_t used;
+} sysmelb_ScratchScope_t;
+
+sysmelb_ScratchScope_t sysmelb_scratch_beginScope(void);
+void sysmelb_scratch_endScope(sysmelb_ScratchScope_t scope);
+bool sysmelb_scratch_isInScope(void);
+void *sysmelb_scratch_allocate(size_t allocationSize);
+void *sysmelb_scratch_reallocate(void *allocation, size_t oldSize, size_t newSize);
+
+#endif //SYSMELB_MEMORY_H
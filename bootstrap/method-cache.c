@@ -0,0 +1,178 @@
+#include "method-cache.h"
+#include "hash.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYSMELB_GLOBAL_METHOD_CACHE_SIZE 4096
+
+typedef struct sysmelb_GlobalMethodCacheEntry_s
+{
+    sysmelb_Type_t *receiverType;
+    sysmelb_symbol_t *selector;
+    uint32_t selectorVersion;
+    sysmelb_function_t *method;
+} sysmelb_GlobalMethodCacheEntry_t;
+
+typedef struct sysmelb_MethodCacheStats_s
+{
+    size_t sends;
+    size_t monomorphicHits;
+    size_t polymorphicHits;
+    size_t inlineMisses;
+    size_t megamorphicSends;
+    size_t invalidatedInlineCaches;
+    size_t globalLookups;
+    size_t globalHits;
+} sysmelb_MethodCacheStats_t;
+
+bool sysmelb_MethodCacheStatsEnabled;
+static sysmelb_MethodCacheStats_t sysmelb_MethodCacheStats;
+
+#define SYSMELB_METHOD_CACHE_STAT(name) do { \
+    if(sysmelb_MethodCacheStatsEnabled) \
+        ++sysmelb_MethodCacheStats.name; \
+} while(0)
+
+// Versions start at zero for every selector, and are indexed by symbol ID.
+static uint32_t *sysmelb_SelectorVersions;
+static uint32_t sysmelb_SelectorVersionCapacity;
+
+// Cached methods are not marked by the GC. A cached lookup is only used while
+// its selector version is current, and until then the method is still in the
+// method dictionary where it was found.
+static sysmelb_GlobalMethodCacheEntry_t sysmelb_GlobalMethodCache[SYSMELB_GLOBAL_METHOD_CACHE_SIZE];
+
+static uint32_t sysmelb_methodCache_selectorVersion(sysmelb_symbol_t *selector)
+{
+    if(selector->id >= sysmelb_SelectorVersionCapacity)
+        return 0;
+    return sysmelb_SelectorVersions[selector->id];
+}
+
+void sysmelb_methodCache_invalidateSelector(sysmelb_symbol_t *selector)
+{
+    if(selector->id >= sysmelb_SelectorVersionCapacity)
+    {
+        uint32_t newCapacity = sysmelb_SelectorVersionCapacity ? sysmelb_SelectorVersionCapacity * 2 : 1024;
+        while(newCapacity <= selector->id)
+            newCapacity *= 2;
+
+        uint32_t *newVersions = calloc(newCapacity, sizeof(uint32_t));
+        if(!newVersions)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+
+        if(sysmelb_SelectorVersions)
+            memcpy(newVersions, sysmelb_SelectorVersions, sysmelb_SelectorVersionCapacity * sizeof(uint32_t));
+        free(sysmelb_SelectorVersions);
+        sysmelb_SelectorVersions = newVersions;
+        sysmelb_SelectorVersionCapacity = newCapacity;
+    }
+
+    ++sysmelb_SelectorVersions[selector->id];
+}
+
+void sysmelb_methodCache_flush(void)
+{
+    memset(sysmelb_GlobalMethodCache, 0, sizeof(sysmelb_GlobalMethodCache));
+}
+
+sysmelb_function_t *sysmelb_methodCache_lookup(sysmelb_Type_t *receiverType, sysmelb_symbol_t *selector)
+{
+    uint32_t selectorVersion = sysmelb_methodCache_selectorVersion(selector);
+    uint64_t key = ((uint64_t)receiverType->typeIndex << 32) | selector->id;
+    sysmelb_GlobalMethodCacheEntry_t *entry = sysmelb_GlobalMethodCache + (sysmelb_hashMix64(key) & (SYSMELB_GLOBAL_METHOD_CACHE_SIZE - 1));
+
+    SYSMELB_METHOD_CACHE_STAT(globalLookups);
+    if(entry->receiverType == receiverType && entry->selector == selector && entry->selectorVersion == selectorVersion)
+    {
+        SYSMELB_METHOD_CACHE_STAT(globalHits);
+        return entry->method;
+    }
+
+    sysmelb_function_t *method = sysmelb_type_lookupSelector(receiverType, selector);
+    entry->receiverType = receiverType;
+    entry->selector = selector;
+    entry->selectorVersion = selectorVersion;
+    entry->method = method;
+    return method;
+}
+
+sysmelb_function_t *sysmelb_sendCache_lookup(sysmelb_SendCache_t *cache, sysmelb_Type_t *receiverType)
+{
+    SYSMELB_METHOD_CACHE_STAT(sends);
+    uint32_t selectorVersion = sysmelb_methodCache_selectorVersion(cache->selector);
+    if(cache->selectorVersion != selectorVersion)
+    {
+        if(cache->entryCount)
+            SYSMELB_METHOD_CACHE_STAT(invalidatedInlineCaches);
+        cache->selectorVersion = selectorVersion;
+        cache->entryCount = 0;
+    }
+
+    if(cache->entryCount > SYSMELB_SEND_CACHE_ENTRY_COUNT)
+    {
+        SYSMELB_METHOD_CACHE_STAT(megamorphicSends);
+        return sysmelb_methodCache_lookup(receiverType, cache->selector);
+    }
+
+    for(uint32_t i = 0; i < cache->entryCount; ++i)
+    {
+        if(cache->entries[i].receiverType == receiverType)
+        {
+            if(cache->entryCount == 1)
+                SYSMELB_METHOD_CACHE_STAT(monomorphicHits);
+            else
+                SYSMELB_METHOD_CACHE_STAT(polymorphicHits);
+            return cache->entries[i].method;
+        }
+    }
+
+    SYSMELB_METHOD_CACHE_STAT(inlineMisses);
+    sysmelb_function_t *method = sysmelb_methodCache_lookup(receiverType, cache->selector);
+    if(cache->entryCount < SYSMELB_SEND_CACHE_ENTRY_COUNT)
+    {
+        sysmelb_SendCacheEntry_t entry = {
+            .receiverType = receiverType,
+            .method = method
+        };
+        cache->entries[cache->entryCount++] = entry;
+    }
+    else
+    {
+        cache->entryCount = SYSMELB_SEND_CACHE_ENTRY_COUNT + 1;
+    }
+
+    return method;
+}
+
+void sysmelb_methodCacheStats_enable(void)
+{
+    sysmelb_MethodCacheStatsEnabled = true;
+}
+
+static double sysmelb_methodCacheStats_percentage(size_t count, size_t total)
+{
+    return total ? 100.0 * (double)count / (double)total : 0.0;
+}
+
+void sysmelb_methodCacheStats_print(void)
+{
+    sysmelb_MethodCacheStats_t *stats = &sysmelb_MethodCacheStats;
+    size_t globalMisses = stats->globalLookups - stats->globalHits;
+    fprintf(stderr, "%12s %8s  %s\n", "Count", "Percent", "Message sends");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->sends, 100.0, "total");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->monomorphicHits, sysmelb_methodCacheStats_percentage(stats->monomorphicHits, stats->sends), "monomorphic inline cache hits");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->polymorphicHits, sysmelb_methodCacheStats_percentage(stats->polymorphicHits, stats->sends), "polymorphic inline cache hits");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->inlineMisses, sysmelb_methodCacheStats_percentage(stats->inlineMisses, stats->sends), "inline cache misses");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->megamorphicSends, sysmelb_methodCacheStats_percentage(stats->megamorphicSends, stats->sends), "megamorphic sends");
+    fprintf(stderr, "%12zu %8s  %s\n", stats->invalidatedInlineCaches, "", "inline caches invalidated");
+    fprintf(stderr, "\n%12s %8s  %s\n", "Count", "Percent", "Global method cache lookups");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->globalLookups, 100.0, "total");
+    fprintf(stderr, "%12zu %8.2f  %s\n", stats->globalHits, sysmelb_methodCacheStats_percentage(stats->globalHits, stats->globalLookups), "hits");
+    fprintf(stderr, "%12zu %8.2f  %s\n", globalMisses, sysmelb_methodCacheStats_percentage(globalMisses, stats->globalLookups), "misses");
+}
@@ -0,0 +1,50 @@
+#ifndef SYSMELB_METHOD_CACHE_H
+#define SYSMELB_METHOD_CACHE_H
+
+#pragma once
+
+#include "symbol.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SYSMELB_SEND_CACHE_ENTRY_COUNT 4
+
+typedef struct sysmelb_Type_s sysmelb_Type_t;
+typedef struct sysmelb_function_s sysmelb_function_t;
+
+typedef struct sysmelb_SendCacheEntry_s
+{
+    sysmelb_Type_t *receiverType;
+    sysmelb_function_t *method;
+} sysmelb_SendCacheEntry_t;
+
+// The inline cache of a message send site. It holds the lookups of its
+// selector for up to four receiver types, and then becomes megamorphic and
+// uses the global method cache instead. The entries are only valid for the
+// version of the selector that they were filled with.
+typedef struct sysmelb_SendCache_s
+{
+    sysmelb_symbol_t *selector;
+    uint32_t selectorVersion;
+    uint32_t entryCount;
+    sysmelb_SendCacheEntry_t entries[SYSMELB_SEND_CACHE_ENTRY_COUNT];
+} sysmelb_SendCache_t;
+
+extern bool sysmelb_MethodCacheStatsEnabled;
+
+// Adding a method can only change the lookups of its selector, so it
+// invalidates the cached lookups of that selector for every type.
+void sysmelb_methodCache_invalidateSelector(sysmelb_symbol_t *selector);
+
+// The global cache does not keep its receiver types alive, so it is flushed
+// when types are collected. The send caches mark theirs instead.
+void sysmelb_methodCache_flush(void);
+
+sysmelb_function_t *sysmelb_methodCache_lookup(sysmelb_Type_t *receiverType, sysmelb_symbol_t *selector);
+sysmelb_function_t *sysmelb_sendCache_lookup(sysmelb_SendCache_t *cache, sysmelb_Type_t *receiverType);
+
+void sysmelb_methodCacheStats_enable(void);
+void sysmelb_methodCacheStats_print(void);
+
+#endif //SYSMELB_METHOD_CACHE_H
@@ -2,18 +2,27 @@
 #include "namespace.h"
 #include "environment.h"
 
+static sysmelb_Module_t *sysmelb_RegisteredModules;
+
 sysmelb_Module_t *sysmelb_createModuleNamed(sysmelb_symbol_t *name)
 {
     sysmelb_Module_t *module = sysmelb_allocate(sizeof(sysmelb_Module_t));
 
     module->name = name;
     module->moduleEnvironment = sysmelb_createModuleEnvironment(module, sysmelb_getOrCreateIntrinsicsEnvironment());
-    module->globalNamespace = sysmelb_createNamespaceNamed(sysmelb_internSymbolC("__global"));
+    module->globalNamespace = sysmelb_createNamespaceNamed(sysmelb_WellKnownSymbols.globalNamespace);
     module->globalNamespaceEnvironment = sysmelb_createNamespaceEnvironment(module->globalNamespace, module->moduleEnvironment);
+    module->nextModule = sysmelb_RegisteredModules;
+    sysmelb_RegisteredModules = module;
     return module;
 }
 
 sysmelb_Environment_t *sysmelb_module_createTopLevelEnvironment(sysmelb_Module_t *module)
 {
     return sysmelb_createLexicalEnvironment(module->globalNamespaceEnvironment);
+}
+
+sysmelb_Module_t *sysmelb_getRegisteredModules(void)
+{
+    return sysmelb_RegisteredModules;
 }
\ No newline at end of file
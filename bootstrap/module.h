@@ -15,10 +15,12 @@ typedef struct sysmelb_Module_s
 
     sysmelb_Environment_t *moduleEnvironment;
     sysmelb_Environment_t *globalNamespaceEnvironment;
-    
+
+    struct sysmelb_Module_s *nextModule;
 }sysmelb_Module_t;
 
 sysmelb_Module_t *sysmelb_createModuleNamed(sysmelb_symbol_t *name);
 sysmelb_Environment_t *sysmelb_module_createTopLevelEnvironment(sysmelb_Module_t *module);
+sysmelb_Module_t *sysmelb_getRegisteredModules(void);
 
 #endif //SYSMELB_MODULE_H
\ No newline at end of file
@@ -14,28 +14,25 @@ sysmelb_Namespace_t *sysmelb_createNamespaceNamed(sysmelb_symbol_t *name)
 
 sysmelb_Namespace_t *sysmelb_getOrCreateChildNamespace(sysmelb_Namespace_t *parentNamespace, sysmelb_symbol_t *childName)
 {
-    const sysmelb_SymbolHashtablePair_t *existing = sysmelb_SymbolHashtable_lookupSymbol(&parentNamespace->exportedObjects, childName);
-    if(existing)
+    void *existing;
+    if(sysmelb_SymbolHashtable_lookupSymbol(&parentNamespace->exportedObjects, childName, &existing))
     {
-        sysmelb_SymbolBinding_t *existingBinding = existing->value;
+        sysmelb_SymbolBinding_t *existingBinding = existing;
         assert(existingBinding->kind == SysmelSymbolValueBinding);
 
-        if(existingBinding->value.kind != SysmelValueKindNamespaceReference)
+        if(sysmelb_value_getKind(existingBinding->value) != SysmelValueKindNamespaceReference)
         {
             sysmelb_SourcePosition_t nullPosition = {0};
             sysmelb_errorPrintf(nullPosition, "Expected a child namespace.");
         }
-        return existingBinding->value.namespaceReference;
+        return sysmelb_value_getReference(existingBinding->value, namespace);
     }
     
     sysmelb_Namespace_t *childNamespace = sysmelb_allocate(sizeof(sysmelb_Namespace_t));
     childNamespace->name = childName;
 
-    sysmelb_Value_t childValue = {
-        .kind = SysmelValueKindNamespaceReference,
-        .type = sysmelb_getBasicTypes()->namespace,
-        .namespaceReference = childNamespace
-    };
+    sysmelb_Value_t childValue = sysmelb_value_makeReference(
+        SysmelValueKindNamespaceReference, sysmelb_getBasicTypes()->namespace, childNamespace);
 
     sysmelb_SymbolBinding_t *childBinding = sysmelb_createSymbolValueBinding(childValue);
 
@@ -51,8 +48,8 @@ void sysmelb_namespace_exportValueWithName(sysmelb_Namespace_t *namespace, sysme
 
 sysmelb_SymbolBinding_t *sysmelb_namespace_lookupExportedObject(sysmelb_Namespace_t *namespace, sysmelb_symbol_t *name)
 {
-    const sysmelb_SymbolHashtablePair_t *existing = sysmelb_SymbolHashtable_lookupSymbol(&namespace->exportedObjects, name);
-    if(!existing)
+    void *existing;
+    if(!sysmelb_SymbolHashtable_lookupSymbol(&namespace->exportedObjects, name, &existing))
         return NULL;
-    return (sysmelb_SymbolBinding_t *)existing->value;
+    return (sysmelb_SymbolBinding_t *)existing;
 }
\ No newline at end of file
@@ -557,10 +557,7 @@ void tokenDynarray_increaseCapacity(sysmelb_TokenDynarray_t *dynarray)
     if(newCapacity < 32)
         newCapacity = 32;
 
-    void *newStorage = sysmelb_allocate(newCapacity * sizeof(sysmelb_ScannerToken_t));
-    memcpy(newStorage, dynarray->tokens, dynarray->size * sizeof(sysmelb_ScannerToken_t));
-
-    sysmelb_freeAllocation(dynarray->tokens);
+    void *newStorage = sysmelb_scratch_reallocate(dynarray->tokens, dynarray->capacity * sizeof(sysmelb_ScannerToken_t), newCapacity * sizeof(sysmelb_ScannerToken_t));
     dynarray->capacity = newCapacity;
     dynarray->tokens = newStorage;
 
@@ -22,5 +22,6 @@ typedef struct sysmelb_TokenDynarray_s
     sysmelb_ScannerToken_t *tokens;
 }sysmelb_TokenDynarray_t;
 
+// The scanned tokens are allocated in the current scratch scope.
 sysmelb_TokenDynarray_t sysmelb_scanSourceCode(sysmelb_SourceCode_t *sourceCode);
 #endif //SYSMELB_SCANNER_H
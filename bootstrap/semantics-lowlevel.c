@@ -15,14 +15,14 @@ static void sysmelb_analyzeDependentArguments(sysmelb_Environment_t *environment
         assert(argument->kind == ParseTreeBindableName);
 
         sysmelb_Value_t argumentNameValue = sysmelb_analyzeAndEvaluateScript(environment, argument->bindableName.nameExpression);
-        sysmelb_symbol_t *argumentNameSymbol = argumentNameValue.symbolReference;
+        sysmelb_symbol_t *argumentNameSymbol = sysmelb_value_getReference(argumentNameValue, symbol);
         sysmelb_Type_t *argumentType = sysmelb_getBasicTypes()->gradual;
         if(argument->bindableName.typeExpression)
         {
             sysmelb_Value_t argumentTypeValue = sysmelb_analyzeAndEvaluateScript(environment, argument->bindableName.typeExpression);
-            if(argumentTypeValue.kind != SysmelValueKindTypeReference)
+            if(sysmelb_value_getKind(argumentTypeValue) != SysmelValueKindTypeReference)
                 sysmelb_errorPrintf(argument->bindableName.typeExpression->sourcePosition, "Expected a type expression.");
-            argumentType = argumentTypeValue.typeReference;
+            argumentType = sysmelb_value_getReference(argumentTypeValue, type);
         }
 
         sysmelb_SymbolBinding_t *argumentBinding = sysmelb_createSymbolArgumentBinding((uint16_t)i, argumentType);
@@ -40,11 +40,8 @@ sysmelb_Value_t sysmelb_analyzeAndCompileClosure(sysmelb_Environment_t *environm
     function->kind = SysmelFunctionKindInterpreted;
     sysmelb_FunctionBytecode_t *bytecode = &function->bytecode;
     
-    sysmelb_Value_t functionValue = {
-        .kind = SysmelValueKindFunctionReference,
-        .type = sysmelb_getBasicTypes()->function,
-        .functionReference = function,
-    };
+    sysmelb_Value_t functionValue = sysmelb_value_makeReference(
+        SysmelValueKindFunctionReference, sysmelb_getBasicTypes()->function, function);
 
     if(ast->function.name)
         sysmelb_Environment_setLocalSymbolBinding(environment, ast->function.name, sysmelb_createSymbolValueBinding(functionValue));
@@ -57,6 +54,20 @@ sysmelb_Value_t sysmelb_analyzeAndCompileClosure(sysmelb_Environment_t *environm
     return functionValue;
 }
 
+static bool sysmelb_analyzeAndCompileAggregateElements(sysmelb_Environment_t *environment, sysmelb_function_t *function, sysmelb_ParseTreeNodeDynArray_t *elements)
+{
+    bool allLiterals = true;
+    for(size_t i = 0; i < elements->size; ++i)
+    {
+        uint32_t firstInstructionIndex = function->bytecode.instructionSize;
+        sysmelb_analyzeAndCompileClosureBody(environment, function, elements->elements[i]);
+        if(!sysmelb_bytecode_isSingleLiteralPushFrom(&function->bytecode, firstInstructionIndex))
+            allLiterals = false;
+    }
+
+    return allLiterals;
+}
+
 static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environment, sysmelb_function_t *function, sysmelb_ParseTreeNode_t *ast)
 {
     switch(ast->kind)
@@ -69,48 +80,28 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
         return sysmelb_bytecode_assert(&function->bytecode, ast->sourcePosition);
     case ParseTreeLiteralIntegerNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindInteger,
-                .type = sysmelb_getBasicTypes()->integer,
-                .integer = ast->literalInteger.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeInteger(sysmelb_getBasicTypes()->integer, ast->literalInteger.value);
             return sysmelb_bytecode_pushLiteral(&function->bytecode, &value);
         }
     case ParseTreeLiteralCharacterNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindCharacter,
-                .type = sysmelb_getBasicTypes()->character,
-                .unsignedInteger = ast->literalCharacter.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeCharacter(sysmelb_getBasicTypes()->character, ast->literalCharacter.value);
             return sysmelb_bytecode_pushLiteral(&function->bytecode, &value);
         }
     case ParseTreeLiteralFloatNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindFloatingPoint,
-                .type = sysmelb_getBasicTypes()->floatingPoint,
-                .floatingPoint = ast->literalFloat.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeFloatingPoint(sysmelb_getBasicTypes()->floatingPoint, ast->literalFloat.value);
             return sysmelb_bytecode_pushLiteral(&function->bytecode, &value);
         }
     case ParseTreeLiteralStringNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindStringReference,
-                .type = sysmelb_getBasicTypes()->string,
-                .string = ast->literalString.string,
-                .stringSize = ast->literalString.stringSize,
-            };
+            sysmelb_Value_t value = sysmelb_value_makeString(ast->literalString.stringSize, ast->literalString.string);
             return sysmelb_bytecode_pushLiteral(&function->bytecode, &value);
         }
     case ParseTreeLiteralSymbolNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindSymbolReference,
-                .type = sysmelb_getBasicTypes()->symbol,
-                .symbolReference = ast->literalSymbol.internedSymbol
-            };
+            sysmelb_Value_t value = sysmelb_value_makeReference(
+                SysmelValueKindSymbolReference, sysmelb_getBasicTypes()->symbol, ast->literalSymbol.internedSymbol);
             return sysmelb_bytecode_pushLiteral(&function->bytecode, &value);
         }
     case ParseTreeLiteralValueNode:
@@ -148,9 +139,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                     abort();
                 }
 
-                if(functionalBinding->kind == SysmelSymbolValueBinding && functionalBinding->value.kind == SysmelValueKindFunctionReference)
+                if(functionalBinding->kind == SysmelSymbolValueBinding && sysmelb_value_getKind(functionalBinding->value) == SysmelValueKindFunctionReference)
                 {
-                    sysmelb_function_t *calledFunctionOrMacro = functionalBinding->value.functionReference;
+                    sysmelb_function_t *calledFunctionOrMacro = sysmelb_value_getReference(functionalBinding->value, function);
                     switch(calledFunctionOrMacro->kind)
                     {
                     case SysmelFunctionKindPrimitiveMacro:
@@ -161,10 +152,8 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
 
                         for(size_t i = 0; i < argumentCount; ++i)
                         {
-                            sysmelb_Value_t argumentValue = {
-                                .kind = SysmelValueKindParseTreeReference,
-                                .parseTreeReference = ast->functionApplication.arguments.elements[i],
-                            };
+                            sysmelb_Value_t argumentValue = sysmelb_value_makeReference(
+                                SysmelValueKindParseTreeReference, NULL, ast->functionApplication.arguments.elements[i]);
 
                             applicationArguments[i] = argumentValue;
                         }
@@ -175,9 +164,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                         };
 
                         sysmelb_Value_t macroResult = calledFunctionOrMacro->primitiveMacroFunction(&macroContext, argumentCount, applicationArguments);
-                        if(macroResult.kind == SysmelValueKindParseTreeReference)
+                        if(sysmelb_value_getKind(macroResult) == SysmelValueKindParseTreeReference)
                         {
-                            return sysmelb_analyzeAndCompileClosureBody(environment, function, macroResult.parseTreeReference);
+                            return sysmelb_analyzeAndCompileClosureBody(environment, function, sysmelb_value_getReference(macroResult, parseTree));
                         }
                         else
                         {
@@ -201,16 +190,12 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
     case ParseTreeMessageSend:
         {
             sysmelb_Value_t selectorValue = sysmelb_analyzeAndEvaluateScript(environment, ast->messageSend.selector);
-            assert(selectorValue.kind == SysmelValueKindSymbolReference);
+            assert(sysmelb_value_getKind(selectorValue) == SysmelValueKindSymbolReference);
             if(ast->messageSend.arguments.size == 1)
             {
-                if(selectorValue.symbolReference == sysmelb_internSymbolC("&&"))
+                if(sysmelb_value_getReference(selectorValue, symbol) == sysmelb_WellKnownSymbols.logicalAnd)
                 {
-                    sysmelb_Value_t falseValue = {
-                        .kind = SysmelValueKindBoolean,
-                        .type = sysmelb_getBasicTypes()->boolean,
-                        .boolean = false,
-                    };
+                    sysmelb_Value_t falseValue = sysmelb_value_makeBoolean(false);
 
                     sysmelb_ParseTreeNode_t *falseLiteralResult = sysmelb_newParseTreeNode(ParseTreeLiteralValueNode, ast->sourcePosition);
                     falseLiteralResult->literalValue.value = falseValue;
@@ -222,13 +207,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                     return sysmelb_analyzeAndCompileClosureBody(environment, function, ifNode);
 
                 }
-                else if(selectorValue.symbolReference == sysmelb_internSymbolC("||"))
+                else if(sysmelb_value_getReference(selectorValue, symbol) == sysmelb_WellKnownSymbols.logicalOr)
                 {
-                    sysmelb_Value_t trueValue = {
-                        .kind = SysmelValueKindBoolean,
-                        .type = sysmelb_getBasicTypes()->boolean,
-                        .boolean = true,
-                    };
+                    sysmelb_Value_t trueValue = sysmelb_value_makeBoolean(true);
 
                     sysmelb_ParseTreeNode_t *trueLiteralResult = sysmelb_newParseTreeNode(ParseTreeLiteralValueNode, ast->sourcePosition);
                     trueLiteralResult->literalValue.value = trueValue;
@@ -248,7 +229,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                 sysmelb_analyzeAndCompileClosureBody(environment, function, ast->messageSend.arguments.elements[i]);
 
             sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
-            sysmelb_bytecode_sendMessage(&function->bytecode, selectorValue.symbolReference, (uint16_t)argumentCount);
+            sysmelb_bytecode_sendMessage(&function->bytecode, sysmelb_value_getReference(selectorValue, symbol), (uint16_t)argumentCount);
             return;
             
         }
@@ -275,9 +256,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             size_t elementCount = ast->sequence.elements.size;
             if(elementCount == 0)
             {
-                sysmelb_Value_t null = {
-                    .type = sysmelb_getBasicTypes()->null
-                };
+                sysmelb_Value_t null = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
                 sysmelb_bytecode_pushLiteral(&function->bytecode, &null);
             }
             for(size_t i = 0; i < elementCount; ++i)
@@ -289,29 +268,41 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             return;
         }
     case ParseTreeArray:
-        for(size_t i = 0; i < ast->array.elements.size; ++i)
-            sysmelb_analyzeAndCompileClosureBody(environment, function, ast->array.elements.elements[i]);
+        if(sysmelb_analyzeAndCompileAggregateElements(environment, function, &ast->array.elements))
+            return sysmelb_bytecode_makeLiteralArray(&function->bytecode, ast->array.elements.size);
+        sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
         return sysmelb_bytecode_makeArray(&function->bytecode, ast->array.elements.size);
     case ParseTreeByteArray:
-        for(size_t i = 0; i < ast->byteArray.elements.size; ++i)
-            sysmelb_analyzeAndCompileClosureBody(environment, function, ast->array.elements.elements[i]);
-        return sysmelb_bytecode_makeByteArray(&function->bytecode, ast->array.elements.size);
+        if(sysmelb_analyzeAndCompileAggregateElements(environment, function, &ast->byteArray.elements))
+            return sysmelb_bytecode_makeLiteralByteArray(&function->bytecode, ast->byteArray.elements.size);
+        sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
+        return sysmelb_bytecode_makeByteArray(&function->bytecode, ast->byteArray.elements.size);
     case ParseTreeTuple:
-        for(size_t i = 0; i < ast->tuple.elements.size; ++i)
-            sysmelb_analyzeAndCompileClosureBody(environment, function, ast->tuple.elements.elements[i]);
+        if(sysmelb_analyzeAndCompileAggregateElements(environment, function, &ast->tuple.elements))
+            return sysmelb_bytecode_makeLiteralTuple(&function->bytecode, ast->tuple.elements.size);
+        sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
         return sysmelb_bytecode_makeTuple(&function->bytecode, ast->tuple.elements.size);
         
     // Association, dictionary
     case ParseTreeAssociation:
     {
+        uint32_t keyInstructionIndex = function->bytecode.instructionSize;
         sysmelb_analyzeAndCompileClosureBody(environment, function, ast->association.key);
+        bool isLiteralKey = sysmelb_bytecode_isSingleLiteralPushFrom(&function->bytecode, keyInstructionIndex);
+
+        uint32_t valueInstructionIndex = function->bytecode.instructionSize;
         sysmelb_analyzeAndCompileClosureBody(environment, function, ast->association.value);
+        if(isLiteralKey && sysmelb_bytecode_isSingleLiteralPushFrom(&function->bytecode, valueInstructionIndex))
+            return sysmelb_bytecode_makeLiteralAssociation(&function->bytecode);
+
+        sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
         return sysmelb_bytecode_makeAssociation(&function->bytecode);
     }
     case ParseTreeImmutableDictionary:
     {
-        for(size_t i = 0; i < ast->dictionary.elements.size; ++i)
-            sysmelb_analyzeAndCompileClosureBody(environment, function, ast->dictionary.elements.elements[i]);
+        if(sysmelb_analyzeAndCompileAggregateElements(environment, function, &ast->dictionary.elements))
+            return sysmelb_bytecode_makeLiteralImmutableDictionary(&function->bytecode, ast->dictionary.elements.size);
+        sysmelb_bytecode_sourcePosition(&function->bytecode, ast->sourcePosition);
         return sysmelb_bytecode_makeImmutableDictionary(&function->bytecode, ast->dictionary.elements.size);
     }
 
@@ -335,7 +326,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             if(!isAnonymous)
             {
                 nameValue = sysmelb_analyzeAndEvaluateScript(environment, store->bindableName.nameExpression);
-                if(nameValue.kind != SysmelValueKindSymbolReference)
+                if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
                     sysmelb_errorPrintf(store->bindableName.nameExpression->sourcePosition, "Expected a name");
             }
 
@@ -355,7 +346,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             sysmelb_analyzeAndCompileClosureBody(environment, function, value);
             uint16_t temporaryIndex = sysmelb_bytecode_allocateTemporary(&function->bytecode);
             sysmelb_bytecode_storeTemporary(&function->bytecode, temporaryIndex);
-            sysmelb_Environment_setLocalSymbolBinding(environment, nameValue.symbolReference, sysmelb_createSymbolTemporaryBinding(temporaryIndex, sysmelb_getBasicTypes()->gradual));
+            sysmelb_Environment_setLocalSymbolBinding(environment, sysmelb_value_getReference(nameValue, symbol), sysmelb_createSymbolTemporaryBinding(temporaryIndex, sysmelb_getBasicTypes()->gradual));
             return;
         }
         if(store->kind == ParseTreeIdentifierReference)
@@ -380,18 +371,15 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
     // Control flow
     case ParseTreeIfSelection:
     {
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
         sysmelb_analyzeAndCompileClosureBody(environment, function, ast->ifSelection.condition);
-        uint16_t ifFalseJump = sysmelb_bytecode_jumpIfFalse(&function->bytecode);
+        uint32_t ifFalseJump = sysmelb_bytecode_jumpIfFalse(&function->bytecode);
 
         if(ast->ifSelection.trueExpression)
             sysmelb_analyzeAndCompileClosureBody(environment, function, ast->ifSelection.trueExpression);
         else
             sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
-        uint16_t mergeJump = sysmelb_bytecode_jump(&function->bytecode);
+        uint32_t mergeJump = sysmelb_bytecode_jump(&function->bytecode);
 
         sysmelb_bytecode_patchJumpToHere(&function->bytecode, ifFalseJump);
         if(ast->ifSelection.falseExpression)
@@ -405,9 +393,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
     case ParseTreeSwitch:
     {
         bool isCaseWithJump[256];
-        uint16_t casesJumps[256];
-        uint16_t casesMergeJumps[256];
-        uint16_t defaultCaseMergeJump;
+        uint32_t casesJumps[256];
+        uint32_t casesMergeJumps[256];
+        uint32_t defaultCaseMergeJump;
         memset(isCaseWithJump, 0, sizeof(isCaseWithJump));
 
         assert(ast->switchExpression.cases->kind == ParseTreeImmutableDictionary);
@@ -429,13 +417,13 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             sysmelb_ParseTreeAssociation_t *caseAssoc = &dictionary->elements.elements[i]->association;
             sysmelb_Value_t caseKeyValue = sysmelb_analyzeAndEvaluateScript(environment, caseAssoc->key);
             
-            if(caseKeyValue.kind == SysmelValueKindSymbolReference)
+            if(sysmelb_value_getKind(caseKeyValue) == SysmelValueKindSymbolReference)
             {
-                assert(caseKeyValue.symbolReference->size == 1 && caseKeyValue.symbolReference->string[0] == '_');
+                assert(sysmelb_value_getReference(caseKeyValue, symbol)->size == 1 && sysmelb_value_getReference(caseKeyValue, symbol)->string[0] == '_');
                 defaultCase = caseAssoc->value;
 
             }
-            else if(caseKeyValue.kind == SysmelValueKindInteger || caseKeyValue.kind == SysmelValueKindUnsignedInteger)
+            else if(sysmelb_value_getKind(caseKeyValue) == SysmelValueKindInteger || sysmelb_value_getKind(caseKeyValue) == SysmelValueKindUnsignedInteger)
             {
                 sysmelb_bytecode_pushLiteral(&function->bytecode, &caseKeyValue);
                 sysmelb_bytecode_pushTemporary(&function->bytecode, valueTemporary);
@@ -454,10 +442,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
         else
         {
             // Emit void to balance the results.
-            sysmelb_Value_t voidValue = {
-                .kind = SysmelValueKindVoid,
-                .type = sysmelb_getBasicTypes()->voidType
-            };
+            sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
             sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
             defaultCaseMergeJump = sysmelb_bytecode_jump(&function->bytecode);
         }
@@ -490,9 +475,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
     case ParseTreeSwitchPatternMatching:
     {
         bool isCaseWithJump[256];
-        uint16_t casesJumps[256];
-        uint16_t casesMergeJumps[256];
-        uint16_t defaultCaseMergeJump;
+        uint32_t casesJumps[256];
+        uint32_t casesMergeJumps[256];
+        uint32_t defaultCaseMergeJump;
         memset(isCaseWithJump, 0, sizeof(isCaseWithJump));
 
         assert(ast->switchPatternMatching.cases->kind == ParseTreeImmutableDictionary);
@@ -504,8 +489,8 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
 
         // Evaluate the sum type.
         sysmelb_Value_t sumTypeValue = sysmelb_analyzeAndEvaluateScript(environment, ast->switchPatternMatching.valueSumType);
-        assert(sumTypeValue.kind == SysmelValueKindTypeReference && sumTypeValue.typeReference->kind == SysmelTypeKindSum);
-        sysmelb_Type_t *sumType = sumTypeValue.typeReference;
+        assert(sysmelb_value_getKind(sumTypeValue) == SysmelValueKindTypeReference && sysmelb_value_getReference(sumTypeValue, type)->kind == SysmelTypeKindSum);
+        sysmelb_Type_t *sumType = sysmelb_value_getReference(sumTypeValue, type);
 
         // Compile the value expression, and store it in a temporary.
         uint16_t valueTemporary = sysmelb_bytecode_allocateTemporary(&function->bytecode);
@@ -528,7 +513,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                 sysmelb_ParseTreeNode_t *bindableName = caseAssoc->key;
                 assert(bindableName->bindableName.typeExpression);
                 sysmelb_Value_t bindableTypeValue = sysmelb_analyzeAndEvaluateScript(environment, bindableName->bindableName.typeExpression);
-                sysmelb_Type_t *bindableType = bindableTypeValue.typeReference;
+                sysmelb_Type_t *bindableType = sysmelb_value_getReference(bindableTypeValue, type);
                 int alternativeIndex = sysmelb_findSumTypeIndexForType(sumType, bindableType);
                 if(alternativeIndex < 0)
                 {
@@ -536,11 +521,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
                     abort();
                 }
 
-                sysmelb_Value_t alternativeIndexValue = {
-                    .kind = SysmelValueKindInteger,
-                    .type = sysmelb_getBasicTypes()->integer,
-                    .integer = alternativeIndex,
-                };
+                sysmelb_Value_t alternativeIndexValue = sysmelb_value_makeInteger(sysmelb_getBasicTypes()->integer, alternativeIndex);
 
                 sysmelb_bytecode_pushLiteral(&function->bytecode, &alternativeIndexValue);
                 sysmelb_bytecode_pushTemporary(&function->bytecode, indexTemporary);
@@ -568,10 +549,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
         else
         {
             // Emit void to balance the results.
-            sysmelb_Value_t voidValue = {
-                .kind = SysmelValueKindVoid,
-                .type = sysmelb_getBasicTypes()->voidType
-            };
+            sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
             sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
             defaultCaseMergeJump = sysmelb_bytecode_jump(&function->bytecode);
         }
@@ -591,16 +569,16 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             {
                 sysmelb_Value_t bindableNameValue = sysmelb_analyzeAndEvaluateScript(lexicalEnvironment, caseAssoc->key->bindableName.nameExpression);
                 sysmelb_Value_t bindableNameType = sysmelb_analyzeAndEvaluateScript(lexicalEnvironment, caseAssoc->key->bindableName.typeExpression);
-                if(bindableNameValue.kind == SysmelValueKindSymbolReference)
+                if(sysmelb_value_getKind(bindableNameValue) == SysmelValueKindSymbolReference)
                 {
-                    sysmelb_symbol_t *bindableSymbol = bindableNameValue.symbolReference;
+                    sysmelb_symbol_t *bindableSymbol = sysmelb_value_getReference(bindableNameValue, symbol);
                     sysmelb_bytecode_pushTemporary(&function->bytecode, valueTemporary);
                     sysmelb_bytecode_getSumInjectedValue(&function->bytecode);
                     
                     uint16_t caseTemporary = sysmelb_bytecode_allocateTemporary(&function->bytecode);
                     sysmelb_bytecode_popAndStoreTemporary(&function->bytecode, caseTemporary);
 
-                    sysmelb_SymbolBinding_t *caseBinding = sysmelb_createSymbolTemporaryBinding(caseTemporary, bindableNameType.typeReference);
+                    sysmelb_SymbolBinding_t *caseBinding = sysmelb_createSymbolTemporaryBinding(caseTemporary, sysmelb_value_getReference(bindableNameType, type));
                     sysmelb_Environment_setLocalSymbolBinding(lexicalEnvironment, bindableSymbol, caseBinding);
                 }
             }
@@ -611,10 +589,7 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             }
             else
             {
-                sysmelb_Value_t voidValue = {
-                    .kind = SysmelValueKindVoid,
-                    .type = sysmelb_getBasicTypes()->voidType
-                };
+                sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
                 sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
             }
 
@@ -633,9 +608,9 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
     case ParseTreeWhileLoop:
     {
         // Header
-        uint16_t loopHeader = sysmelb_bytecode_label(&function->bytecode);
+        uint32_t loopHeader = sysmelb_bytecode_label(&function->bytecode);
         sysmelb_analyzeAndCompileClosureBody(environment, function, ast->whileLoop.condition);
-        uint16_t conditionFalseJump = sysmelb_bytecode_jumpIfFalse(&function->bytecode);
+        uint32_t conditionFalseJump = sysmelb_bytecode_jumpIfFalse(&function->bytecode);
     
         // Body
         if(ast->whileLoop.body)
@@ -651,21 +626,18 @@ static void sysmelb_analyzeAndCompileClosureBody(sysmelb_Environment_t *environm
             sysmelb_bytecode_pop(&function->bytecode);
         }
         
-        uint16_t backJump = sysmelb_bytecode_jump(&function->bytecode);
+        uint32_t backJump = sysmelb_bytecode_jump(&function->bytecode);
         sysmelb_bytecode_patchJumpToLabel(&function->bytecode, backJump, loopHeader);
         sysmelb_bytecode_patchJumpToHere(&function->bytecode, conditionFalseJump);
         
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
         return sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
     }
 
 case ParseTreeDoWhileLoop:
     {
         // Header
-        uint16_t loopHeader = sysmelb_bytecode_label(&function->bytecode);
+        uint32_t loopHeader = sysmelb_bytecode_label(&function->bytecode);
     
         // Body
         if(ast->doWhileLoop.body)
@@ -682,13 +654,10 @@ case ParseTreeDoWhileLoop:
         }
 
         sysmelb_analyzeAndCompileClosureBody(environment, function, ast->doWhileLoop.condition);
-        uint16_t conditionBackJump = sysmelb_bytecode_jumpIfTrue(&function->bytecode);
+        uint32_t conditionBackJump = sysmelb_bytecode_jumpIfTrue(&function->bytecode);
         sysmelb_bytecode_patchJumpToLabel(&function->bytecode, conditionBackJump, loopHeader);
         
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
         return sysmelb_bytecode_pushLiteral(&function->bytecode, &voidValue);
     }
 case ParseTreeReturnValue:
@@ -16,67 +16,44 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
     case ParseTreeAssertNode:
         {
             sysmelb_Value_t expressionValue = sysmelb_analyzeAndEvaluateScript(environment, ast->assertNode.condition);
-            if(expressionValue.kind != SysmelValueKindBoolean)
+            if(sysmelb_value_getKind(expressionValue) != SysmelValueKindBoolean)
             {
                 sysmelb_errorPrintf(ast->sourcePosition, "Assertion does not have a boolean expression.");
                 abort();
             }
-            else if(!expressionValue.boolean)
+            else if(!sysmelb_value_getBoolean(expressionValue))
             {
                 sysmelb_errorPrintf(ast->sourcePosition, "Assertion failure.");
                 abort();
             }
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindNull,
-                .type = sysmelb_getBasicTypes()->null
-            };
+            sysmelb_Value_t value = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
             return value;
         }
     // Literals
     case ParseTreeLiteralIntegerNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindInteger,
-                .type = sysmelb_getBasicTypes()->integer,
-                .integer = ast->literalInteger.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeInteger(sysmelb_getBasicTypes()->integer, ast->literalInteger.value);
             return value;
         }
     case ParseTreeLiteralCharacterNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindCharacter,
-                .type = sysmelb_getBasicTypes()->character,
-                .unsignedInteger = ast->literalCharacter.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeCharacter(sysmelb_getBasicTypes()->character, ast->literalCharacter.value);
             return value;
         }
     case ParseTreeLiteralFloatNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindFloatingPoint,
-                .type = sysmelb_getBasicTypes()->floatingPoint,
-                .floatingPoint = ast->literalFloat.value
-            };
+            sysmelb_Value_t value = sysmelb_value_makeFloatingPoint(sysmelb_getBasicTypes()->floatingPoint, ast->literalFloat.value);
             return value;
         }
     case ParseTreeLiteralStringNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindStringReference,
-                .type = sysmelb_getBasicTypes()->string,
-                .string = ast->literalString.string,
-                .stringSize = ast->literalString.stringSize,
-            };
+            sysmelb_Value_t value = sysmelb_value_makeString(ast->literalString.stringSize, ast->literalString.string);
             return value;
         }
     case ParseTreeLiteralSymbolNode:
         {
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindSymbolReference,
-                .type = sysmelb_getBasicTypes()->symbol,
-                .symbolReference = ast->literalSymbol.internedSymbol
-            };
+            sysmelb_Value_t value = sysmelb_value_makeReference(
+                SysmelValueKindSymbolReference, sysmelb_getBasicTypes()->symbol, ast->literalSymbol.internedSymbol);
             return value;
         }
     case ParseTreeLiteralValueNode:
@@ -104,9 +81,9 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
     case ParseTreeFunctionApplication:
     {
         sysmelb_Value_t functionalValue = sysmelb_analyzeAndEvaluateScript(environment, ast->functionApplication.functional);
-        if(functionalValue.kind == SysmelValueKindFunctionReference)
+        if(sysmelb_value_getKind(functionalValue) == SysmelValueKindFunctionReference)
         {
-            sysmelb_function_t *function = functionalValue.functionReference;
+            sysmelb_function_t *function = sysmelb_value_getReference(functionalValue, function);
             switch(function->kind)
             {
             case SysmelFunctionKindPrimitive:
@@ -128,10 +105,8 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
 
                 for(size_t i = 0; i < argumentCount; ++i)
                 {
-                    sysmelb_Value_t argumentValue = {
-                        .kind = SysmelValueKindParseTreeReference,
-                        .parseTreeReference = ast->functionApplication.arguments.elements[i],
-                    };
+                    sysmelb_Value_t argumentValue = sysmelb_value_makeReference(
+                        SysmelValueKindParseTreeReference, NULL, ast->functionApplication.arguments.elements[i]);
 
                     applicationArguments[i] = argumentValue;
                 }
@@ -142,8 +117,8 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 };
 
                 sysmelb_Value_t macroResult = function->primitiveMacroFunction(&macroContext, argumentCount, applicationArguments);
-                if(macroResult.kind == SysmelValueKindParseTreeReference)
-                    return sysmelb_analyzeAndEvaluateScript(environment, macroResult.parseTreeReference);
+                if(sysmelb_value_getKind(macroResult) == SysmelValueKindParseTreeReference)
+                    return sysmelb_analyzeAndEvaluateScript(environment, sysmelb_value_getReference(macroResult, parseTree));
                 else
                     return macroResult;
             }
@@ -162,7 +137,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 abort();
             }
         }
-        else if(functionalValue.kind == SysmelValueKindTypeReference)
+        else if(sysmelb_value_getKind(functionalValue) == SysmelValueKindTypeReference)
         {
             size_t argumentCount = ast->functionApplication.arguments.size;
             assert(ast->functionApplication.arguments.size <= SYSMEL_MAX_ARGUMENT_COUNT);
@@ -171,7 +146,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             for(size_t i = 0; i < argumentCount; ++i)
                 applicationArguments[i] = sysmelb_analyzeAndEvaluateScript(environment, ast->functionApplication.arguments.elements[i]);
 
-            sysmelb_Value_t instance = sysmelb_instantiateTypeWithArguments(functionalValue.typeReference, argumentCount, applicationArguments);
+            sysmelb_Value_t instance = sysmelb_instantiateTypeWithArguments(sysmelb_value_getReference(functionalValue, type), argumentCount, applicationArguments);
             return instance;
         }
         else
@@ -185,98 +160,94 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
     {
         sysmelb_Value_t receiver = sysmelb_analyzeAndEvaluateScript(environment, ast->messageSend.receiver);
         sysmelb_Value_t selector = sysmelb_analyzeAndEvaluateScript(environment, ast->messageSend.selector);
-        if(selector.kind != SysmelValueKindSymbolReference)
+        if(sysmelb_value_getKind(selector) != SysmelValueKindSymbolReference)
         {
             sysmelb_errorPrintf(ast->sourcePosition, "Expected a symbol for a message send selector.");
             abort();
         }
 
-        assert(receiver.type);
-        sysmelb_function_t *method = sysmelb_type_lookupSelector(receiver.type, selector.symbolReference);
+        assert(sysmelb_value_getType(receiver));
+        sysmelb_function_t *method = sysmelb_type_lookupSelector(sysmelb_value_getType(receiver), sysmelb_value_getReference(selector, symbol));
         if(!method)
         {
-            if(receiver.kind == SysmelValueKindValueBoxReference)
+            if(sysmelb_value_getKind(receiver) == SysmelValueKindValueBoxReference)
             {
-                receiver = receiver.valueBoxReference->currentValue;
-                method = sysmelb_type_lookupSelector(receiver.type, selector.symbolReference);
+                receiver = sysmelb_value_getReference(receiver, valueBox)->currentValue;
+                method = sysmelb_type_lookupSelector(sysmelb_value_getType(receiver), sysmelb_value_getReference(selector, symbol));
             }
 
-            if(receiver.kind == SysmelValueKindTupleReference && receiver.type->kind == SysmelTypeKindRecord)
+            if(sysmelb_value_getKind(receiver) == SysmelValueKindTupleReference && sysmelb_value_getType(receiver)->kind == SysmelTypeKindRecord)
             {
                 if (ast->messageSend.arguments.size == 0)
                 {
-                    int recordFieldIndex = sysmelb_findIndexOfFieldNamed(receiver.type, selector.symbolReference);
+                    int recordFieldIndex = sysmelb_findIndexOfFieldNamed(sysmelb_value_getType(receiver), sysmelb_value_getReference(selector, symbol));
                     if(recordFieldIndex >= 0)
                     {
-                        sysmelb_Value_t fieldValue = receiver.tupleReference->elements[recordFieldIndex];
+                        sysmelb_Value_t fieldValue = sysmelb_value_getReference(receiver, tuple)->elements[recordFieldIndex];
                         return fieldValue;
                     }
                 }
                 else if(ast->messageSend.arguments.size == 1)
                 {
                     // Remove the trailing:
-                    sysmelb_symbol_t *fieldName = selector.symbolReference;
-                    if(fieldName->size > 0 && fieldName->string[fieldName->size -1] == ':')
-                        fieldName = sysmelb_internSymbol(fieldName->size - 1, fieldName->string);
+                    sysmelb_symbol_t *fieldName = sysmelb_symbolWithoutTrailingColon(sysmelb_value_getReference(selector, symbol));
 
-                    int recordFieldIndex = sysmelb_findIndexOfFieldNamed(receiver.type, fieldName);
+                    int recordFieldIndex = sysmelb_findIndexOfFieldNamed(sysmelb_value_getType(receiver), fieldName);
                     if(recordFieldIndex >= 0)
                     {
                         sysmelb_Value_t newFieldValue = sysmelb_analyzeAndEvaluateScript(environment, ast->messageSend.arguments.elements[0]);
-                        receiver.tupleReference->elements[recordFieldIndex] = newFieldValue;
+                        sysmelb_value_getReference(receiver, tuple)->elements[recordFieldIndex] = newFieldValue;
                         return receiver;
                     }
                 }
             }
 
-            if(receiver.kind == SysmelValueKindObjectReference && receiver.objectReference->clazz->kind == SysmelTypeKindClass)
+            if(sysmelb_value_getKind(receiver) == SysmelValueKindObjectReference && sysmelb_value_getReference(receiver, object)->clazz->kind == SysmelTypeKindClass)
             {
                 if (ast->messageSend.arguments.size == 0)
                 {
-                    int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(receiver.objectReference->clazz, selector.symbolReference);
+                    int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(sysmelb_value_getReference(receiver, object)->clazz, sysmelb_value_getReference(selector, symbol));
                     if(objectFieldIndex >= 0)
                     {
-                        sysmelb_Value_t fieldValue = receiver.objectReference->elements[objectFieldIndex];
+                        sysmelb_Value_t fieldValue = sysmelb_value_getReference(receiver, object)->elements[objectFieldIndex];
                         return fieldValue;
                     }
                 }
                 else if(ast->messageSend.arguments.size == 1)
                 {
                     // Remove the trailing:
-                    sysmelb_symbol_t *fieldName = selector.symbolReference;
-                    if(fieldName->size > 0 && fieldName->string[fieldName->size -1] == ':')
-                        fieldName = sysmelb_internSymbol(fieldName->size - 1, fieldName->string);
+                    sysmelb_symbol_t *fieldName = sysmelb_symbolWithoutTrailingColon(sysmelb_value_getReference(selector, symbol));
 
-                    int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(receiver.objectReference->clazz, fieldName);
+                    int objectFieldIndex = sysmelb_findIndexOfFieldNamedInClass(sysmelb_value_getReference(receiver, object)->clazz, fieldName);
                     if(objectFieldIndex >= 0)
                     {
                         sysmelb_Value_t newFieldValue = sysmelb_analyzeAndEvaluateScript(environment, ast->messageSend.arguments.elements[0]);
-                        receiver.objectReference->elements[objectFieldIndex] = newFieldValue;
+                        sysmelb_value_getReference(receiver, object)->elements[objectFieldIndex] = newFieldValue;
                         return receiver;
                     }
                 }
             }
 
-            if(receiver.kind == SysmelValueKindTypeReference)
+            if(sysmelb_value_getKind(receiver) == SysmelValueKindTypeReference)
             {
-                if(receiver.typeReference->kind == SysmelTypeKindEnum)
+                if(sysmelb_value_getReference(receiver, type)->kind == SysmelTypeKindEnum)
                 {
                     sysmelb_Value_t enumValue;
-                    if(sysmelb_findEnumValueWithName(receiver.typeReference, selector.symbolReference, &enumValue))
+                    if(sysmelb_findEnumValueWithName(sysmelb_value_getReference(receiver, type), sysmelb_value_getReference(selector, symbol), &enumValue))
                         return enumValue;
                 }
             }
 
-            if(receiver.kind == SysmelValueKindNamespaceReference)
+            if(sysmelb_value_getKind(receiver) == SysmelValueKindNamespaceReference)
             {
-                sysmelb_SymbolBinding_t *binding = sysmelb_namespace_lookupExportedObject(receiver.namespaceReference, selector.symbolReference);
+                sysmelb_SymbolBinding_t *binding = sysmelb_namespace_lookupExportedObject(sysmelb_value_getReference(receiver, namespace), sysmelb_value_getReference(selector, symbol));
                 if (binding && binding->kind == SysmelSymbolValueBinding)
                     return binding->value;
             }
 
             if(!method)
             {
-                sysmelb_errorPrintf(ast->sourcePosition, "Failed to find method with selector #%.*s.\n", selector.symbolReference->size, selector.symbolReference->string);
+                sysmelb_errorPrintf(ast->sourcePosition, "Failed to find method with selector #%.*s.\n", sysmelb_value_getReference(selector, symbol)->size, sysmelb_value_getReference(selector, symbol)->string);
                 abort();
             }
         }
@@ -301,22 +272,16 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             sysmelb_ParseTreeNode_t *receiverLiteralNode = sysmelb_newParseTreeNode(ParseTreeLiteralValueNode, ast->sourcePosition);
             receiverLiteralNode->literalValue.value = receiver;
 
-            sysmelb_Value_t receiverLiteralNodeValue = {
-                .kind = SysmelValueKindParseTreeReference,
-                .type = sysmelb_getBasicTypes()->parseTreeNode,
-                .parseTreeReference = receiverLiteralNode
-            };
+            sysmelb_Value_t receiverLiteralNodeValue = sysmelb_value_makeReference(
+                SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, receiverLiteralNode);
 
             messageArguments[0] = receiverLiteralNodeValue;
             size_t argumentCount = ast->messageSend.arguments.size;
             for(size_t i = 0; i < argumentCount; ++i)
             {
                 sysmelb_ParseTreeNode_t *argumentNode = ast->messageSend.arguments.elements[i];
-                sysmelb_Value_t argumentValue = {
-                    .kind = SysmelValueKindParseTreeReference,
-                    .type = sysmelb_getBasicTypes()->parseTreeNode,
-                    .parseTreeReference = argumentNode
-                };
+                sysmelb_Value_t argumentValue = sysmelb_value_makeReference(
+                    SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, argumentNode);
 
                 messageArguments[1 + i] = argumentValue;
             }
@@ -326,8 +291,8 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 .sourcePosition = ast->sourcePosition,
             };
             sysmelb_Value_t macroResult = method->primitiveMacroFunction(&macroContext, 1 + argumentCount, messageArguments);
-            if(macroResult.kind == SysmelValueKindParseTreeReference)
-                return sysmelb_analyzeAndEvaluateScript(environment, macroResult.parseTreeReference);
+            if(sysmelb_value_getKind(macroResult) == SysmelValueKindParseTreeReference)
+                return sysmelb_analyzeAndEvaluateScript(environment, sysmelb_value_getReference(macroResult, parseTree));
             else
                 return macroResult;
             return method->primitiveFunction(1 + argumentCount, messageArguments);
@@ -411,11 +376,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             for(size_t i = 0; i < arraySize; ++i)
                 arrayData->elements[i] = sysmelb_decayValue(sysmelb_analyzeAndEvaluateScript(environment, ast->tuple.elements.elements[i]));
 
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindArrayReference,
-                .type = sysmelb_getBasicTypes()->array,
-                .arrayReference = arrayData
-            };
+            sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, arrayData);
             return result;
         }
     case ParseTreeByteArray:
@@ -426,14 +387,11 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             for(size_t i = 0; i < arraySize; ++i)
             {
                 sysmelb_Value_t elementValue = sysmelb_decayValue(sysmelb_analyzeAndEvaluateScript(environment, ast->tuple.elements.elements[i]));
-                byteArrayData->elements[i] = (uint8_t)elementValue.unsignedInteger;
+                byteArrayData->elements[i] = (uint8_t)sysmelb_value_getUnsignedInteger(elementValue);
             }
 
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindByteArrayReference,
-                .type = sysmelb_getBasicTypes()->byteArray,
-                .byteArrayReference = byteArrayData
-            };
+            sysmelb_Value_t result = sysmelb_value_makeReference(
+                SysmelValueKindByteArrayReference, sysmelb_getBasicTypes()->byteArray, byteArrayData);
             return result;
         }
     case ParseTreeTuple:
@@ -444,11 +402,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             for(size_t i = 0; i < tupleSize; ++i)
                 tupleData->elements[i] = sysmelb_decayValue(sysmelb_analyzeAndEvaluateScript(environment, ast->tuple.elements.elements[i]));
 
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindTupleReference,
-                .type = sysmelb_getBasicTypes()->tuple,
-                .tupleReference = tupleData
-            };
+            sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTupleReference, sysmelb_getBasicTypes()->tuple, tupleData);
             return result;
         }
 
@@ -460,11 +414,8 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             if(ast->association.value)
                 association->value = sysmelb_analyzeAndEvaluateScript(environment, ast->association.value);
 
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindAssociationReference,
-                .type = sysmelb_getBasicTypes()->association,
-                .associationReference = association
-            };
+            sysmelb_Value_t result = sysmelb_value_makeReference(
+                SysmelValueKindAssociationReference, sysmelb_getBasicTypes()->association, association);
             return result;
         }
 
@@ -476,16 +427,13 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             for(size_t i = 0; i < dictionarySize; ++i)
             {
                 sysmelb_Value_t elementValue = sysmelb_analyzeAndEvaluateScript(environment, ast->dictionary.elements.elements[i]);
-                if(elementValue.kind != SysmelValueKindAssociationReference)
+                if(sysmelb_value_getKind(elementValue) != SysmelValueKindAssociationReference)
                     sysmelb_errorPrintf(ast->dictionary.elements.elements[i]->sourcePosition, "Expected an association for the dictionary.");
-                dictionary->elements[i] = elementValue.associationReference;
+                dictionary->elements[i] = sysmelb_value_getReference(elementValue, association);
             }
             
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindImmutableDictionaryReference,
-                .type = sysmelb_getBasicTypes()->immutableDictionary,
-                .immutableDictionaryReference = dictionary
-            };
+            sysmelb_Value_t result = sysmelb_value_makeReference(
+                SysmelValueKindImmutableDictionaryReference, sysmelb_getBasicTypes()->immutableDictionary, dictionary);
             return result;
         }
 
@@ -513,17 +461,14 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
         if(ast->bindableName.isMutable)
         {
             sysmelb_Value_t nameValue = sysmelb_analyzeAndEvaluateScript(environment, ast->bindableName.nameExpression);
-            if(nameValue.kind != SysmelValueKindSymbolReference)
+            if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
                 sysmelb_errorPrintf(ast->bindableName.nameExpression->sourcePosition, "Expected a name");
 
             sysmelb_ValueBox_t *box = sysmelb_allocate(sizeof(sysmelb_ValueBox_t));
-            sysmelb_Value_t value = {
-                .kind = SysmelValueKindValueBoxReference,
-                .type = sysmelb_getBasicTypes()->valueReference,
-                .valueBoxReference = box,
-            };
+            sysmelb_Value_t value = sysmelb_value_makeReference(
+                SysmelValueKindValueBoxReference, sysmelb_getBasicTypes()->valueReference, box);
 
-            sysmelb_Environment_setLocalSymbolBinding(environment, nameValue.symbolReference, sysmelb_createSymbolValueBinding(value));
+            sysmelb_Environment_setLocalSymbolBinding(environment, sysmelb_value_getReference(nameValue, symbol), sysmelb_createSymbolValueBinding(value));
             return value;
         }
 
@@ -543,7 +488,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             if(!isAnonymous)
             {
                 nameValue = sysmelb_analyzeAndEvaluateScript(environment, store->bindableName.nameExpression);
-                if(nameValue.kind != SysmelValueKindSymbolReference)
+                if(sysmelb_value_getKind(nameValue) != SysmelValueKindSymbolReference)
                     sysmelb_errorPrintf(store->bindableName.nameExpression->sourcePosition, "Expected a name");
             }
 
@@ -554,7 +499,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 functionNode->function.functionDependentType = store->bindableName.typeExpression;
                 functionNode->function.bodyExpression = value;
                 if(!isAnonymous)
-                    functionNode->function.name = nameValue.symbolReference;
+                    functionNode->function.name = sysmelb_value_getReference(nameValue, symbol);
                 return sysmelb_analyzeAndCompileClosure(environment, functionNode);
             }
 
@@ -564,34 +509,31 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 sysmelb_ValueBox_t *box = sysmelb_allocate(sizeof(sysmelb_ValueBox_t));
                 box->currentValue = initialValue;
 
-                sysmelb_Value_t boxValue = {
-                    .kind = SysmelValueKindValueBoxReference,
-                    .type = sysmelb_getBasicTypes()->valueReference,
-                    .valueBoxReference = box,
-                };
-                sysmelb_Environment_setLocalSymbolBinding(environment, nameValue.symbolReference, sysmelb_createSymbolValueBinding(boxValue));
+                sysmelb_Value_t boxValue = sysmelb_value_makeReference(
+                    SysmelValueKindValueBoxReference, sysmelb_getBasicTypes()->valueReference, box);
+                sysmelb_Environment_setLocalSymbolBinding(environment, sysmelb_value_getReference(nameValue, symbol), sysmelb_createSymbolValueBinding(boxValue));
                 return boxValue;
             }
             else
             {
-                sysmelb_Environment_setLocalSymbolBinding(environment, nameValue.symbolReference, sysmelb_createSymbolValueBinding(initialValue));
+                sysmelb_Environment_setLocalSymbolBinding(environment, sysmelb_value_getReference(nameValue, symbol), sysmelb_createSymbolValueBinding(initialValue));
                 return initialValue;
             }
         }
         else if (store->kind == ParseTreeIdentifierReference)
         {
             sysmelb_Value_t storeValue = sysmelb_analyzeAndEvaluateScript(environment, store);
-            if(storeValue.kind == SysmelValueKindValueBoxReference)
+            if(sysmelb_value_getKind(storeValue) == SysmelValueKindValueBoxReference)
             {
                 sysmelb_Value_t newValue = sysmelb_analyzeAndEvaluateScript(environment, value);
-                storeValue.valueBoxReference->currentValue = newValue;
+                sysmelb_value_getReference(storeValue, valueBox)->currentValue = newValue;
                 return storeValue;
             }
         }
 
         // Transform the assignment into a message send.
         sysmelb_ParseTreeNode_t *selector = sysmelb_newParseTreeNode(ParseTreeLiteralSymbolNode, ast->sourcePosition);
-        selector->literalSymbol.internedSymbol = sysmelb_internSymbolC(":=");
+        selector->literalSymbol.internedSymbol = sysmelb_WellKnownSymbols.assignment;
 
         sysmelb_ParseTreeNode_t *message = sysmelb_newParseTreeNode(ParseTreeMessageSend, ast->sourcePosition);
         message->messageSend.receiver = store;
@@ -605,12 +547,12 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
     case ParseTreeIfSelection:
         {
             sysmelb_Value_t condition = sysmelb_analyzeAndEvaluateScript(environment, ast->ifSelection.condition);
-            if(condition.kind != SysmelValueKindBoolean)
+            if(sysmelb_value_getKind(condition) != SysmelValueKindBoolean)
             {
                 sysmelb_errorPrintf(ast->sourcePosition, "Expected a boolean condition.");
             }
 
-            if(condition.boolean)
+            if(sysmelb_value_getBoolean(condition))
             {
                 if(ast->ifSelection.trueExpression)
                     return sysmelb_analyzeAndEvaluateScript(environment, ast->ifSelection.trueExpression);
@@ -621,18 +563,16 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                     return sysmelb_analyzeAndEvaluateScript(environment, ast->ifSelection.falseExpression);
             }
 
-            sysmelb_Value_t voidResult = {
-                .kind = SysmelValueKindVoid
-            };
+            sysmelb_Value_t voidResult = sysmelb_value_makeImmediate(SysmelValueKindVoid, NULL);
             return voidResult;
         }
     case ParseTreeWhileLoop:
     {
         sysmelb_Value_t condition = sysmelb_analyzeAndEvaluateScript(environment, ast->whileLoop.condition);
-        if(condition.kind != SysmelValueKindBoolean)
+        if(sysmelb_value_getKind(condition) != SysmelValueKindBoolean)
             sysmelb_errorPrintf(ast->sourcePosition, "While loop condition must be a boolean.");
 
-        while(condition.boolean)
+        while(sysmelb_value_getBoolean(condition))
         {
             if(ast->whileLoop.body)
                 sysmelb_analyzeAndEvaluateScript(environment, ast->whileLoop.body);
@@ -641,40 +581,30 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 sysmelb_analyzeAndEvaluateScript(environment, ast->whileLoop.continueExpression);
 
             condition = sysmelb_analyzeAndEvaluateScript(environment, ast->whileLoop.condition);
-            if(condition.kind != SysmelValueKindBoolean)
+            if(sysmelb_value_getKind(condition) != SysmelValueKindBoolean)
                 sysmelb_errorPrintf(ast->sourcePosition, "While loop condition must be a boolean.");
         }
 
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
         return voidValue;
     }
     case ParseTreeDoWhileLoop:
     {
-        sysmelb_Value_t conditionValue = {
-            .kind = SysmelValueKindBoolean,
-            .type = sysmelb_getBasicTypes()->boolean,
-            .boolean = false,
-        };
+        sysmelb_Value_t conditionValue = sysmelb_value_makeBoolean(false);
         do {
             sysmelb_analyzeAndEvaluateScript(environment, ast->doWhileLoop.body);
             if(ast->doWhileLoop.continueExpression)
                 sysmelb_analyzeAndEvaluateScript(environment, ast->doWhileLoop.continueExpression);
             conditionValue = sysmelb_analyzeAndEvaluateScript(environment, ast->doWhileLoop.condition);
-        } while (conditionValue.boolean);
+        } while (sysmelb_value_getBoolean(conditionValue));
 
-        sysmelb_Value_t voidValue = {
-            .kind = SysmelValueKindVoid,
-            .type = sysmelb_getBasicTypes()->voidType
-        };
+        sysmelb_Value_t voidValue = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
         return voidValue;
     }
     case ParseTreeSwitch:
     {
         sysmelb_Value_t value = sysmelb_analyzeAndEvaluateScript(environment, ast->switchExpression.value);
-        assert(value.kind == SysmelValueKindInteger || value.kind == SysmelValueKindUnsignedInteger);
+        assert(sysmelb_value_getKind(value) == SysmelValueKindInteger || sysmelb_value_getKind(value) == SysmelValueKindUnsignedInteger);
         assert(ast->switchExpression.cases->kind == ParseTreeImmutableDictionary);
         sysmelb_ParseTreeImmutableDictionary_t *dictionary = &ast->switchExpression.cases->dictionary;
         size_t caseCount = dictionary->elements.size;
@@ -684,25 +614,22 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
             assert(dictionary->elements.elements[i]->kind == ParseTreeAssociation);
             sysmelb_ParseTreeAssociation_t *caseAssoc = &dictionary->elements.elements[i]->association;
             sysmelb_Value_t caseKeyValue = sysmelb_analyzeAndEvaluateScript(environment, caseAssoc->key);
-            if(caseKeyValue.kind == SysmelValueKindSymbolReference)
+            if(sysmelb_value_getKind(caseKeyValue) == SysmelValueKindSymbolReference)
             {
-                assert(caseKeyValue.symbolReference->size == 1 && caseKeyValue.symbolReference->string[0] == '_');
+                assert(sysmelb_value_getReference(caseKeyValue, symbol)->size == 1 && sysmelb_value_getReference(caseKeyValue, symbol)->string[0] == '_');
                 defaultCase = caseAssoc->value;
 
             }
-            else if(caseKeyValue.kind == SysmelValueKindInteger || caseKeyValue.kind == SysmelValueKindUnsignedInteger)
+            else if(sysmelb_value_getKind(caseKeyValue) == SysmelValueKindInteger || sysmelb_value_getKind(caseKeyValue) == SysmelValueKindUnsignedInteger)
             {
-                if(value.integer == caseKeyValue.integer)
+                if(sysmelb_value_getInteger(value) == sysmelb_value_getInteger(caseKeyValue))
                     return sysmelb_analyzeAndEvaluateScript(environment, caseAssoc->value);
             }
         }
         
         if(!defaultCase)
         {
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindVoid,
-                .type = sysmelb_getBasicTypes()->voidType,
-            };
+            sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
             return result;
         }
 
@@ -712,8 +639,8 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
     {
         sysmelb_Value_t value = sysmelb_analyzeAndEvaluateScript(environment, ast->switchPatternMatching.value);
         sysmelb_Value_t sumTypeValue = sysmelb_analyzeAndEvaluateScript(environment, ast->switchPatternMatching.valueSumType);
-        assert(value.kind == SysmelValueKindSumValueReference);
-        assert(sumTypeValue.kind == SysmelValueKindTypeReference);
+        assert(sysmelb_value_getKind(value) == SysmelValueKindSumValueReference);
+        assert(sysmelb_value_getKind(sumTypeValue) == SysmelValueKindTypeReference);
         assert(ast->switchPatternMatching.cases->kind == ParseTreeImmutableDictionary);
         sysmelb_ParseTreeImmutableDictionary_t *dictionary = &ast->switchPatternMatching.cases->dictionary;
         size_t caseCount = dictionary->elements.size;
@@ -733,26 +660,26 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
                 }
 
                 sysmelb_Value_t bindableTypeValue = sysmelb_analyzeAndEvaluateScript(environment, bindableName->typeExpression);
-                int sumTypeIndex = sysmelb_findSumTypeIndexForType(sumTypeValue.typeReference, bindableTypeValue.typeReference);
-                if(sumTypeIndex < 0 || value.sumTypeValueReference->alternativeIndex != (uint32_t)sumTypeIndex)
+                int sumTypeIndex = sysmelb_findSumTypeIndexForType(sysmelb_value_getReference(sumTypeValue, type), sysmelb_value_getReference(bindableTypeValue, type));
+                if(sumTypeIndex < 0 || sysmelb_value_getReference(value, sumTypeValue)->alternativeIndex != (uint32_t)sumTypeIndex)
                     continue;
 
                 sysmelb_Environment_t *caseEnvironment = sysmelb_createLexicalEnvironment(environment);
-                sysmelb_Value_t caseValue = value.sumTypeValueReference->alternativeValue;
+                sysmelb_Value_t caseValue = sysmelb_value_getReference(value, sumTypeValue)->alternativeValue;
 
                 if(bindableName->nameExpression)
                 {
                     sysmelb_Value_t bindableNameValue = sysmelb_analyzeAndEvaluateScript(caseEnvironment, bindableName->nameExpression);
-                    sysmelb_Environment_setLocalSymbolBinding(caseEnvironment, bindableNameValue.symbolReference, sysmelb_createSymbolValueBinding(caseValue));
+                    sysmelb_Environment_setLocalSymbolBinding(caseEnvironment, sysmelb_value_getReference(bindableNameValue, symbol), sysmelb_createSymbolValueBinding(caseValue));
                 }
 
                 return sysmelb_analyzeAndEvaluateScript(caseEnvironment, caseAssoc->value);
             }
 
             sysmelb_Value_t caseKeyValue = sysmelb_analyzeAndEvaluateScript(environment, caseAssoc->key);
-            if(caseKeyValue.kind == SysmelValueKindSymbolReference)
+            if(sysmelb_value_getKind(caseKeyValue) == SysmelValueKindSymbolReference)
             {
-                assert(caseKeyValue.symbolReference->size == 1 && caseKeyValue.symbolReference->string[0] == '_');
+                assert(sysmelb_value_getReference(caseKeyValue, symbol)->size == 1 && sysmelb_value_getReference(caseKeyValue, symbol)->string[0] == '_');
                 defaultCase = caseAssoc->value;
 
             }
@@ -760,10 +687,7 @@ sysmelb_Value_t sysmelb_analyzeAndEvaluateScript(sysmelb_Environment_t *environm
         
         if(!defaultCase)
         {
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindVoid,
-                .type = sysmelb_getBasicTypes()->voidType,
-            };
+            sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
             return result;
         }
 
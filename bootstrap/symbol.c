@@ -1,5 +1,7 @@
 #include "symbol.h"
+#include "hash.h"
 #include "memory.h"
+#include "gc.h"
 #include <string.h>
 #include <stdbool.h>
 
@@ -12,34 +14,69 @@ typedef struct sysmelb_symbolHashSet_s
 } sysmelb_symbolHashSet_t;
 
 static sysmelb_symbolHashSet_t sysmelb_internedSymbolSet;
+static sysmelb_symbol_t **sysmelb_symbolsByID;
+static uint32_t sysmelb_symbolsByIDCapacity;
+sysmelb_WellKnownSymbols_t sysmelb_WellKnownSymbols;
+
+static void sysmelb_internWellKnownSymbols(void)
+{
+#define WellKnownSymbol(name, string) sysmelb_WellKnownSymbols.name = sysmelb_internSymbolC(string);
+#include "well-known-symbol.inc"
+#undef WellKnownSymbol
+}
 
 int32_t sysmelb_symbolScanForCapacityIncrement(sysmelb_symbol_t *symbol)
 {
     if(sysmelb_internedSymbolSet.capacity == 0)
         return -1;
 
-    uint32_t hash = symbol->hash;
-    uint32_t hashIndex = hash % sysmelb_internedSymbolSet.capacity;
+    uint32_t mask = sysmelb_internedSymbolSet.capacity - 1;
+    uint32_t hashIndex = symbol->hash & mask;
 
-    for(uint32_t i = hashIndex; i < sysmelb_internedSymbolSet.capacity; ++i)
+    for(uint32_t i = 0; i < sysmelb_internedSymbolSet.capacity; ++i)
     {
-        if(!sysmelb_internedSymbolSet.internedSymbols[i] ||
-            sysmelb_internedSymbolSet.internedSymbols[i] == symbol)
-                return i;
+        if(!sysmelb_internedSymbolSet.internedSymbols[hashIndex] ||
+            sysmelb_internedSymbolSet.internedSymbols[hashIndex] == symbol)
+                return hashIndex;
+        hashIndex = (hashIndex + 1) & mask;
     }
 
-    for(uint32_t i = 0; i < hashIndex; ++i)
+    return -1;
+}
+
+void sysmelb_measureInternedSymbols(sysmelb_HashtableMeasure_t *measure)
+{
+    memset(measure, 0, sizeof(sysmelb_HashtableMeasure_t));
+    measure->size = sysmelb_internedSymbolSet.size;
+    measure->capacity = sysmelb_internedSymbolSet.capacity;
+    measure->storageBytes = sysmelb_internedSymbolSet.capacity * sizeof(sysmelb_symbol_t *);
+
+    size_t mask = sysmelb_internedSymbolSet.capacity - 1;
+    for(size_t i = 0; i < sysmelb_internedSymbolSet.capacity; ++i)
     {
-        if(!sysmelb_internedSymbolSet.internedSymbols[i] ||
-            sysmelb_internedSymbolSet.internedSymbols[i] == symbol)
-                return i;
+        sysmelb_symbol_t *symbol = sysmelb_internedSymbolSet.internedSymbols[i];
+        if(!symbol)
+            continue;
+
+        size_t probeLength = ((i - symbol->hash) & mask) + 1;
+        measure->totalProbeLength += probeLength;
+        if(probeLength > measure->maxProbeLength)
+            measure->maxProbeLength = probeLength;
     }
+}
 
-    return -1;
+static void sysmelb_recordInternedSymbolsResize(void)
+{
+    sysmelb_HashtableMeasure_t measure;
+    sysmelb_measureInternedSymbols(&measure);
+    sysmelb_hashtableStats_recordResize(&sysmelb_internedSymbolSet, SysmelHashtableKindInternedSymbols, &measure);
 }
 
 void symbol_hashsetIncreaseCapacity(void)
 {
+    if(sysmelb_HashtableStatsEnabled)
+        sysmelb_recordInternedSymbolsResize();
+
     sysmelb_symbolHashSet_t oldStateAndCapacity = sysmelb_internedSymbolSet;
     size_t newCapacity = oldStateAndCapacity.capacity * 2;
     if(newCapacity < 1024)
@@ -59,7 +96,10 @@ void symbol_hashsetIncreaseCapacity(void)
         int scanLocation = sysmelb_symbolScanForCapacityIncrement(symbol);
         assert(scanLocation >= 0);
         sysmelb_internedSymbolSet.internedSymbols[scanLocation] = symbol;
+        ++sysmelb_internedSymbolSet.size;
     }
+
+    sysmelb_freeAllocation(oldStateAndCapacity.internedSymbols);
 }
 
 bool sysmelb_symbolEquals(sysmelb_symbol_t *a, sysmelb_symbol_t *b)
@@ -75,49 +115,63 @@ bool sysmelb_symbolStringEquals(sysmelb_symbol_t *a, size_t stringSize, const ch
         && memcmp(a->string, string, stringSize) == 0;
 }
 
-uint32_t sysmelb_stringHash(size_t stringSize, const char *string)
+uint64_t sysmelb_stringHash(size_t stringSize, const char *string)
 {
-    uint32_t hash = 0;
-    for(size_t i = 0; i < stringSize; ++i)
-        hash = hash*1664525 + string[i];
-    return hash;
+    return sysmelb_hashBytes(stringSize, string);
 }
 
-int32_t sysmelb_symbolScanForString(size_t stringSize, const char *string)
+int32_t sysmelb_symbolScanForString(uint64_t hash, size_t stringSize, const char *string)
 {
     if(sysmelb_internedSymbolSet.capacity == 0)
         return -1;
 
-    uint32_t hash = sysmelb_stringHash(stringSize, string);
-    uint32_t hashIndex = hash % sysmelb_internedSymbolSet.capacity;
+    uint32_t mask = sysmelb_internedSymbolSet.capacity - 1;
+    uint32_t hashIndex = hash & mask;
 
-    for(uint32_t i = hashIndex; i < sysmelb_internedSymbolSet.capacity; ++i)
+    for(uint32_t i = 0; i < sysmelb_internedSymbolSet.capacity; ++i)
     {
-        if(!sysmelb_internedSymbolSet.internedSymbols[i] ||
-            sysmelb_symbolStringEquals(sysmelb_internedSymbolSet.internedSymbols[i], stringSize, string))
-                return i;
+        sysmelb_symbol_t *symbol = sysmelb_internedSymbolSet.internedSymbols[hashIndex];
+        if(!symbol || (symbol->hash == hash && sysmelb_symbolStringEquals(symbol, stringSize, string)))
+                return hashIndex;
+        hashIndex = (hashIndex + 1) & mask;
     }
 
-    for(uint32_t i = 0; i < hashIndex; ++i)
+    return -1;
+}
+
+static uint32_t sysmelb_addSymbolWithNextID(sysmelb_symbol_t *symbol)
+{
+    // Symbols are never removed, so their count is the next ID.
+    uint32_t id = sysmelb_internedSymbolSet.size;
+    if(id >= sysmelb_symbolsByIDCapacity)
     {
-        if(!sysmelb_internedSymbolSet.internedSymbols[i] ||
-            sysmelb_symbolStringEquals(sysmelb_internedSymbolSet.internedSymbols[i], stringSize, string))
-                return i;
+        uint32_t newCapacity = sysmelb_symbolsByIDCapacity ? sysmelb_symbolsByIDCapacity*2 : 1024;
+        sysmelb_symbol_t **newSymbolsByID = sysmelb_allocate(newCapacity * sizeof(sysmelb_symbol_t *));
+        if(sysmelb_symbolsByID)
+            memcpy(newSymbolsByID, sysmelb_symbolsByID, sysmelb_symbolsByIDCapacity * sizeof(sysmelb_symbol_t *));
+        sysmelb_freeAllocation(sysmelb_symbolsByID);
+        sysmelb_symbolsByID = newSymbolsByID;
+        sysmelb_symbolsByIDCapacity = newCapacity;
     }
 
-    return -1;
+    sysmelb_symbolsByID[id] = symbol;
+    return id;
 }
 
 sysmelb_symbol_t *sysmelb_internSymbol(size_t stringSize, const char *string)
 {
     if(sysmelb_internedSymbolSet.capacity == 0)
     {
+        if(sysmelb_HashtableStatsEnabled)
+            sysmelb_recordInternedSymbolsResize();
         sysmelb_internedSymbolSet.capacity = 1024;
         sysmelb_internedSymbolSet.targetCapacity = sysmelb_internedSymbolSet.capacity * 80 / 100;
         sysmelb_internedSymbolSet.internedSymbols = sysmelb_allocate(sysmelb_internedSymbolSet.capacity * sizeof(sysmelb_symbol_t *));
+        sysmelb_internWellKnownSymbols();
     }
 
-    int32_t slotIndex = sysmelb_symbolScanForString(stringSize, string);
+    uint64_t hash = sysmelb_stringHash(stringSize, string);
+    int32_t slotIndex = sysmelb_symbolScanForString(hash, stringSize, string);
     assert(slotIndex >= 0);
 
     if(sysmelb_internedSymbolSet.internedSymbols[slotIndex] != NULL)
@@ -126,8 +180,10 @@ sysmelb_symbol_t *sysmelb_internSymbol(size_t stringSize, const char *string)
     size_t symbolAllocationSize = sizeof(sysmelb_symbol_t) + stringSize + 1;
     sysmelb_symbol_t *newSymbol = sysmelb_allocate(symbolAllocationSize);
 
-    newSymbol->hash = sysmelb_stringHash(stringSize, string);
+    newSymbol->hash = hash;
+    newSymbol->id = sysmelb_addSymbolWithNextID(newSymbol);
     newSymbol->size = stringSize;
+    newSymbol->withoutTrailingColon = NULL;
     memcpy(newSymbol->string, string, stringSize);
 
     sysmelb_internedSymbolSet.internedSymbols[slotIndex] = newSymbol;
@@ -142,4 +198,33 @@ sysmelb_symbol_t *sysmelb_internSymbol(size_t stringSize, const char *string)
 sysmelb_symbol_t *sysmelb_internSymbolC(const char *string)
 {
     return sysmelb_internSymbol(strlen(string), string);
+}
+
+uint32_t sysmelb_getInternedSymbolCount(void)
+{
+    return sysmelb_internedSymbolSet.size;
+}
+
+sysmelb_symbol_t *sysmelb_getSymbolWithID(uint32_t id)
+{
+    assert(id < sysmelb_internedSymbolSet.size);
+    return sysmelb_symbolsByID[id];
+}
+
+sysmelb_symbol_t *sysmelb_symbolWithoutTrailingColon(sysmelb_symbol_t *symbol)
+{
+    if(symbol->size == 0 || symbol->string[symbol->size - 1] != ':')
+        return symbol;
+
+    if(!symbol->withoutTrailingColon)
+        symbol->withoutTrailingColon = sysmelb_internSymbol(symbol->size - 1, symbol->string);
+    return symbol->withoutTrailingColon;
+}
+
+void sysmelb_markInternedSymbols(void)
+{
+    sysmelb_gc_markPointer(sysmelb_internedSymbolSet.internedSymbols);
+    sysmelb_gc_markPointer(sysmelb_symbolsByID);
+    for(size_t i = 0; i < sysmelb_internedSymbolSet.capacity; ++i)
+        sysmelb_gc_markPointer(sysmelb_internedSymbolSet.internedSymbols[i]);
 }
\ No newline at end of file
@@ -5,15 +5,39 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "hashtable-stats.h"
 
+// Symbols are numbered densely in interning order, starting from zero, so
+// that tables keyed by symbol can be plain arrays indexed by the ID.
 typedef struct sysmelb_symbol_s {
+    uint64_t hash;
     uint32_t size;
-    uint32_t hash;
+    uint32_t id;
+    struct sysmelb_symbol_s *withoutTrailingColon;
     char string[];
 } sysmelb_symbol_t;
 
-uint32_t sysmelb_stringHash(size_t stringSize, const char *string);
+// Symbols that the interpreter compares against on its hot paths. They are
+// interned together with the symbol table, so that they are compared by
+// pointer instead of by string.
+typedef struct sysmelb_WellKnownSymbols_s {
+#define WellKnownSymbol(name, string) sysmelb_symbol_t *name;
+#include "well-known-symbol.inc"
+#undef WellKnownSymbol
+} sysmelb_WellKnownSymbols_t;
+
+extern sysmelb_WellKnownSymbols_t sysmelb_WellKnownSymbols;
+
+uint64_t sysmelb_stringHash(size_t stringSize, const char *string);
 sysmelb_symbol_t *sysmelb_internSymbol(size_t stringSize, const char *string);
 sysmelb_symbol_t *sysmelb_internSymbolC(const char *string);
+uint32_t sysmelb_getInternedSymbolCount(void);
+sysmelb_symbol_t *sysmelb_getSymbolWithID(uint32_t id);
+
+// The field name that a setter selector refers to, interned once per selector.
+sysmelb_symbol_t *sysmelb_symbolWithoutTrailingColon(sysmelb_symbol_t *symbol);
+
+void sysmelb_markInternedSymbols(void);
+void sysmelb_measureInternedSymbols(sysmelb_HashtableMeasure_t *measure);
 
 #endif //SYSMELB_SYMBOL_H
\ No newline at end of file
@@ -1,16 +1,89 @@
 #include "types.h"
 #include "error.h"
+#include "function.h"
 #include "memory.h"
 #include "parse-tree.h"
 #include "value.h"
 #include "hashtable.h"
+#include "method-cache.h"
 #include <stdbool.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 static bool sysmelb_BasicTypesDataInitialized;
 static sysmelb_BasicTypes_t sysmelb_BasicTypesData;
 
+sysmelb_Type_t **sysmelb_TypeTable;
+uint32_t sysmelb_TypeTableSize;
+static uint32_t sysmelb_TypeTableCapacity;
+
+// The slots of the collected types, which are reused before growing the table.
+static uint32_t *sysmelb_FreeTypeIndices;
+static uint32_t sysmelb_FreeTypeIndexCount;
+static uint32_t sysmelb_FreeTypeIndexCapacity;
+
+static sysmelb_Type_t *sysmelb_allocateType(void)
+{
+    if (sysmelb_FreeTypeIndexCount > 0)
+    {
+        sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+        type->typeIndex = sysmelb_FreeTypeIndices[--sysmelb_FreeTypeIndexCount];
+        sysmelb_TypeTable[type->typeIndex] = type;
+        return type;
+    }
+
+    if (!sysmelb_TypeTable)
+        sysmelb_TypeTableSize = 1;
+
+    if (sysmelb_TypeTableSize >= sysmelb_TypeTableCapacity)
+    {
+        sysmelb_TypeTableCapacity = sysmelb_TypeTableCapacity ? sysmelb_TypeTableCapacity * 2 : 256;
+        sysmelb_TypeTable = realloc(sysmelb_TypeTable, sizeof(sysmelb_Type_t *) * sysmelb_TypeTableCapacity);
+        if (!sysmelb_TypeTable)
+        {
+            fprintf(stderr, "Out of memory.\n");
+            abort();
+        }
+        sysmelb_TypeTable[0] = NULL;
+    }
+
+    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    type->typeIndex = sysmelb_TypeTableSize++;
+    sysmelb_TypeTable[type->typeIndex] = type;
+    return type;
+}
+
+void sysmelb_type_sweepTypeTable(void)
+{
+    bool hasFreedTypes = false;
+    for (uint32_t i = 1; i < sysmelb_TypeTableSize; ++i)
+    {
+        sysmelb_Type_t *type = sysmelb_TypeTable[i];
+        if (!type || sysmelb_memory_isMarked(type))
+            continue;
+
+        if (sysmelb_FreeTypeIndexCount >= sysmelb_FreeTypeIndexCapacity)
+        {
+            sysmelb_FreeTypeIndexCapacity = sysmelb_FreeTypeIndexCapacity ? sysmelb_FreeTypeIndexCapacity * 2 : 64;
+            sysmelb_FreeTypeIndices = realloc(sysmelb_FreeTypeIndices, sizeof(uint32_t) * sysmelb_FreeTypeIndexCapacity);
+            if (!sysmelb_FreeTypeIndices)
+            {
+                fprintf(stderr, "Out of memory.\n");
+                abort();
+            }
+        }
+
+        sysmelb_TypeTable[i] = NULL;
+        sysmelb_FreeTypeIndices[sysmelb_FreeTypeIndexCount++] = i;
+        hasFreedTypes = true;
+    }
+
+    // A new type can be allocated at the address of a collected one.
+    if (hasFreedTypes)
+        sysmelb_methodCache_flush();
+}
+
 void sysmelb_type_addPrimitiveMethod(sysmelb_Type_t *type, sysmelb_symbol_t *selector, sysmelb_PrimitiveFunction_t primitive)
 {
     sysmelb_function_t *function = sysmelb_allocate(sizeof(sysmelb_function_t));
@@ -19,6 +92,7 @@ void sysmelb_type_addPrimitiveMethod(sysmelb_Type_t *type, sysmelb_symbol_t *sel
     function->primitiveFunction = primitive;
 
     sysmelb_SymbolHashtable_addSymbolWithValue(&type->methodDict, selector, function);
+    sysmelb_methodCache_invalidateSelector(selector);
 }
 
 void sysmelb_type_addPrimitiveMacroMethod(sysmelb_Type_t *type, sysmelb_symbol_t *selector, sysmelb_PrimitiveMacroFunction_t primitive)
@@ -29,13 +103,26 @@ void sysmelb_type_addPrimitiveMacroMethod(sysmelb_Type_t *type, sysmelb_symbol_t
     function->primitiveMacroFunction = primitive;
 
     sysmelb_SymbolHashtable_addSymbolWithValue(&type->methodDict, selector, function);
+    sysmelb_methodCache_invalidateSelector(selector);
 }
 
 sysmelb_function_t *sysmelb_type_lookupSelector(sysmelb_Type_t *type, sysmelb_symbol_t *selector)
 {
-    const sysmelb_SymbolHashtablePair_t *pair = sysmelb_SymbolHashtable_lookupSymbol(&type->methodDict, selector);
-    if (pair)
-        return pair->value;
+    // Methods are looked up much more often than added, so the method
+    // dictionary is frozen by the first lookup after it was modified. Freezing
+    // and thawing rebuild the whole dictionary, so once thawed it is only
+    // frozen again after doubling its size, which keeps the cost of code that
+    // alternates adding methods and sending messages linear.
+    if (!type->methodDict.displacements && type->methodDict.size
+        && type->methodDict.size >= type->methodDictFrozenSize*2)
+    {
+        type->methodDictFrozenSize = type->methodDict.size;
+        sysmelb_SymbolHashtable_freeze(&type->methodDict);
+    }
+
+    void *method;
+    if (sysmelb_SymbolHashtable_lookupSymbol(&type->methodDict, selector, &method))
+        return method;
     if (type->supertype)
         return sysmelb_type_lookupSelector(type->supertype, selector);
     return NULL;
@@ -43,7 +130,7 @@ sysmelb_function_t *sysmelb_type_lookupSelector(sysmelb_Type_t *type, sysmelb_sy
 
 sysmelb_Type_t *sysmelb_allocateValueType(sysmelb_TypeKind_t kind, sysmelb_symbol_t *name, uint32_t size, uint32_t alignment)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = kind;
     type->name = name;
     type->valueAlignment = alignment;
@@ -53,7 +140,7 @@ sysmelb_Type_t *sysmelb_allocateValueType(sysmelb_TypeKind_t kind, sysmelb_symbo
 
 sysmelb_Type_t *sysmelb_allocateFixedArrayType(sysmelb_Type_t *baseType, uint32_t size)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = SysmelTypeKindRecord;
     type->valueAlignment = baseType->valueAlignment;
     type->valueSize = baseType->valueSize * size;
@@ -65,7 +152,7 @@ sysmelb_Type_t *sysmelb_allocateFixedArrayType(sysmelb_Type_t *baseType, uint32_
 
 sysmelb_Type_t *sysmelb_allocateRecordType(sysmelb_symbol_t *name, sysmelb_ImmutableDictionary_t *fieldsAndTypes)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = SysmelTypeKindRecord;
     type->name = name;
     type->valueAlignment = 1;
@@ -80,17 +167,17 @@ sysmelb_Type_t *sysmelb_allocateRecordType(sysmelb_symbol_t *name, sysmelb_Immut
     for (size_t i = 0; i < fieldCount; ++i)
     {
         sysmelb_Association_t *assoc = fieldsAndTypes->elements[i];
-        assert(assoc->key.kind == SysmelValueKindSymbolReference);
-        assert(assoc->value.kind == SysmelValueKindTypeReference);
-        type->tupleAndRecords.fieldNames[i] = assoc->key.symbolReference;
-        type->tupleAndRecords.fields[i] = assoc->value.typeReference;
+        assert(sysmelb_value_getKind(assoc->key) == SysmelValueKindSymbolReference);
+        assert(sysmelb_value_getKind(assoc->value) == SysmelValueKindTypeReference);
+        type->tupleAndRecords.fieldNames[i] = sysmelb_value_getReference(assoc->key, symbol);
+        type->tupleAndRecords.fields[i] = sysmelb_value_getReference(assoc->value, type);
     }
     return type;
 }
 
 sysmelb_Type_t *sysmelb_allocateClassType(sysmelb_symbol_t *name, sysmelb_Type_t *superclass, sysmelb_ImmutableDictionary_t *fieldsAndTypes)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = SysmelTypeKindClass;
     type->name = name;
     type->valueAlignment = 1;
@@ -109,17 +196,17 @@ sysmelb_Type_t *sysmelb_allocateClassType(sysmelb_symbol_t *name, sysmelb_Type_t
     for (size_t i = 0; i < fieldCount; ++i)
     {
         sysmelb_Association_t *assoc = fieldsAndTypes->elements[i];
-        assert(assoc->key.kind == SysmelValueKindSymbolReference);
-        assert(assoc->value.kind == SysmelValueKindTypeReference);
-        type->clazz.fieldNames[i] = assoc->key.symbolReference;
-        type->clazz.fields[i] = assoc->value.typeReference;
+        assert(sysmelb_value_getKind(assoc->key) == SysmelValueKindSymbolReference);
+        assert(sysmelb_value_getKind(assoc->value) == SysmelValueKindTypeReference);
+        type->clazz.fieldNames[i] = sysmelb_value_getReference(assoc->key, symbol);
+        type->clazz.fields[i] = sysmelb_value_getReference(assoc->value, type);
     }
     return type;
 }
 
 sysmelb_Type_t *sysmelb_allocateSumType(sysmelb_symbol_t *name, size_t alternativeCount)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = SysmelTypeKindSum;
     type->name = name;
     type->valueAlignment = 1;
@@ -132,7 +219,7 @@ sysmelb_Type_t *sysmelb_allocateSumType(sysmelb_symbol_t *name, size_t alternati
 
 sysmelb_Type_t *sysmelb_allocateEnumType(sysmelb_symbol_t *name, sysmelb_Type_t *baseType, sysmelb_ImmutableDictionary_t *namesAndValues)
 {
-    sysmelb_Type_t *type = sysmelb_allocate(sizeof(sysmelb_Type_t));
+    sysmelb_Type_t *type = sysmelb_allocateType();
     type->kind = SysmelTypeKindEnum;
     type->name = name;
     type->valueAlignment = 1;
@@ -145,24 +232,22 @@ sysmelb_Type_t *sysmelb_allocateEnumType(sysmelb_symbol_t *name, sysmelb_Type_t
     type->enumValues.values = sysmelb_allocate(sizeof(sysmelb_Value_t) * valueCount);
     type->enumValues.valueNames = sysmelb_allocate(sizeof(sysmelb_symbol_t *) * valueCount);
 
-    sysmelb_Value_t lastValue = {
-        .kind = SysmelValueKindInteger,
-        .type = baseType};
+    sysmelb_Value_t lastValue = sysmelb_value_makeImmediate(SysmelValueKindInteger, baseType);
 
     for (size_t i = 0; i < valueCount; ++i)
     {
         sysmelb_Association_t *assoc = namesAndValues->elements[i];
-        assert(assoc->key.kind == SysmelValueKindSymbolReference);
-        if (assoc->value.kind == SysmelValueKindNull && i != 0)
+        assert(sysmelb_value_getKind(assoc->key) == SysmelValueKindSymbolReference);
+        if (sysmelb_value_getKind(assoc->value) == SysmelValueKindNull && i != 0)
         {
-            ++lastValue.integer;
+            sysmelb_value_setInteger(&lastValue, sysmelb_value_getInteger(lastValue) + 1);
         }
         else
         {
             lastValue = assoc->value;
         }
 
-        type->enumValues.valueNames[i] = assoc->key.symbolReference;
+        type->enumValues.valueNames[i] = sysmelb_value_getReference(assoc->key, symbol);
         type->enumValues.values[i] = lastValue;
     }
     return type;
@@ -234,21 +319,19 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
         tupleOrRecord->size = type->tupleAndRecords.fieldCount;
 
         // Prefill with null values.
-        sysmelb_Value_t nullValue = {
-            .kind = SysmelValueKindNull,
-            .type = sysmelb_getBasicTypes()->null};
+        sysmelb_Value_t nullValue = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
         for (size_t i = 0; i < tupleOrRecord->size; ++i)
             tupleOrRecord->elements[i] = nullValue;
 
-        if (argumentCount == 1 && arguments[0].kind == SysmelValueKindImmutableDictionaryReference)
+        if (argumentCount == 1 && sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference)
         {
-            sysmelb_ImmutableDictionary_t *dict = arguments[0].immutableDictionaryReference;
+            sysmelb_ImmutableDictionary_t *dict = sysmelb_value_getReference(arguments[0], immutableDictionary);
             for (size_t i = 0; i < dict->size; ++i)
             {
                 sysmelb_Association_t *assoc = dict->elements[i];
-                assert(assoc->key.kind == SysmelValueKindSymbolReference);
-                sysmelb_symbol_t *fieldName = assoc->key.symbolReference;
-                int fieldIndex = sysmelb_findIndexOfFieldNamed(type, assoc->key.symbolReference);
+                assert(sysmelb_value_getKind(assoc->key) == SysmelValueKindSymbolReference);
+                sysmelb_symbol_t *fieldName = sysmelb_value_getReference(assoc->key, symbol);
+                int fieldIndex = sysmelb_findIndexOfFieldNamed(type, sysmelb_value_getReference(assoc->key, symbol));
                 if (fieldIndex < 0)
                 {
                     sysmelb_SourcePosition_t nullPosition = {};
@@ -265,11 +348,7 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
                 tupleOrRecord->elements[i] = arguments[i];
         }
 
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindTupleReference,
-            .type = type,
-            .tupleReference = tupleOrRecord,
-        };
+        sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTupleReference, type, tupleOrRecord);
 
         return result;
     }
@@ -282,21 +361,19 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
         object->clazz = type;
 
         // Prefill with null values.
-        sysmelb_Value_t nullValue = {
-            .kind = SysmelValueKindNull,
-            .type = sysmelb_getBasicTypes()->null};
+        sysmelb_Value_t nullValue = sysmelb_value_makeImmediate(SysmelValueKindNull, sysmelb_getBasicTypes()->null);
         for (size_t i = 0; i < object->size; ++i)
             object->elements[i] = nullValue;
 
-        if (argumentCount == 1 && arguments[0].kind == SysmelValueKindImmutableDictionaryReference)
+        if (argumentCount == 1 && sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference)
         {
-            sysmelb_ImmutableDictionary_t *dict = arguments[0].immutableDictionaryReference;
+            sysmelb_ImmutableDictionary_t *dict = sysmelb_value_getReference(arguments[0], immutableDictionary);
             for (size_t i = 0; i < dict->size; ++i)
             {
                 sysmelb_Association_t *assoc = dict->elements[i];
-                assert(assoc->key.kind == SysmelValueKindSymbolReference);
-                sysmelb_symbol_t *fieldName = assoc->key.symbolReference;
-                int fieldIndex = sysmelb_findIndexOfFieldNamedInClass(type, assoc->key.symbolReference);
+                assert(sysmelb_value_getKind(assoc->key) == SysmelValueKindSymbolReference);
+                sysmelb_symbol_t *fieldName = sysmelb_value_getReference(assoc->key, symbol);
+                int fieldIndex = sysmelb_findIndexOfFieldNamedInClass(type, sysmelb_value_getReference(assoc->key, symbol));
                 if (fieldIndex < 0)
                 {
                     sysmelb_SourcePosition_t nullPosition = {};
@@ -313,57 +390,50 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
                 object->elements[i] = arguments[i];
         }
 
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindObjectReference,
-            .type = type,
-            .objectReference = object,
-        };
+        sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindObjectReference, type, object);
 
         return result;
     }
     if (type->kind == SysmelTypeKindOrderedCollection)
     {
         sysmelb_OrderedCollection_t *collection = sysmelb_allocate(sizeof(sysmelb_OrderedCollection_t));
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindOrderedCollectionReference,
-            .type = sysmelb_getBasicTypes()->orderedCollection,
-            .orderedCollectionReference = collection};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindOrderedCollectionReference, sysmelb_getBasicTypes()->orderedCollection, collection);
         return result;
     }
     if (type->kind == SysmelTypeKindByteOrderedCollection)
     {
         sysmelb_ByteOrderedCollection_t *collection = sysmelb_allocate(sizeof(sysmelb_ByteOrderedCollection_t));
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindByteOrderedCollectionReference,
-            .type = sysmelb_getBasicTypes()->byteOrderedCollection,
-            .byteOrderedCollectionReference = collection};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindByteOrderedCollectionReference, sysmelb_getBasicTypes()->byteOrderedCollection, collection);
+        return result;
+    }
+    if (type->kind == SysmelTypeKindStringBuilder)
+    {
+        sysmelb_StringBuilder_t *builder = sysmelb_allocate(sizeof(sysmelb_StringBuilder_t));
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindStringBuilderReference, sysmelb_getBasicTypes()->stringBuilder, builder);
         return result;
     }
     if (type->kind == SysmelTypeKindSymbolHashtable)
     {
         sysmelb_SymbolHashtable_t *table = sysmelb_allocate(sizeof(sysmelb_SymbolHashtable_t));
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindSymbolHashtableReference,
-            .type = sysmelb_getBasicTypes()->symbolHashtable,
-            .symbolHashtableReference = table};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindSymbolHashtableReference, sysmelb_getBasicTypes()->symbolHashtable, table);
         return result;
     }
     if (type->kind == SysmelTypeKindIdentityHashset)
     {
         sysmelb_IdentityHashset_t *set = sysmelb_allocate(sizeof(sysmelb_IdentityHashset_t));
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindIdentityHashsetReference,
-            .type = sysmelb_getBasicTypes()->identityHashset,
-            .identityHashsetReference = set};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindIdentityHashsetReference, sysmelb_getBasicTypes()->identityHashset, set);
         return result;
     }
     if (type->kind == SysmelTypeKindIdentityDictionary)
     {
         sysmelb_IdentityDictionary_t *dict = sysmelb_allocate(sizeof(sysmelb_IdentityDictionary_t));
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindIdentityDictionaryReference,
-            .type = sysmelb_getBasicTypes()->identityDictionary,
-            .identityDictionaryReference = dict};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindIdentityDictionaryReference, sysmelb_getBasicTypes()->identityDictionary, dict);
         return result;
     }
     if (type->kind == SysmelTypeKindSum)
@@ -373,7 +443,7 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
             sysmelb_SourcePosition_t emptyPosition = {0};
             sysmelb_errorPrintf(emptyPosition, "Sum types can only be instantiated with a single parameter.");
         }
-        sysmelb_Type_t *argumentType = arguments[0].type;
+        sysmelb_Type_t *argumentType = sysmelb_value_getType(arguments[0]);
         int injectionIndex = sysmelb_findSumTypeIndexForType(type, argumentType);
         if (injectionIndex < 0)
         {
@@ -386,10 +456,7 @@ sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_
         sumValue->alternativeIndex = injectionIndex;
         sumValue->alternativeValue = arguments[0];
 
-        sysmelb_Value_t sumValueValue = {
-            .kind = SysmelValueKindSumValueReference,
-            .type = type,
-            .sumTypeValueReference = sumValue};
+        sysmelb_Value_t sumValueValue = sysmelb_value_makeReference(SysmelValueKindSumValueReference, type, sumValue);
         return sumValueValue;
     }
 
@@ -432,6 +499,7 @@ static void sysmelb_createBasicTypes(void)
 
     sysmelb_BasicTypesData.orderedCollection = sysmelb_allocateValueType(SysmelTypeKindOrderedCollection, sysmelb_internSymbolC("OrderedCollection"), pointerSize, pointerAlignment);
     sysmelb_BasicTypesData.byteOrderedCollection = sysmelb_allocateValueType(SysmelTypeKindByteOrderedCollection, sysmelb_internSymbolC("ByteOrderedCollection"), pointerSize, pointerAlignment);
+    sysmelb_BasicTypesData.stringBuilder = sysmelb_allocateValueType(SysmelTypeKindStringBuilder, sysmelb_internSymbolC("StringBuilder"), pointerSize, pointerAlignment);
     sysmelb_BasicTypesData.identityHashset = sysmelb_allocateValueType(SysmelTypeKindIdentityHashset, sysmelb_internSymbolC("IdentityHashset"), pointerSize, pointerAlignment);
     sysmelb_BasicTypesData.identityDictionary = sysmelb_allocateValueType(SysmelTypeKindIdentityDictionary, sysmelb_internSymbolC("IdentityDictionary"), pointerSize, pointerAlignment);
 
@@ -497,7 +565,7 @@ static sysmelb_Value_t sysmelb_primitive_negated(size_t argumentCount, sysmelb_V
 {
     assert(argumentCount == 1);
     sysmelb_Value_t integerValue = sysmelb_decayValue(arguments[0]);
-    integerValue.integer = sysmelb_normalizeIntegerValue(integerValue.type, -integerValue.integer);
+    sysmelb_value_setInteger(&integerValue, sysmelb_normalizeIntegerValue(sysmelb_value_getType(integerValue), -sysmelb_value_getInteger(integerValue)));
     return integerValue;
 }
 
@@ -505,7 +573,7 @@ static sysmelb_Value_t sysmelb_primitive_bitInvert(size_t argumentCount, sysmelb
 {
     assert(argumentCount == 1);
     sysmelb_Value_t integerValue = sysmelb_decayValue(arguments[0]);
-    integerValue.integer = sysmelb_normalizeIntegerValue(integerValue.type, ~integerValue.integer);
+    sysmelb_value_setInteger(&integerValue, sysmelb_normalizeIntegerValue(sysmelb_value_getType(integerValue), ~sysmelb_value_getInteger(integerValue)));
     return integerValue;
 }
 
@@ -515,7 +583,7 @@ static sysmelb_Value_t sysmelb_primitive_plus(size_t argumentCount, sysmelb_Valu
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer + rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) + sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -525,7 +593,7 @@ static sysmelb_Value_t sysmelb_primitive_minus(size_t argumentCount, sysmelb_Val
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer - rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) - sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -535,7 +603,7 @@ static sysmelb_Value_t sysmelb_primitive_times(size_t argumentCount, sysmelb_Val
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer * rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) * sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -545,7 +613,7 @@ static sysmelb_Value_t sysmelb_primitive_integerDivision(size_t argumentCount, s
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer / rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) / sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -555,7 +623,7 @@ static sysmelb_Value_t sysmelb_primitive_integerModule(size_t argumentCount, sys
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer % rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) % sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -565,7 +633,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitAnd(size_t argumentCount, sys
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer & rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) & sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -575,7 +643,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitOr(size_t argumentCount, sysm
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer | rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) | sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -585,7 +653,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitXor(size_t argumentCount, sys
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer ^ rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) ^ sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -595,7 +663,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitShiftLeft(size_t argumentCoun
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer << rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) << sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -605,7 +673,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitShiftRight(size_t argumentCou
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.unsignedInteger >> rightValue.unsignedInteger);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getUnsignedInteger(leftValue) >> sysmelb_value_getUnsignedInteger(rightValue)));
     return result;
 }
 
@@ -615,7 +683,7 @@ static sysmelb_Value_t sysmelb_primitive_integerBitArithmeicShiftRight(size_t ar
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
     sysmelb_Value_t result = leftValue;
-    result.integer = sysmelb_normalizeIntegerValue(result.type, leftValue.integer >> rightValue.integer);
+    sysmelb_value_setInteger(&result, sysmelb_normalizeIntegerValue(sysmelb_value_getType(result), sysmelb_value_getInteger(leftValue) >> sysmelb_value_getInteger(rightValue)));
     return result;
 }
 
@@ -624,10 +692,7 @@ static sysmelb_Value_t sysmelb_primitive_integerEquals(size_t argumentCount, sys
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = leftValue.integer == rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getInteger(leftValue) == sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -636,10 +701,7 @@ static sysmelb_Value_t sysmelb_primitive_integerNotEquals(size_t argumentCount,
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = leftValue.integer != rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getInteger(leftValue) != sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -648,12 +710,10 @@ static sysmelb_Value_t sysmelb_primitive_integerLessThan(size_t argumentCount, s
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = (leftValue.kind == SysmelValueKindUnsignedInteger)
-                       ? leftValue.unsignedInteger < rightValue.unsignedInteger
-                       : leftValue.integer < rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        (sysmelb_value_getKind(leftValue) == SysmelValueKindUnsignedInteger)
+            ? sysmelb_value_getUnsignedInteger(leftValue) < sysmelb_value_getUnsignedInteger(rightValue)
+            : sysmelb_value_getInteger(leftValue) < sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -662,12 +722,10 @@ static sysmelb_Value_t sysmelb_primitive_integerLessOrEquals(size_t argumentCoun
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = (leftValue.kind == SysmelValueKindUnsignedInteger)
-                       ? leftValue.unsignedInteger <= rightValue.unsignedInteger
-                       : leftValue.integer <= rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        (sysmelb_value_getKind(leftValue) == SysmelValueKindUnsignedInteger)
+            ? sysmelb_value_getUnsignedInteger(leftValue) <= sysmelb_value_getUnsignedInteger(rightValue)
+            : sysmelb_value_getInteger(leftValue) <= sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -676,12 +734,10 @@ static sysmelb_Value_t sysmelb_primitive_integerGreaterThan(size_t argumentCount
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = (leftValue.kind == SysmelValueKindUnsignedInteger)
-                       ? leftValue.unsignedInteger > rightValue.unsignedInteger
-                       : leftValue.integer > rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        (sysmelb_value_getKind(leftValue) == SysmelValueKindUnsignedInteger)
+            ? sysmelb_value_getUnsignedInteger(leftValue) > sysmelb_value_getUnsignedInteger(rightValue)
+            : sysmelb_value_getInteger(leftValue) > sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -690,12 +746,10 @@ static sysmelb_Value_t sysmelb_primitive_integerGreaterOrEquals(size_t argumentC
     assert(argumentCount == 2);
     sysmelb_Value_t leftValue = sysmelb_decayValue(arguments[0]);
     sysmelb_Value_t rightValue = sysmelb_decayValue(arguments[1]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = (leftValue.kind == SysmelValueKindUnsignedInteger)
-                       ? leftValue.unsignedInteger >= rightValue.unsignedInteger
-                       : leftValue.integer >= rightValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        (sysmelb_value_getKind(leftValue) == SysmelValueKindUnsignedInteger)
+            ? sysmelb_value_getUnsignedInteger(leftValue) >= sysmelb_value_getUnsignedInteger(rightValue)
+            : sysmelb_value_getInteger(leftValue) >= sysmelb_value_getInteger(rightValue));
     return result;
 }
 
@@ -703,10 +757,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsInteger(size_t argumentCount,
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.integer,
-        .integer = originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.integer, sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -714,10 +765,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsCharacter(size_t argumentCount
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.character,
-        .integer = originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.character, sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -725,10 +773,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsInt8(size_t argumentCount, sys
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.int8,
-        .integer = (int8_t)originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.int8, (int8_t)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -736,10 +781,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsInt16(size_t argumentCount, sy
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.int16,
-        .integer = (int16_t)originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.int16, (int16_t)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -747,10 +789,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsInt32(size_t argumentCount, sy
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.int32,
-        .integer = (int32_t)originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.int32, (int32_t)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -758,10 +797,7 @@ static sysmelb_Value_t sysmelb_primitive_integerAsInt64(size_t argumentCount, sy
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_BasicTypesData.int64,
-        .integer = (int64_t)originalValue.integer};
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_BasicTypesData.int64, (int64_t)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -769,10 +805,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsUInt8(size_t argumentCount, sy
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.uint8,
-        .unsignedInteger = (uint8_t)originalValue.unsignedInteger};
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_BasicTypesData.uint8, (uint8_t)sysmelb_value_getUnsignedInteger(originalValue));
     return result;
 }
 
@@ -780,10 +814,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsUInt16(size_t argumentCount, s
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.uint16,
-        .unsignedInteger = (uint16_t)originalValue.unsignedInteger};
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_BasicTypesData.uint16, (uint16_t)sysmelb_value_getUnsignedInteger(originalValue));
     return result;
 }
 
@@ -791,10 +823,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsUInt32(size_t argumentCount, s
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.uint32,
-        .unsignedInteger = (uint32_t)originalValue.unsignedInteger};
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_BasicTypesData.uint32, (uint32_t)sysmelb_value_getUnsignedInteger(originalValue));
     return result;
 }
 
@@ -802,10 +832,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsUInt64(size_t argumentCount, s
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.uint64,
-        .unsignedInteger = (uint64_t)originalValue.unsignedInteger};
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_BasicTypesData.uint64, (uint64_t)sysmelb_value_getUnsignedInteger(originalValue));
     return result;
 }
 
@@ -813,13 +841,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsFloat32(size_t argumentCount,
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindFloatingPoint,
-        .type = sysmelb_BasicTypesData.float32,
-        .floatingPoint = (originalValue.kind == SysmelValueKindUnsignedInteger)
-                             ? (float)originalValue.unsignedInteger
-                             : (float)originalValue.integer,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeFloatingPoint(
+        sysmelb_BasicTypesData.float32, (sysmelb_value_getKind(originalValue) == SysmelValueKindUnsignedInteger) ? (float)sysmelb_value_getUnsignedInteger(originalValue) : (float)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -827,13 +850,8 @@ static sysmelb_Value_t sysmelb_primitive_integerAsFloat64(size_t argumentCount,
 {
     assert(argumentCount == 1);
     sysmelb_Value_t originalValue = sysmelb_decayValue(arguments[0]);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindFloatingPoint,
-        .type = sysmelb_BasicTypesData.float64,
-        .floatingPoint = (originalValue.kind == SysmelValueKindUnsignedInteger)
-                             ? (double)originalValue.unsignedInteger
-                             : (double)originalValue.integer,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeFloatingPoint(
+        sysmelb_BasicTypesData.float64, (sysmelb_value_getKind(originalValue) == SysmelValueKindUnsignedInteger) ? (double)sysmelb_value_getUnsignedInteger(originalValue) : (double)sysmelb_value_getInteger(originalValue));
     return result;
 }
 
@@ -927,20 +945,17 @@ static void sysmelb_createBasicIntegersPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_stringEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindStringReference && arguments[1].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && sysmelb_value_getKind(arguments[1]) == SysmelValueKindStringReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindBoolean, sysmelb_getBasicTypes()->boolean);
 
-    if (arguments[0].stringSize == arguments[1].stringSize && memcmp(arguments[0].string, arguments[1].string, arguments[1].stringSize) == 0)
+    if (sysmelb_value_getStringSize(arguments[0]) == sysmelb_value_getStringSize(arguments[1]) && memcmp(sysmelb_value_getString(arguments[0]), sysmelb_value_getString(arguments[1]), sysmelb_value_getStringSize(arguments[1])) == 0)
     {
-        result.boolean = true;
+        sysmelb_value_setBoolean(&result, true);
     }
     else
     {
-        result.boolean = false;
+        sysmelb_value_setBoolean(&result, false);
     }
 
     return result;
@@ -949,20 +964,17 @@ static sysmelb_Value_t sysmelb_primitive_stringEquals(size_t argumentCount, sysm
 static sysmelb_Value_t sysmelb_primitive_stringNotEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindStringReference && arguments[1].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && sysmelb_value_getKind(arguments[1]) == SysmelValueKindStringReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindBoolean, sysmelb_getBasicTypes()->boolean);
 
-    if (arguments[0].stringSize == arguments[1].stringSize && memcmp(arguments[0].string, arguments[1].string, arguments[1].stringSize) == 0)
+    if (sysmelb_value_getStringSize(arguments[0]) == sysmelb_value_getStringSize(arguments[1]) && memcmp(sysmelb_value_getString(arguments[0]), sysmelb_value_getString(arguments[1]), sysmelb_value_getStringSize(arguments[1])) == 0)
     {
-        result.boolean = false;
+        sysmelb_value_setBoolean(&result, false);
     }
     else
     {
-        result.boolean = true;
+        sysmelb_value_setBoolean(&result, true);
     }
 
     return result;
@@ -971,63 +983,68 @@ static sysmelb_Value_t sysmelb_primitive_stringNotEquals(size_t argumentCount, s
 static sysmelb_Value_t sysmelb_primitive_concatenateString(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindStringReference && arguments[1].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && sysmelb_value_getKind(arguments[1]) == SysmelValueKindStringReference);
 
-    size_t stringSize = arguments[0].stringSize + arguments[1].stringSize;
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]) + sysmelb_value_getStringSize(arguments[1]);
     char *stringData = sysmelb_allocate(stringSize);
-    memcpy(stringData, arguments[0].string, arguments[0].stringSize);
-    memcpy(stringData + arguments[0].stringSize, arguments[1].string, arguments[1].stringSize);
+    memcpy(stringData, sysmelb_value_getString(arguments[0]), sysmelb_value_getStringSize(arguments[0]));
+    memcpy(stringData + sysmelb_value_getStringSize(arguments[0]), sysmelb_value_getString(arguments[1]), sysmelb_value_getStringSize(arguments[1]));
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindStringReference,
-        .type = sysmelb_getBasicTypes()->string,
-        .string = stringData,
-        .stringSize = stringSize};
+    sysmelb_Value_t result = sysmelb_value_makeString(stringSize, stringData);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_stringSize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
 
-    size_t stringSize = arguments[0].stringSize;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.integer,
-        .unsignedInteger = stringSize};
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(sysmelb_BasicTypesData.integer, stringSize);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_stringAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindStringReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
 
-    size_t stringSize = arguments[0].stringSize;
-    unsigned int stringIndex = arguments[1].unsignedInteger;
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    unsigned int stringIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(stringIndex < stringSize);
 
-    char element = arguments[0].string[stringIndex];
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindCharacter,
-        .type = sysmelb_getBasicTypes()->character,
-        .unsignedInteger = element};
+    char element = sysmelb_value_getString(arguments[0])[stringIndex];
+    sysmelb_Value_t result = sysmelb_value_makeCharacter(sysmelb_getBasicTypes()->character, element);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_stringAtPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindStringReference
-        && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger)
-        && (arguments[2].kind == SysmelValueKindInteger || arguments[2].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference
+        && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger)
+        && (sysmelb_value_getKind(arguments[2]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[2]) == SysmelValueKindUnsignedInteger));
+
+    if (sysmelb_value_isStringSlice(arguments[0]))
+    {
+        sysmelb_SourcePosition_t sourcePosition = {};
+        sysmelb_getCurrentInterpretedSourcePosition(&sourcePosition);
+        sysmelb_errorPrintf(sourcePosition, "Cannot modify a string slice, since it shares the storage of its parent string.");
+        abort();
+    }
+    if (sysmelb_memory_isShared(sysmelb_value_getString(arguments[0])))
+    {
+        sysmelb_SourcePosition_t sourcePosition = {};
+        sysmelb_getCurrentInterpretedSourcePosition(&sourcePosition);
+        sysmelb_errorPrintf(sourcePosition, "Cannot modify a string that has slices, since they share its storage.");
+        abort();
+    }
 
-    size_t stringSize = arguments[0].stringSize;
-    unsigned int stringIndex = arguments[1].unsignedInteger;
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    unsigned int stringIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(stringIndex < stringSize);
 
-    arguments[0].string[stringIndex] = (char)arguments[2].integer;
+    sysmelb_value_getString(arguments[0])[stringIndex] = (char)sysmelb_value_getInteger(arguments[2]);
 
     return arguments[2];
 }
@@ -1035,74 +1052,101 @@ static sysmelb_Value_t sysmelb_primitive_stringAtPut(size_t argumentCount, sysme
 static sysmelb_Value_t sysmelb_primitive_substringFromUntil(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindStringReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger) && (arguments[2].kind == SysmelValueKindInteger || arguments[2].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger) && (sysmelb_value_getKind(arguments[2]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[2]) == SysmelValueKindUnsignedInteger));
 
-    size_t stringSize = arguments[0].stringSize;
-    unsigned int startIndex = arguments[1].unsignedInteger;
-    unsigned int endIndex = arguments[2].unsignedInteger;
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    unsigned int startIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
+    unsigned int endIndex = sysmelb_value_getUnsignedInteger(arguments[2]);
     assert(startIndex < stringSize);
     assert(endIndex <= stringSize);
 
     unsigned int substringSize = endIndex - startIndex;
     char *substring = sysmelb_allocate(substringSize);
-    memcpy(substring, arguments[0].string + startIndex, substringSize);
+    memcpy(substring, sysmelb_value_getString(arguments[0]) + startIndex, substringSize);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindStringReference,
-        .type = sysmelb_getBasicTypes()->string,
-        .string = substring,
-        .stringSize = substringSize,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeString(substringSize, substring);
+    return result;
+}
+
+// A slice shares the storage of its parent string instead of copying it. The
+// slice cannot be modified, and neither can the parent once it has been
+// sliced, so this is meant for immutable text such as the source code read by
+// a scanner. Byte arrays keep their elements inline after their header, so
+// they cannot be sliced without an extra indirection on every access.
+static sysmelb_Value_t sysmelb_primitive_sliceFromUntil(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 3);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger) && (sysmelb_value_getKind(arguments[2]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[2]) == SysmelValueKindUnsignedInteger));
+
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    unsigned int startIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
+    unsigned int endIndex = sysmelb_value_getUnsignedInteger(arguments[2]);
+    assert(startIndex < stringSize);
+    assert(endIndex <= stringSize);
+
+    // An empty slice keeps pointing at the start of its parent, so that it
+    // never refers past the end of its allocation.
+    unsigned int sliceSize = endIndex - startIndex;
+    char *sliceString = sysmelb_value_getString(arguments[0]) + (sliceSize ? startIndex : 0);
+    if (!sysmelb_memory_markShared(sysmelb_value_getString(arguments[0])))
+    {
+        // Strings outside of the collected heap cannot be marked as shared, so
+        // their slices get a copy instead.
+        sliceString = sysmelb_allocate(sliceSize);
+        memcpy(sliceString, sysmelb_value_getString(arguments[0]) + startIndex, sliceSize);
+    }
+
+    sysmelb_Value_t result = sysmelb_value_makeStringSlice(sliceSize, sliceString);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_stringAsFloat(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
 
-    size_t stringSize = arguments[0].stringSize;
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
     char *cstring = calloc(stringSize, 1);
-    memcpy(cstring, arguments[0].string, stringSize);
+    memcpy(cstring, sysmelb_value_getString(arguments[0]), stringSize);
     double floatValue = atof(cstring);
     free(cstring);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindFloatingPoint,
-        .type = sysmelb_BasicTypesData.integer,
-        .floatingPoint = floatValue};
+    sysmelb_Value_t result = sysmelb_value_makeFloatingPoint(sysmelb_BasicTypesData.integer, floatValue);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_stringAsSymbol(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
 
-    sysmelb_symbol_t *internedString = sysmelb_internSymbol(arguments[0].stringSize, arguments[0].string);
+    sysmelb_symbol_t *internedString = sysmelb_internSymbol(sysmelb_value_getStringSize(arguments[0]), sysmelb_value_getString(arguments[0]));
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindSymbolReference,
-        .type = sysmelb_BasicTypesData.symbol,
-        .symbolReference = internedString};
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindSymbolReference, sysmelb_BasicTypesData.symbol, internedString);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_parseCEscapeSequences(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindStringReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringReference);
+
+    // A slice cannot be modified, so it can be returned as is when there is
+    // nothing to unescape. Any other string is copied, as it could be modified
+    // through either value.
+    size_t stringSize = sysmelb_value_getStringSize(arguments[0]);
+    if (sysmelb_value_isStringSlice(arguments[0]) && !memchr(sysmelb_value_getString(arguments[0]), '\\', stringSize))
+        return arguments[0];
 
-    size_t stringSize = arguments[0].stringSize;
     char *parsedString = sysmelb_allocate(stringSize);
     size_t parsedStringSize = 0;
 
     for (size_t i = 0; i < stringSize; ++i)
     {
-        char c = arguments[0].string[i];
+        char c = sysmelb_value_getString(arguments[0])[i];
         if (c == '\\' && i + 1 < stringSize)
         {
-            char escape = arguments[0].string[++i];
+            char escape = sysmelb_value_getString(arguments[0])[++i];
             char resultingChar = escape;
             switch (escape)
             {
@@ -1128,12 +1172,7 @@ static sysmelb_Value_t sysmelb_primitive_parseCEscapeSequences(size_t argumentCo
         }
     }
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindStringReference,
-        .type = sysmelb_getBasicTypes()->string,
-        .string = parsedString,
-        .stringSize = parsedStringSize,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeString(parsedStringSize, parsedString);
     return result;
 }
 
@@ -1147,6 +1186,7 @@ static void sysmelb_createBasicStringPrimitives(void)
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("at:"), sysmelb_primitive_stringAt);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("at:put:"), sysmelb_primitive_stringAtPut);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("substringFrom:until:"), sysmelb_primitive_substringFromUntil);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("sliceFrom:until:"), sysmelb_primitive_sliceFromUntil);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("asFloat"), sysmelb_primitive_stringAsFloat);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("asSymbol"), sysmelb_primitive_stringAsSymbol);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.string, sysmelb_internSymbolC("parseCEscapeSequences"), sysmelb_primitive_parseCEscapeSequences);
@@ -1155,155 +1195,156 @@ static void sysmelb_createBasicStringPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_symbolIdentityEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindSymbolReference);
-    assert(arguments[1].kind == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindSymbolReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].symbolReference == arguments[1].symbolReference};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        sysmelb_value_getReference(arguments[0], symbol) == sysmelb_value_getReference(arguments[1], symbol));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_symbolIdentityNotEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindSymbolReference);
-    assert(arguments[1].kind == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindSymbolReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].symbolReference != arguments[1].symbolReference};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        sysmelb_value_getReference(arguments[0], symbol) != sysmelb_value_getReference(arguments[1], symbol));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_symbolWithoutTrailingColon(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolReference);
 
     sysmelb_Value_t result = arguments[0];
-    if(arguments[0].symbolReference->string[arguments[0].symbolReference->size - 1] == ':')
-        result.symbolReference = sysmelb_internSymbol(arguments[0].symbolReference->size - 1, arguments[0].symbolReference->string);
+    sysmelb_value_setPayload(&result, (uintptr_t)sysmelb_symbolWithoutTrailingColon(sysmelb_value_getReference(arguments[0], symbol)));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_symbolHash(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .unsignedInteger = arguments[0].symbolReference->hash,
-        .type = sysmelb_getBasicTypes()->integer
-    };
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], symbol)->hash);
     return result;
 }
 
+static sysmelb_Value_t sysmelb_primitive_symbolID(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolReference);
+
+    return sysmelb_value_makeInteger(sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], symbol)->id);
+}
+
 static void sysmelb_createBasicSymbolPrimitives(void)
 {
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbol, sysmelb_internSymbolC("=="), sysmelb_primitive_symbolIdentityEquals);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbol, sysmelb_internSymbolC("~~"), sysmelb_primitive_symbolIdentityNotEquals);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbol, sysmelb_internSymbolC("withoutTrailingColon"), sysmelb_primitive_symbolWithoutTrailingColon);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbol, sysmelb_internSymbolC("hash"), sysmelb_primitive_symbolHash);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbol, sysmelb_internSymbolC("id"), sysmelb_primitive_symbolID);
 }
 
 static sysmelb_Value_t sysmelb_primitive_concatenateArrays(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindArrayReference && arguments[1].kind == SysmelValueKindArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference && sysmelb_value_getKind(arguments[1]) == SysmelValueKindArrayReference);
 
-    size_t arraySize = arguments[0].arrayReference->size + arguments[1].arrayReference->size;
+    size_t arraySize = sysmelb_value_getReference(arguments[0], array)->size + sysmelb_value_getReference(arguments[1], array)->size;
     sysmelb_ArrayHeader_t *arrayData = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + sizeof(sysmelb_Value_t) * arraySize);
     arrayData->size = arraySize;
 
-    memcpy(arrayData->elements, arguments[0].arrayReference->elements, arguments[0].arrayReference->size * sizeof(sysmelb_Value_t));
-    memcpy(arrayData->elements + arguments[0].arrayReference->size, arguments[1].arrayReference->elements, arguments[1].arrayReference->size * sizeof(sysmelb_Value_t));
+    memcpy(arrayData->elements, sysmelb_value_getReference(arguments[0], array)->elements, sysmelb_value_getReference(arguments[0], array)->size * sizeof(sysmelb_Value_t));
+    memcpy(arrayData->elements + sysmelb_value_getReference(arguments[0], array)->size, sysmelb_value_getReference(arguments[1], array)->elements, sysmelb_value_getReference(arguments[1], array)->size * sizeof(sysmelb_Value_t));
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindArrayReference,
-        .type = sysmelb_getBasicTypes()->array,
-        .arrayReference = arrayData};
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, arrayData);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_arraySize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference);
 
-    size_t arraySize = arguments[0].arrayReference->size;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.integer,
-        .unsignedInteger = arraySize,
-    };
+    size_t arraySize = sysmelb_value_getReference(arguments[0], array)->size;
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(sysmelb_BasicTypesData.integer, arraySize);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_arrayAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindArrayReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
 
-    size_t arraySize = arguments[0].arrayReference->size;
-    unsigned int arrayIndex = arguments[1].unsignedInteger;
+    size_t arraySize = sysmelb_value_getReference(arguments[0], array)->size;
+    unsigned int arrayIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(arrayIndex < arraySize);
 
-    sysmelb_Value_t result = arguments[0].arrayReference->elements[arrayIndex];
+    sysmelb_Value_t result = sysmelb_value_getReference(arguments[0], array)->elements[arrayIndex];
     return result;
 }
 
+static void sysmelb_checkLiteralMutation(bool isLiteral)
+{
+    if(!isLiteral)
+        return;
+
+    sysmelb_SourcePosition_t sourcePosition = {};
+    sysmelb_getCurrentInterpretedSourcePosition(&sourcePosition);
+    sysmelb_errorPrintf(sourcePosition, "Cannot modify a literal.");
+    abort();
+}
+
 static sysmelb_Value_t sysmelb_primitive_arrayAtPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindArrayReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
+    sysmelb_checkLiteralMutation(sysmelb_value_getReference(arguments[0], array)->isLiteral);
 
-    size_t arraySize = arguments[0].arrayReference->size;
-    unsigned int arrayIndex = arguments[1].unsignedInteger;
+    size_t arraySize = sysmelb_value_getReference(arguments[0], array)->size;
+    unsigned int arrayIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(arrayIndex < arraySize);
 
-    sysmelb_Value_t result = arguments[0].arrayReference->elements[arrayIndex] = arguments[2];
+    sysmelb_Value_t result = sysmelb_value_getReference(arguments[0], array)->elements[arrayIndex] = arguments[2];
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_arrayAsTuple(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference);
 
-    sysmelb_ArrayHeader_t *array = arguments[0].arrayReference;
+    sysmelb_ArrayHeader_t *array = sysmelb_value_getReference(arguments[0], array);
     size_t arraySize = array->size;
     sysmelb_TupleHeader_t *tuple = sysmelb_allocate(sizeof(sysmelb_TupleHeader_t) + sizeof(sysmelb_Value_t) * arraySize);
     tuple->size = arraySize;
     for (size_t i = 0; i < arraySize; ++i)
         tuple->elements[i] = array->elements[i];
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTupleReference,
-        .tupleReference = tuple,
-        .type = sysmelb_getBasicTypes()->tuple};
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTupleReference, sysmelb_getBasicTypes()->tuple, tuple);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_arrayAsImmutableDictionary(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindArrayReference);
 
-    sysmelb_ArrayHeader_t *array = arguments[0].arrayReference;
+    sysmelb_ArrayHeader_t *array = sysmelb_value_getReference(arguments[0], array);
     size_t arraySize = array->size;
     sysmelb_ImmutableDictionary_t *dictionary = sysmelb_allocate(sizeof(sysmelb_ImmutableDictionary_t) + sizeof(sysmelb_Association_t *)*arraySize);
     dictionary->size = arraySize;
     for (size_t i = 0; i < arraySize; ++i)
-        dictionary->elements[i] = array->elements[i].associationReference;
+        dictionary->elements[i] = sysmelb_value_getReference(array->elements[i], association);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindImmutableDictionaryReference,
-        .immutableDictionaryReference = dictionary,
-        .type = sysmelb_getBasicTypes()->immutableDictionary};
+    sysmelb_Value_t result = sysmelb_value_makeReference(
+        SysmelValueKindImmutableDictionaryReference, sysmelb_getBasicTypes()->immutableDictionary, dictionary);
     return result;
 }
 
@@ -1320,44 +1361,38 @@ static void sysmelb_createBasicArrayPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_byteArraySize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindByteArrayReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteArrayReference);
 
-    size_t arraySize = arguments[0].byteArrayReference->size;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.integer,
-        .unsignedInteger = arraySize,
-    };
+    size_t arraySize = sysmelb_value_getReference(arguments[0], byteArray)->size;
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(sysmelb_BasicTypesData.integer, arraySize);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_byteArrayAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindByteArrayReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteArrayReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
 
-    size_t arraySize = arguments[0].byteArrayReference->size;
-    unsigned int arrayIndex = arguments[1].unsignedInteger;
+    size_t arraySize = sysmelb_value_getReference(arguments[0], byteArray)->size;
+    unsigned int arrayIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(arrayIndex < arraySize);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_getBasicTypes()->uint8,
-        .integer = arguments[0].byteArrayReference->elements[arrayIndex],
-    };
+    sysmelb_Value_t result = sysmelb_value_makeInteger(
+        sysmelb_getBasicTypes()->uint8, sysmelb_value_getReference(arguments[0], byteArray)->elements[arrayIndex]);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_byteArrayAtPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindByteArrayReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteArrayReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
+    sysmelb_checkLiteralMutation(sysmelb_value_getReference(arguments[0], byteArray)->isLiteral);
 
-    size_t arraySize = arguments[0].byteArrayReference->size;
-    unsigned int arrayIndex = arguments[1].unsignedInteger;
+    size_t arraySize = sysmelb_value_getReference(arguments[0], byteArray)->size;
+    unsigned int arrayIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(arrayIndex < arraySize);
 
-    arguments[0].byteArrayReference->elements[arrayIndex] = arguments[2].integer;
+    sysmelb_value_getReference(arguments[0], byteArray)->elements[arrayIndex] = sysmelb_value_getInteger(arguments[2]);
     return arguments[2];
 }
 
@@ -1371,41 +1406,39 @@ static void sysmelb_createBasicByteArrayPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_tupleSize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindTupleReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTupleReference);
 
-    size_t tupleSize = arguments[0].tupleReference->size;
+    size_t tupleSize = sysmelb_value_getReference(arguments[0], tuple)->size;
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_BasicTypesData.integer,
-        .unsignedInteger = tupleSize};
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(sysmelb_BasicTypesData.integer, tupleSize);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_tupleAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindTupleReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTupleReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
 
-    size_t tupleSize = arguments[0].tupleReference->size;
-    unsigned int tupleIndex = arguments[1].unsignedInteger;
+    size_t tupleSize = sysmelb_value_getReference(arguments[0], tuple)->size;
+    unsigned int tupleIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(tupleIndex < tupleSize);
 
-    sysmelb_Value_t result = arguments[0].tupleReference->elements[tupleIndex];
+    sysmelb_Value_t result = sysmelb_value_getReference(arguments[0], tuple)->elements[tupleIndex];
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_tupleAtPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindTupleReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTupleReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
+    sysmelb_checkLiteralMutation(sysmelb_value_getReference(arguments[0], tuple)->isLiteral);
 
-    size_t tupleSize = arguments[0].tupleReference->size;
-    unsigned int tupleIndex = arguments[1].unsignedInteger;
+    size_t tupleSize = sysmelb_value_getReference(arguments[0], tuple)->size;
+    unsigned int tupleIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(tupleIndex < tupleSize);
 
     sysmelb_Value_t result = arguments[2];
-    arguments[0].tupleReference->elements[tupleIndex] = result;
+    sysmelb_value_getReference(arguments[0], tuple)->elements[tupleIndex] = result;
     return result;
 }
 
@@ -1419,16 +1452,16 @@ static void sysmelb_createBasicTuplePrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_associationKey(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindAssociationReference);
-    sysmelb_Value_t result = arguments[0].associationReference->key;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindAssociationReference);
+    sysmelb_Value_t result = sysmelb_value_getReference(arguments[0], association)->key;
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_associationValue(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindAssociationReference);
-    sysmelb_Value_t result = arguments[0].associationReference->value;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindAssociationReference);
+    sysmelb_Value_t result = sysmelb_value_getReference(arguments[0], association)->value;
     return result;
 }
 
@@ -1441,68 +1474,56 @@ static void sysmelb_createBasicAssociationPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_dictionaryAssocAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindImmutableDictionaryReference && (arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger));
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference && (sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger));
 
-    size_t dictionarySize = arguments[0].immutableDictionaryReference->size;
-    unsigned int dictionaryIndex = arguments[1].unsignedInteger;
+    size_t dictionarySize = sysmelb_value_getReference(arguments[0], immutableDictionary)->size;
+    unsigned int dictionaryIndex = sysmelb_value_getUnsignedInteger(arguments[1]);
     assert(dictionaryIndex < dictionarySize);
 
-    sysmelb_Association_t *assoc = arguments[0].immutableDictionaryReference->elements[dictionaryIndex];
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindAssociationReference,
-        .type = sysmelb_getBasicTypes()->association,
-        .associationReference = assoc};
+    sysmelb_Association_t *assoc = sysmelb_value_getReference(arguments[0], immutableDictionary)->elements[dictionaryIndex];
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindAssociationReference, sysmelb_getBasicTypes()->association, assoc);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_dictionarySize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindImmutableDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference);
 
-    size_t dictionarySize = arguments[0].immutableDictionaryReference->size;
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_getBasicTypes()->integer,
-        .unsignedInteger = dictionarySize};
+    size_t dictionarySize = sysmelb_value_getReference(arguments[0], immutableDictionary)->size;
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(sysmelb_getBasicTypes()->integer, dictionarySize);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_dictionaryIncludesKey(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindImmutableDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference);
 
-    size_t dictionarySize = arguments[0].immutableDictionaryReference->size;
+    size_t dictionarySize = sysmelb_value_getReference(arguments[0], immutableDictionary)->size;
     for (size_t i = 0; i < dictionarySize; ++i)
     {
-        sysmelb_Association_t *assoc = arguments[0].immutableDictionaryReference->elements[i];
+        sysmelb_Association_t *assoc = sysmelb_value_getReference(arguments[0], immutableDictionary)->elements[i];
         if (sysmelb_value_equals(arguments[1], assoc->key))
         {
-            sysmelb_Value_t result = {
-                .kind = SysmelValueKindBoolean,
-                .type = sysmelb_getBasicTypes()->boolean,
-                .boolean = true};
+            sysmelb_Value_t result = sysmelb_value_makeBoolean(true);
             return result;
         }
     }
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = false};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(false);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_dictionaryAt(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindImmutableDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindImmutableDictionaryReference);
 
-    size_t dictionarySize = arguments[0].immutableDictionaryReference->size;
+    size_t dictionarySize = sysmelb_value_getReference(arguments[0], immutableDictionary)->size;
     for (size_t i = 0; i < dictionarySize; ++i)
     {
-        sysmelb_Association_t *assoc = arguments[0].immutableDictionaryReference->elements[i];
+        sysmelb_Association_t *assoc = sysmelb_value_getReference(arguments[0], immutableDictionary)->elements[i];
         if (sysmelb_value_equals(arguments[1], assoc->key))
             return assoc->value;
     }
@@ -1515,15 +1536,16 @@ static sysmelb_Value_t sysmelb_primitive_dictionaryAt(size_t argumentCount, sysm
 static sysmelb_Value_t sysmelb_primitive_withSelectorAddMethod(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindTypeReference);
-    assert(arguments[1].kind == SysmelValueKindSymbolReference);
-    assert(arguments[2].kind == SysmelValueKindFunctionReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTypeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[2]) == SysmelValueKindFunctionReference);
 
-    sysmelb_Type_t *type = arguments[0].typeReference;
-    sysmelb_symbol_t *selector = arguments[1].symbolReference;
-    sysmelb_function_t *function = arguments[2].functionReference;
+    sysmelb_Type_t *type = sysmelb_value_getReference(arguments[0], type);
+    sysmelb_symbol_t *selector = sysmelb_value_getReference(arguments[1], symbol);
+    sysmelb_function_t *function = sysmelb_value_getReference(arguments[2], function);
 
     sysmelb_SymbolHashtable_addSymbolWithValue(&type->methodDict, selector, function);
+    sysmelb_methodCache_invalidateSelector(selector);
     return arguments[0];
 }
 
@@ -1538,56 +1560,42 @@ static void sysmelb_createBasicImmutableDictionaryPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_newWithSize(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindTypeReference);
-    assert(arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTypeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
 
 
-    if(arguments[0].typeReference->kind == SysmelTypeKindArray)
+    if(sysmelb_value_getReference(arguments[0], type)->kind == SysmelTypeKindArray)
     {
-        size_t arraySize = arguments[1].integer;
+        size_t arraySize = sysmelb_value_getInteger(arguments[1]);
         sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + sizeof(sysmelb_Value_t) * arraySize);
         array->size = arraySize;
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindArrayReference,
-            .type = sysmelb_getBasicTypes()->array,
-            .arrayReference = array};
+        sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, array);
         return result;
     }
 
-    if(arguments[0].typeReference->kind == SysmelTypeKindByteArray)
+    if(sysmelb_value_getReference(arguments[0], type)->kind == SysmelTypeKindByteArray)
     {
-        size_t byteArraySize = arguments[1].integer;
+        size_t byteArraySize = sysmelb_value_getInteger(arguments[1]);
         sysmelb_ByteArrayHeader_t *byteArray = sysmelb_allocate(sizeof(sysmelb_ByteArrayHeader_t) + byteArraySize);
         byteArray->size = byteArraySize;
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindByteArrayReference,
-            .type = sysmelb_getBasicTypes()->byteArray,
-            .byteArrayReference = byteArray};
+        sysmelb_Value_t result = sysmelb_value_makeReference(
+            SysmelValueKindByteArrayReference, sysmelb_getBasicTypes()->byteArray, byteArray);
         return result;
     }
 
-    if(arguments[0].typeReference->kind == SysmelTypeKindTuple)
+    if(sysmelb_value_getReference(arguments[0], type)->kind == SysmelTypeKindTuple)
     {
-        size_t tupleSize = arguments[1].integer;
+        size_t tupleSize = sysmelb_value_getInteger(arguments[1]);
         sysmelb_TupleHeader_t *tuple = sysmelb_allocate(sizeof(sysmelb_TupleHeader_t) + sizeof(sysmelb_Value_t) * tupleSize);
         tuple->size = tupleSize;
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindTupleReference,
-            .type = sysmelb_getBasicTypes()->tuple,
-            .tupleReference = tuple
-        };
+        sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTupleReference, sysmelb_getBasicTypes()->tuple, tuple);
         return result;
     }
-    if(arguments[0].typeReference->kind == SysmelTypeKindString)
+    if(sysmelb_value_getReference(arguments[0], type)->kind == SysmelTypeKindString)
     {
-        size_t stringSize = arguments[1].integer;
+        size_t stringSize = sysmelb_value_getInteger(arguments[1]);
         char *stringData = sysmelb_allocate(stringSize);
-        sysmelb_Value_t result = {
-            .kind = SysmelValueKindTupleReference,
-            .type = sysmelb_getBasicTypes()->string,
-            .stringSize = stringSize,
-            .string = stringData
-        };
+        sysmelb_Value_t result = sysmelb_value_makeString(stringSize, stringData);
         return result;
     }
 
@@ -1599,16 +1607,12 @@ static sysmelb_Value_t sysmelb_primitive_newWithSize(size_t argumentCount, sysme
 static sysmelb_Value_t sysmelb_primitive_fixedArrayType(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindTypeReference);
-    assert(arguments[1].kind == SysmelValueKindInteger || arguments[1].kind == SysmelValueKindUnsignedInteger);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindTypeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger || sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
 
-    sysmelb_Type_t *fixedArrayType = sysmelb_allocateFixedArrayType(arguments[0].typeReference, arguments[1].integer);
+    sysmelb_Type_t *fixedArrayType = sysmelb_allocateFixedArrayType(sysmelb_value_getReference(arguments[0], type), sysmelb_value_getInteger(arguments[1]));
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = fixedArrayType
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, fixedArrayType);
     return result;
 }
 
@@ -1622,31 +1626,28 @@ static void sysmelb_createBasicTypeUniversePrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_OrderedCollection_add(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindOrderedCollectionReference);
-    sysmelb_OrderedCollection_add(arguments[0].orderedCollectionReference, arguments[1]);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindOrderedCollectionReference);
+    sysmelb_OrderedCollection_add(sysmelb_value_getReference(arguments[0], orderedCollection), arguments[1]);
     return arguments[1];
 }
 
 static sysmelb_Value_t sysmelb_primitive_OrderedCollection_size(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindOrderedCollectionReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_getBasicTypes()->integer,
-        .unsignedInteger = arguments[0].orderedCollectionReference->size,
-    };
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindOrderedCollectionReference);
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], orderedCollection)->size);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_OrderedCollection_at(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindOrderedCollectionReference);
-    assert(arguments[1].kind == SysmelValueKindInteger ||
-           arguments[1].kind == SysmelValueKindUnsignedInteger);
-    size_t size = arguments[0].orderedCollectionReference->size;
-    size_t index = arguments[1].unsignedInteger;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    size_t size = sysmelb_value_getReference(arguments[0], orderedCollection)->size;
+    size_t index = sysmelb_value_getUnsignedInteger(arguments[1]);
     if (index >= size)
     {
         sysmelb_SourcePosition_t pos = {};
@@ -1654,17 +1655,17 @@ static sysmelb_Value_t sysmelb_primitive_OrderedCollection_at(size_t argumentCou
         abort();
     }
 
-    return arguments[0].orderedCollectionReference->elements[index];
+    return sysmelb_value_getReference(arguments[0], orderedCollection)->elements[index];
 }
 
 static sysmelb_Value_t sysmelb_primitive_OrderedCollection_atPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindOrderedCollectionReference);
-    assert(arguments[1].kind == SysmelValueKindInteger ||
-           arguments[1].kind == SysmelValueKindUnsignedInteger);
-    size_t size = arguments[0].orderedCollectionReference->size;
-    size_t index = arguments[1].unsignedInteger;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    size_t size = sysmelb_value_getReference(arguments[0], orderedCollection)->size;
+    size_t index = sysmelb_value_getUnsignedInteger(arguments[1]);
     if (index >= size)
     {
         sysmelb_SourcePosition_t pos = {};
@@ -1672,24 +1673,21 @@ static sysmelb_Value_t sysmelb_primitive_OrderedCollection_atPut(size_t argument
         abort();
     }
 
-    return arguments[0].orderedCollectionReference->elements[index] = arguments[2];
+    return sysmelb_value_getReference(arguments[0], orderedCollection)->elements[index] = arguments[2];
 }
 
 static sysmelb_Value_t sysmelb_primitive_OrderedCollection_asArray(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindOrderedCollectionReference);
 
-    size_t dataSize = arguments[0].orderedCollectionReference->size;
+    size_t dataSize = sysmelb_value_getReference(arguments[0], orderedCollection)->size;
     sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + dataSize * sizeof(sysmelb_Value_t));
     array->size = dataSize;
     for (size_t i = 0; i < dataSize; ++i)
-        array->elements[i] = arguments[0].orderedCollectionReference->elements[i];
+        array->elements[i] = sysmelb_value_getReference(arguments[0], orderedCollection)->elements[i];
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindArrayReference,
-        .type = sysmelb_getBasicTypes()->array,
-        .arrayReference = array};
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, array);
     return result;
 }
 
@@ -1705,41 +1703,38 @@ static void sysmelb_createBasicOrderedCollectionPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_add(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
-    sysmelb_ByteOrderedCollection_add(arguments[0].byteOrderedCollectionReference, arguments[1].integer);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
+    sysmelb_ByteOrderedCollection_add(sysmelb_value_getReference(arguments[0], byteOrderedCollection), sysmelb_value_getInteger(arguments[1]));
     return arguments[1];
 }
 
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_addAll(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
-    assert(arguments[1].kind == SysmelValueKindByteArrayReference);
-    for(size_t i = 0; i < arguments[1].byteArrayReference->size; ++i)
-        sysmelb_ByteOrderedCollection_add(arguments[0].byteOrderedCollectionReference, arguments[1].byteArrayReference->elements[i]);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindByteArrayReference);
+    for(size_t i = 0; i < sysmelb_value_getReference(arguments[1], byteArray)->size; ++i)
+        sysmelb_ByteOrderedCollection_add(sysmelb_value_getReference(arguments[0], byteOrderedCollection), sysmelb_value_getReference(arguments[1], byteArray)->elements[i]);
     return arguments[1];
 }
 
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_size(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_getBasicTypes()->integer,
-        .unsignedInteger = arguments[0].byteOrderedCollectionReference->size,
-    };
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], byteOrderedCollection)->size);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_at(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
-    assert(arguments[1].kind == SysmelValueKindInteger ||
-           arguments[1].kind == SysmelValueKindUnsignedInteger);
-    size_t size = arguments[0].byteOrderedCollectionReference->size;
-    size_t index = arguments[1].unsignedInteger;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    size_t size = sysmelb_value_getReference(arguments[0], byteOrderedCollection)->size;
+    size_t index = sysmelb_value_getUnsignedInteger(arguments[1]);
     if (index >= size)
     {
         sysmelb_SourcePosition_t pos = {};
@@ -1747,23 +1742,19 @@ static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_at(size_t argumen
         abort();
     }
 
-    uint8_t byte = arguments[0].byteOrderedCollectionReference->elements[index];
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindInteger,
-        .type = sysmelb_getBasicTypes()->integer,
-        .integer = byte,
-    };
+    uint8_t byte = sysmelb_value_getReference(arguments[0], byteOrderedCollection)->elements[index];
+    sysmelb_Value_t result = sysmelb_value_makeInteger(sysmelb_getBasicTypes()->integer, byte);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_atPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
-    assert(arguments[1].kind == SysmelValueKindInteger ||
-           arguments[1].kind == SysmelValueKindUnsignedInteger);
-    size_t size = arguments[0].byteOrderedCollectionReference->size;
-    size_t index = arguments[1].unsignedInteger;
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    size_t size = sysmelb_value_getReference(arguments[0], byteOrderedCollection)->size;
+    size_t index = sysmelb_value_getUnsignedInteger(arguments[1]);
     if (index >= size)
     {
         sysmelb_SourcePosition_t pos = {};
@@ -1771,30 +1762,23 @@ static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_atPut(size_t argu
         abort();
     }
 
-    arguments[0].byteOrderedCollectionReference->elements[index] = arguments[2].integer;
+    sysmelb_value_getReference(arguments[0], byteOrderedCollection)->elements[index] = sysmelb_value_getInteger(arguments[2]);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindVoid,
-        .type = sysmelb_getBasicTypes()->voidType,
-    };
+    sysmelb_Value_t result = sysmelb_value_makeImmediate(SysmelValueKindVoid, sysmelb_getBasicTypes()->voidType);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_ByteOrderedCollection_asByteArray(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindByteOrderedCollectionReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindByteOrderedCollectionReference);
 
-    size_t dataSize = arguments[0].byteOrderedCollectionReference->size;
+    size_t dataSize = sysmelb_value_getReference(arguments[0], byteOrderedCollection)->size;
     sysmelb_ByteArrayHeader_t *byteArray = sysmelb_allocate(sizeof(sysmelb_ByteArrayHeader_t) + dataSize);
     byteArray->size = dataSize;
-    memcpy(byteArray->elements, arguments[0].byteOrderedCollectionReference->elements, dataSize);
+    memcpy(byteArray->elements, sysmelb_value_getReference(arguments[0], byteOrderedCollection)->elements, dataSize);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindByteArrayReference,
-        .type = sysmelb_getBasicTypes()->byteArray,
-        .byteArrayReference = byteArray
-    };
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindByteArrayReference, sysmelb_getBasicTypes()->byteArray, byteArray);
     return result;
 }
 
@@ -1808,28 +1792,161 @@ static void sysmelb_createBasicByteOrderedCollectionPrimitives(void)
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.byteOrderedCollection, sysmelb_internSymbolC("asByteArray"), sysmelb_primitive_ByteOrderedCollection_asByteArray);
 }
 
+static sysmelb_Value_t sysmelb_primitive_StringBuilder_add(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringBuilderReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindCharacter ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    sysmelb_StringBuilder_addCharacter(sysmelb_value_getReference(arguments[0], stringBuilder), (char)sysmelb_value_getUnsignedInteger(arguments[1]));
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_StringBuilder_addAll(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringBuilderReference);
+    switch (sysmelb_value_getKind(arguments[1]))
+    {
+    case SysmelValueKindStringReference:
+        sysmelb_StringBuilder_addString(sysmelb_value_getReference(arguments[0], stringBuilder), sysmelb_value_getStringSize(arguments[1]), sysmelb_value_getString(arguments[1]));
+        break;
+    case SysmelValueKindSymbolReference:
+        sysmelb_StringBuilder_addString(sysmelb_value_getReference(arguments[0], stringBuilder), sysmelb_value_getReference(arguments[1], symbol)->size, sysmelb_value_getReference(arguments[1], symbol)->string);
+        break;
+    case SysmelValueKindStringBuilderReference:
+        sysmelb_StringBuilder_addString(sysmelb_value_getReference(arguments[0], stringBuilder), sysmelb_value_getReference(arguments[1], stringBuilder)->size, sysmelb_value_getReference(arguments[1], stringBuilder)->data);
+        break;
+    default:
+        abort();
+    }
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_StringBuilder_size(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringBuilderReference);
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], stringBuilder)->size);
+    return result;
+}
+
+static sysmelb_Value_t sysmelb_primitive_StringBuilder_at(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringBuilderReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindInteger ||
+           sysmelb_value_getKind(arguments[1]) == SysmelValueKindUnsignedInteger);
+    size_t size = sysmelb_value_getReference(arguments[0], stringBuilder)->size;
+    size_t index = sysmelb_value_getUnsignedInteger(arguments[1]);
+    if (index >= size)
+    {
+        sysmelb_SourcePosition_t pos = {};
+        sysmelb_errorPrintf(pos, "Index %d is out of bounds (size %d).\n", (int)index, (int)size);
+        abort();
+    }
+
+    sysmelb_Value_t result = sysmelb_value_makeCharacter(
+        sysmelb_getBasicTypes()->character, sysmelb_value_getReference(arguments[0], stringBuilder)->data[index]);
+    return result;
+}
+
+static sysmelb_Value_t sysmelb_primitive_StringBuilder_asString(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindStringBuilderReference);
+    return sysmelb_StringBuilder_asString(sysmelb_value_getReference(arguments[0], stringBuilder));
+}
+
+static void sysmelb_createBasicStringBuilderPrimitives(void)
+{
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("add:"),     sysmelb_primitive_StringBuilder_add);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("addAll:"),  sysmelb_primitive_StringBuilder_addAll);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("--"),       sysmelb_primitive_StringBuilder_addAll);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("size"),     sysmelb_primitive_StringBuilder_size);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("at:"),      sysmelb_primitive_StringBuilder_at);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.stringBuilder, sysmelb_internSymbolC("asString"), sysmelb_primitive_StringBuilder_asString);
+}
+
+static sysmelb_Value_t sysmelb_makeArrayValue(sysmelb_ArrayHeader_t *array)
+{
+    sysmelb_Value_t result = sysmelb_value_makeReference(SysmelValueKindArrayReference, sysmelb_getBasicTypes()->array, array);
+    return result;
+}
+
+// Identity collections keep raw object pointers, without their types.
+static sysmelb_Value_t sysmelb_makeObjectValueFromPointer(void *pointer)
+{
+    sysmelb_ObjectHeader_t *objectPointer = pointer;
+    sysmelb_Value_t resultValue = sysmelb_value_makeReference(SysmelValueKindObjectReference, objectPointer->clazz, objectPointer);
+    return resultValue;
+}
+
+// The iteration primitives of the hashed collections copy the elements into
+// an array with a single walk of the storage, and then call the block for
+// them, so that the block can modify the collection.
+static void sysmelb_callBlockForEachElement(sysmelb_Value_t block, sysmelb_ArrayHeader_t *elements, size_t elementsPerCall)
+{
+    if (sysmelb_value_getKind(block) != SysmelValueKindFunctionReference)
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Expected a block for iterating a collection.");
+        abort();
+    }
+
+    for (size_t i = 0; i < elements->size; i += elementsPerCall)
+    {
+        sysmelb_Value_t blockArguments[2];
+        for (size_t j = 0; j < elementsPerCall; ++j)
+            blockArguments[j] = elements->elements[i + j];
+        sysmelb_callFunctionWithArguments(sysmelb_value_getReference(block, function), elementsPerCall, blockArguments);
+    }
+}
+
+static sysmelb_ArrayHeader_t *sysmelb_SymbolHashtable_collect(sysmelb_SymbolHashtable_t *table, bool withKeys, bool withValues)
+{
+    size_t elementsPerEntry = (withKeys ? 1 : 0) + (withValues ? 1 : 0);
+    sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + table->size * elementsPerEntry * sizeof(sysmelb_Value_t));
+    array->size = table->size * elementsPerEntry;
+
+    size_t destIndex = 0;
+    for (size_t i = 0; i < table->capacity; ++i)
+    {
+        if (!table->keys[i])
+            continue;
+
+        if (withKeys)
+        {
+            sysmelb_Value_t key = sysmelb_value_makeReference(SysmelValueKindSymbolReference, sysmelb_getBasicTypes()->symbol, table->keys[i]);
+            array->elements[destIndex++] = key;
+        }
+        if (withValues)
+            array->elements[destIndex++] = *(sysmelb_Value_t *)table->values[i];
+    }
+    assert(destIndex == array->size);
+
+    return array;
+}
+
 static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_size(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindSymbolHashtableReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindUnsignedInteger,
-        .type = sysmelb_getBasicTypes()->integer,
-        .unsignedInteger = arguments[0].symbolHashtableReference->size,
-    };
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+    sysmelb_Value_t result = sysmelb_value_makeUnsignedInteger(
+        sysmelb_getBasicTypes()->integer, sysmelb_value_getReference(arguments[0], symbolHashtable)->size);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_includesKey(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindSymbolHashtableReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
 
-    const sysmelb_SymbolHashtablePair_t *lookupResult = sysmelb_SymbolHashtable_lookupSymbol(arguments[0].symbolHashtableReference, arguments[1].symbolReference);
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = lookupResult != NULL && lookupResult->value != NULL};
+    void *lookupResult;
+    bool found = sysmelb_SymbolHashtable_lookupSymbol(sysmelb_value_getReference(arguments[0], symbolHashtable), sysmelb_value_getReference(arguments[1], symbol), &lookupResult);
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(found && lookupResult != NULL);
 
     return result;
 }
@@ -1837,79 +1954,198 @@ static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_includesKey(size_t argu
 static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_at(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindSymbolHashtableReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
 
-    const sysmelb_SymbolHashtablePair_t *lookupResult = sysmelb_SymbolHashtable_lookupSymbol(arguments[0].symbolHashtableReference, arguments[1].symbolReference);
-    if (!lookupResult)
+    void *lookupResult;
+    if (!sysmelb_SymbolHashtable_lookupSymbol(sysmelb_value_getReference(arguments[0], symbolHashtable), sysmelb_value_getReference(arguments[1], symbol), &lookupResult))
     {
         sysmelb_SourcePosition_t null = {0};
         sysmelb_errorPrintf(null, "Failed to find key in symbol hashtable.");
+        abort();
     }
 
-    sysmelb_Value_t *resultPointer = (sysmelb_Value_t *)lookupResult->value;
+    sysmelb_Value_t *resultPointer = (sysmelb_Value_t *)lookupResult;
     return *resultPointer;
 }
 
 static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_atPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindSymbolHashtableReference);
-    assert(arguments[1].kind == SysmelValueKindSymbolReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindSymbolReference);
 
     sysmelb_Value_t *resultPointer = sysmelb_allocateValue();
     *resultPointer = arguments[2];
 
-    sysmelb_SymbolHashtable_addSymbolWithValue(arguments[0].symbolHashtableReference, arguments[1].symbolReference, resultPointer);
+    sysmelb_SymbolHashtable_addSymbolWithValue(sysmelb_value_getReference(arguments[0], symbolHashtable), sysmelb_value_getReference(arguments[1], symbol), resultPointer);
     return *resultPointer;
 }
 
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_removeKey(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    void *lookupResult;
+    if (!sysmelb_SymbolHashtable_lookupSymbol(sysmelb_value_getReference(arguments[0], symbolHashtable), sysmelb_value_getReference(arguments[1], symbol), &lookupResult))
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Failed to find key in symbol hashtable.");
+        abort();
+    }
+
+    sysmelb_Value_t *resultPointer = (sysmelb_Value_t *)lookupResult;
+    sysmelb_SymbolHashtable_removeSymbol(sysmelb_value_getReference(arguments[0], symbolHashtable), sysmelb_value_getReference(arguments[1], symbol));
+    return *resultPointer;
+}
+
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_keysAndValuesDo(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_SymbolHashtable_collect(sysmelb_value_getReference(arguments[0], symbolHashtable), true, true), 2);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_keysDo(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_SymbolHashtable_collect(sysmelb_value_getReference(arguments[0], symbolHashtable), true, false), 1);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_do(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_SymbolHashtable_collect(sysmelb_value_getReference(arguments[0], symbolHashtable), false, true), 1);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_keys(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    return sysmelb_makeArrayValue(sysmelb_SymbolHashtable_collect(sysmelb_value_getReference(arguments[0], symbolHashtable), true, false));
+}
+
+static sysmelb_Value_t sysmelb_primitive_SymbolHashtable_asArray(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindSymbolHashtableReference);
+
+    return sysmelb_makeArrayValue(sysmelb_SymbolHashtable_collect(sysmelb_value_getReference(arguments[0], symbolHashtable), false, true));
+}
+
 static void sysmelb_createBasicSymbolHashtablePrimitives(void)
 {
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("size"), sysmelb_primitive_SymbolHashtable_size);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("includesKey:"), sysmelb_primitive_SymbolHashtable_includesKey);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("at:"), sysmelb_primitive_SymbolHashtable_at);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("at:put:"), sysmelb_primitive_SymbolHashtable_atPut);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("removeKey:"), sysmelb_primitive_SymbolHashtable_removeKey);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("keysAndValuesDo:"), sysmelb_primitive_SymbolHashtable_keysAndValuesDo);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("keysDo:"), sysmelb_primitive_SymbolHashtable_keysDo);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("do:"), sysmelb_primitive_SymbolHashtable_do);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("keys"), sysmelb_primitive_SymbolHashtable_keys);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.symbolHashtable, sysmelb_internSymbolC("asArray"), sysmelb_primitive_SymbolHashtable_asArray);
 }
 
 static sysmelb_Value_t sysmelb_primitive_IdentityHashset_add(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindIdentityHashsetReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityHashsetReference);
+
+    if (!sysmelb_getValuePointer(arguments[1]))
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Identity hashsets can only contain reference values.");
+        abort();
+    }
 
-    sysmelb_IdentityHashset_add(arguments[0].identityHashsetReference, sysmelb_getValuePointer(arguments[1]));
+    sysmelb_IdentityHashset_add(sysmelb_value_getReference(arguments[0], identityHashset), arguments[1]);
     return arguments[1];
 }
 
 static sysmelb_Value_t sysmelb_primitive_IdentityHashset_includes(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindIdentityHashsetReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityHashsetReference);
 
-    bool includesResult = sysmelb_IdentityHashset_includes(arguments[0].identityHashsetReference, sysmelb_getValuePointer(arguments[1]));
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = includesResult};
+    bool includesResult = sysmelb_IdentityHashset_includes(sysmelb_value_getReference(arguments[0], identityHashset), sysmelb_getValuePointer(arguments[1]));
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(includesResult);
 
     return result;
 }
 
+static sysmelb_Value_t sysmelb_primitive_IdentityHashset_remove(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityHashsetReference);
+
+    if (!sysmelb_IdentityHashset_remove(sysmelb_value_getReference(arguments[0], identityHashset), sysmelb_getValuePointer(arguments[1])))
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Failed to find element in identity hashset.");
+        abort();
+    }
+    return arguments[1];
+}
+
+static sysmelb_ArrayHeader_t *sysmelb_IdentityHashset_collect(sysmelb_IdentityHashset_t *set)
+{
+    sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + set->size * sizeof(sysmelb_Value_t));
+    array->size = set->size;
+
+    size_t destIndex = 0;
+    for (size_t i = 0; i < set->capacity; ++i)
+    {
+        if (set->data[i])
+            array->elements[destIndex++] = set->elements[i];
+    }
+    assert(destIndex == array->size);
+
+    return array;
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityHashset_do(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityHashsetReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_IdentityHashset_collect(sysmelb_value_getReference(arguments[0], identityHashset)), 1);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityHashset_asArray(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityHashsetReference);
+
+    return sysmelb_makeArrayValue(sysmelb_IdentityHashset_collect(sysmelb_value_getReference(arguments[0], identityHashset)));
+}
+
 static void sysmelb_createBasicIdentityHashsetPrimitives(void)
 {
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityHashset, sysmelb_internSymbolC("add:"), sysmelb_primitive_IdentityHashset_add);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityHashset, sysmelb_internSymbolC("includes:"), sysmelb_primitive_IdentityHashset_includes);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityHashset, sysmelb_internSymbolC("remove:"), sysmelb_primitive_IdentityHashset_remove);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityHashset, sysmelb_internSymbolC("do:"), sysmelb_primitive_IdentityHashset_do);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityHashset, sysmelb_internSymbolC("asArray"), sysmelb_primitive_IdentityHashset_asArray);
 }
 
 static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_includesKey(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindIdentityDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
 
-    bool includesResult = sysmelb_IdentityDictionary_includesKey(arguments[0].identityDictionaryReference, sysmelb_getValuePointer(arguments[1]));
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = includesResult};
+    bool includesResult = sysmelb_IdentityDictionary_includesKey(sysmelb_value_getReference(arguments[0], identityDictionary), sysmelb_getValuePointer(arguments[1]));
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(includesResult);
 
     return result;
 }
@@ -1917,27 +2153,129 @@ static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_includesKey(size_t a
 static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_atPut(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 3);
-    assert(arguments[0].kind == SysmelValueKindIdentityDictionaryReference);
-    assert(arguments[1].kind == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindObjectReference);
 
-    sysmelb_IdentityDictionary_atPut(arguments[0].identityDictionaryReference, sysmelb_getValuePointer(arguments[1]), sysmelb_getValuePointer(arguments[2]));
+    sysmelb_IdentityDictionary_atPut(sysmelb_value_getReference(arguments[0], identityDictionary), sysmelb_getValuePointer(arguments[1]), sysmelb_getValuePointer(arguments[2]));
     return arguments[2];
 }
 
 static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_at(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindIdentityDictionaryReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
 
-    void *objectRawPointer = sysmelb_IdentityDictionary_at(arguments[0].identityDictionaryReference, sysmelb_getValuePointer(arguments[1]));
-    sysmelb_ObjectHeader_t *objectPointer = objectRawPointer;
-    
-    sysmelb_Value_t resultValue = {
-        .kind = SysmelValueKindObjectReference,
-        .objectReference = objectPointer,
-        .type = objectPointer->clazz
-    };
-    return resultValue;
+    void *objectRawPointer = NULL;
+    if (!sysmelb_IdentityDictionary_lookup(sysmelb_value_getReference(arguments[0], identityDictionary), sysmelb_getValuePointer(arguments[1]), &objectRawPointer))
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Failed to find key in identity dictionary.");
+        abort();
+    }
+
+    return sysmelb_makeObjectValueFromPointer(objectRawPointer);
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_atIfAbsent(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 3);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    // The absent value is either a block to evaluate, or the value itself,
+    // since blocks cannot be nested inside of methods.
+    void *objectRawPointer = NULL;
+    if (!sysmelb_IdentityDictionary_lookup(sysmelb_value_getReference(arguments[0], identityDictionary), sysmelb_getValuePointer(arguments[1]), &objectRawPointer))
+    {
+        if (sysmelb_value_getKind(arguments[2]) == SysmelValueKindFunctionReference)
+            return sysmelb_callFunctionWithArguments(sysmelb_value_getReference(arguments[2], function), 0, NULL);
+        return arguments[2];
+    }
+
+    return sysmelb_makeObjectValueFromPointer(objectRawPointer);
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_removeKey(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    sysmelb_IdentityDictionary_t *dictionary = sysmelb_value_getReference(arguments[0], identityDictionary);
+    void *key = sysmelb_getValuePointer(arguments[1]);
+    void *objectRawPointer = NULL;
+    if (!sysmelb_IdentityDictionary_lookup(dictionary, key, &objectRawPointer))
+    {
+        sysmelb_SourcePosition_t null = {0};
+        sysmelb_errorPrintf(null, "Failed to find key in identity dictionary.");
+        abort();
+    }
+
+    sysmelb_IdentityDictionary_removeKey(dictionary, key);
+    return sysmelb_makeObjectValueFromPointer(objectRawPointer);
+}
+
+static sysmelb_ArrayHeader_t *sysmelb_IdentityDictionary_collect(sysmelb_IdentityDictionary_t *dictionary, bool withKeys, bool withValues)
+{
+    size_t elementsPerEntry = (withKeys ? 1 : 0) + (withValues ? 1 : 0);
+    sysmelb_ArrayHeader_t *array = sysmelb_allocate(sizeof(sysmelb_ArrayHeader_t) + dictionary->size * elementsPerEntry * sizeof(sysmelb_Value_t));
+    array->size = dictionary->size * elementsPerEntry;
+
+    size_t destIndex = 0;
+    for (size_t i = 0; i < dictionary->capacity; ++i)
+    {
+        if (!dictionary->probeLengths[i])
+            continue;
+
+        if (withKeys)
+            array->elements[destIndex++] = sysmelb_makeObjectValueFromPointer(dictionary->keys[i]);
+        if (withValues)
+            array->elements[destIndex++] = sysmelb_makeObjectValueFromPointer(dictionary->values[i]);
+    }
+    assert(destIndex == array->size);
+
+    return array;
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_keysAndValuesDo(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_IdentityDictionary_collect(sysmelb_value_getReference(arguments[0], identityDictionary), true, true), 2);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_keysDo(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_IdentityDictionary_collect(sysmelb_value_getReference(arguments[0], identityDictionary), true, false), 1);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_do(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 2);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    sysmelb_callBlockForEachElement(arguments[1], sysmelb_IdentityDictionary_collect(sysmelb_value_getReference(arguments[0], identityDictionary), false, true), 1);
+    return arguments[0];
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_keys(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    return sysmelb_makeArrayValue(sysmelb_IdentityDictionary_collect(sysmelb_value_getReference(arguments[0], identityDictionary), true, false));
+}
+
+static sysmelb_Value_t sysmelb_primitive_IdentityDictionary_asArray(size_t argumentCount, sysmelb_Value_t *arguments)
+{
+    assert(argumentCount == 1);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindIdentityDictionaryReference);
+
+    return sysmelb_makeArrayValue(sysmelb_IdentityDictionary_collect(sysmelb_value_getReference(arguments[0], identityDictionary), false, true));
 }
 
 static void sysmelb_createBasicIdentityDictionaryPrimitives(void)
@@ -1945,90 +2283,80 @@ static void sysmelb_createBasicIdentityDictionaryPrimitives(void)
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("includesKey:"), sysmelb_primitive_IdentityDictionary_includesKey);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("at:put:"), sysmelb_primitive_IdentityDictionary_atPut);
     sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("at:"), sysmelb_primitive_IdentityDictionary_at);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("at:ifAbsent:"), sysmelb_primitive_IdentityDictionary_atIfAbsent);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("removeKey:"), sysmelb_primitive_IdentityDictionary_removeKey);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("keysAndValuesDo:"), sysmelb_primitive_IdentityDictionary_keysAndValuesDo);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("keysDo:"), sysmelb_primitive_IdentityDictionary_keysDo);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("do:"), sysmelb_primitive_IdentityDictionary_do);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("keys"), sysmelb_primitive_IdentityDictionary_keys);
+    sysmelb_type_addPrimitiveMethod(sysmelb_BasicTypesData.identityDictionary, sysmelb_internSymbolC("asArray"), sysmelb_primitive_IdentityDictionary_asArray);
 }
 
 
 static sysmelb_Value_t sysmelb_primitive_Boolean_Not(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindBoolean);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindBoolean);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = !arguments[0].boolean};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(!sysmelb_value_getBoolean(arguments[0]));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Boolean_Equals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindBoolean);
-    assert(arguments[1].kind == SysmelValueKindBoolean);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindBoolean);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindBoolean);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].boolean == arguments[1].boolean};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getBoolean(arguments[0]) == sysmelb_value_getBoolean(arguments[1]));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Boolean_NotEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindBoolean);
-    assert(arguments[1].kind == SysmelValueKindBoolean);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindBoolean);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindBoolean);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].boolean != arguments[1].boolean};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getBoolean(arguments[0]) != sysmelb_value_getBoolean(arguments[1]));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Boolean_And(sysmelb_MacroContext_t *context, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    assert(arguments[1].kind == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindParseTreeReference);
 
     sysmelb_ParseTreeNode_t *falseResult = sysmelb_newParseTreeNode(ParseTreeLiteralValueNode, context->sourcePosition);
-    falseResult->literalValue.value.kind = SysmelValueKindBoolean;
-    falseResult->literalValue.value.type = sysmelb_getBasicTypes()->boolean;
-    falseResult->literalValue.value.boolean = false;
+    falseResult->literalValue.value = sysmelb_value_makeBoolean(false);
 
     sysmelb_ParseTreeNode_t *ifNode = sysmelb_newParseTreeNode(ParseTreeIfSelection, context->sourcePosition);
-    ifNode->ifSelection.condition = arguments[0].parseTreeReference;
-    ifNode->ifSelection.trueExpression = arguments[1].parseTreeReference;
+    ifNode->ifSelection.condition = sysmelb_value_getReference(arguments[0], parseTree);
+    ifNode->ifSelection.trueExpression = sysmelb_value_getReference(arguments[1], parseTree);
     ifNode->ifSelection.falseExpression = falseResult;
 
-    sysmelb_Value_t nodeValue = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = ifNode};
+    sysmelb_Value_t nodeValue = sysmelb_value_makeReference(
+        SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, ifNode);
     return nodeValue;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Boolean_Or(sysmelb_MacroContext_t *context, size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindParseTreeReference);
-    assert(arguments[1].kind == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindParseTreeReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindParseTreeReference);
 
     sysmelb_ParseTreeNode_t *trueResult = sysmelb_newParseTreeNode(ParseTreeLiteralValueNode, context->sourcePosition);
-    trueResult->literalValue.value.kind = SysmelValueKindBoolean;
-    trueResult->literalValue.value.type = sysmelb_getBasicTypes()->boolean;
-    trueResult->literalValue.value.boolean = true;
+    trueResult->literalValue.value = sysmelb_value_makeBoolean(true);
 
     sysmelb_ParseTreeNode_t *ifNode = sysmelb_newParseTreeNode(ParseTreeIfSelection, context->sourcePosition);
-    ifNode->ifSelection.condition = arguments[0].parseTreeReference;
+    ifNode->ifSelection.condition = sysmelb_value_getReference(arguments[0], parseTree);
     ifNode->ifSelection.trueExpression = trueResult;
-    ifNode->ifSelection.falseExpression = arguments[1].parseTreeReference;
+    ifNode->ifSelection.falseExpression = sysmelb_value_getReference(arguments[1], parseTree);
 
-    sysmelb_Value_t nodeValue = {
-        .kind = SysmelValueKindParseTreeReference,
-        .type = sysmelb_getBasicTypes()->parseTreeNode,
-        .parseTreeReference = ifNode};
+    sysmelb_Value_t nodeValue = sysmelb_value_makeReference(
+        SysmelValueKindParseTreeReference, sysmelb_getBasicTypes()->parseTreeNode, ifNode);
     return nodeValue;
 }
 
@@ -2044,24 +2372,18 @@ static void sysmelb_createBasicBooleanPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_Null_Equals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindNull);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindNull);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[1].kind == SysmelValueKindNull};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getKind(arguments[1]) == SysmelValueKindNull);
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Null_NotEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindNull);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindNull);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[1].kind != SysmelValueKindNull};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(sysmelb_value_getKind(arguments[1]) != SysmelValueKindNull);
     return result;
 }
 
@@ -2074,38 +2396,32 @@ static void sysmelb_createBasicNullPrimitives(void)
 static sysmelb_Value_t sysmelb_primitive_Object_Equals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindObjectReference);
-    assert(arguments[1].kind == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindObjectReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].objectReference == arguments[1].objectReference};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        sysmelb_value_getReference(arguments[0], object) == sysmelb_value_getReference(arguments[1], object));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Object_NotEquals(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 2);
-    assert(arguments[0].kind == SysmelValueKindObjectReference);
-    assert(arguments[1].kind == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[1]) == SysmelValueKindObjectReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindBoolean,
-        .type = sysmelb_getBasicTypes()->boolean,
-        .boolean = arguments[0].objectReference == arguments[1].objectReference};
+    sysmelb_Value_t result = sysmelb_value_makeBoolean(
+        sysmelb_value_getReference(arguments[0], object) == sysmelb_value_getReference(arguments[1], object));
     return result;
 }
 
 static sysmelb_Value_t sysmelb_primitive_Object_GetClass(size_t argumentCount, sysmelb_Value_t *arguments)
 {
     assert(argumentCount == 1);
-    assert(arguments[0].kind == SysmelValueKindObjectReference);
+    assert(sysmelb_value_getKind(arguments[0]) == SysmelValueKindObjectReference);
 
-    sysmelb_Value_t result = {
-        .kind = SysmelValueKindTypeReference,
-        .type = sysmelb_getBasicTypes()->universe,
-        .typeReference = arguments[0].objectReference->clazz};
+    sysmelb_Value_t result = sysmelb_value_makeReference(
+        SysmelValueKindTypeReference, sysmelb_getBasicTypes()->universe, sysmelb_value_getReference(arguments[0], object)->clazz);
     return result;
 }
 
@@ -2130,6 +2446,7 @@ static void sysmelb_createBasicTypesPrimitives(void)
     sysmelb_createBasicImmutableDictionaryPrimitives();
     sysmelb_createBasicOrderedCollectionPrimitives();
     sysmelb_createBasicByteOrderedCollectionPrimitives();
+    sysmelb_createBasicStringBuilderPrimitives();
     sysmelb_createBasicSymbolHashtablePrimitives();
     sysmelb_createBasicIdentityHashsetPrimitives();
     sysmelb_createBasicIdentityDictionaryPrimitives();
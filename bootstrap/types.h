@@ -14,6 +14,7 @@ typedef struct sysmelb_Type_s sysmelb_Type_t;
 typedef struct sysmelb_ImmutableDictionary_s sysmelb_ImmutableDictionary_t;
 typedef struct sysmelb_OrderedCollection_s sysmelb_OrderedCollection_t;
 typedef struct sysmelb_ByteOrderedCollection_s sysmelb_ByteOrderedCollection_t;
+typedef struct sysmelb_StringBuilder_s sysmelb_StringBuilder_t;
 
 typedef enum sysmelb_TypeKind_e {
     SysmelTypeKindNull,
@@ -41,6 +42,7 @@ typedef enum sysmelb_TypeKind_e {
     SysmelTypeKindNamespace,
     SysmelTypeKindOrderedCollection,
     SysmelTypeKindByteOrderedCollection,
+    SysmelTypeKindStringBuilder,
     SysmelTypeKindIdentityHashset,
     SysmelTypeKindIdentityDictionary,
     SysmelTypeKindParseTreeNode,
@@ -54,12 +56,14 @@ typedef enum sysmelb_TypeKind_e {
 
 struct sysmelb_Type_s {
     sysmelb_TypeKind_t kind;
+    uint32_t typeIndex;
     sysmelb_symbol_t *name;
     const char *printingSuffix;
     sysmelb_Type_t *supertype;
     uint32_t valueSize;
     uint32_t valueAlignment;
     sysmelb_SymbolHashtable_t methodDict;
+    size_t methodDictFrozenSize;
     union
     {
         struct {
@@ -124,6 +128,7 @@ typedef struct sysmelb_BasicTypes_s {
     sysmelb_Type_t *namespace;
     sysmelb_Type_t *orderedCollection;
     sysmelb_Type_t *byteOrderedCollection;
+    sysmelb_Type_t *stringBuilder;
     sysmelb_Type_t *identityHashset;
     sysmelb_Type_t *identityDictionary;
 
@@ -164,4 +169,24 @@ int sysmelb_findSumTypeIndexForType(sysmelb_Type_t *sumType, sysmelb_Type_t *inj
 sysmelb_Value_t sysmelb_instantiateTypeWithArguments(sysmelb_Type_t *type, size_t argumentCount, sysmelb_Value_t *arguments);
 const sysmelb_BasicTypes_t *sysmelb_getBasicTypes(void);
 
+// Every type is registered in the type table, so that values can refer to
+// their type with a 32-bit index. The index zero is reserved for no type.
+// The table does not keep the types alive: the collector marks them through
+// the values that refer to them, and then sweeps the slots of the unmarked
+// types, which are reused by the next allocated types.
+extern sysmelb_Type_t **sysmelb_TypeTable;
+extern uint32_t sysmelb_TypeTableSize;
+
+void sysmelb_type_sweepTypeTable(void);
+
+static inline uint32_t sysmelb_type_getIndex(sysmelb_Type_t *type)
+{
+    return type ? type->typeIndex : 0;
+}
+
+static inline sysmelb_Type_t *sysmelb_type_getFromIndex(uint32_t typeIndex)
+{
+    return sysmelb_TypeTable ? sysmelb_TypeTable[typeIndex] : NULL;
+}
+
 #endif //SYSMEL_TYPES_H
\ No newline at end of file
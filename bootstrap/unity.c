@@ -1,8 +1,14 @@
+#include "allocation-profile.c"
 #include "environment.c"
 #include "error.c"
+#include "gc.c"
 #include "hashtable.c"
+#include "hashtable-stats.c"
+#ifndef SYSMELB_NO_MAIN
 #include "main.c"
+#endif
 #include "memory.c"
+#include "method-cache.c"
 #include "module.c"
 #include "value.c"
 #include "namespace.c"
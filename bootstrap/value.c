@@ -1,4 +1,5 @@
 #include "value.h"
+#include "hash.h"
 #include "memory.h"
 #include <stdio.h>
 #include <string.h>
@@ -8,57 +9,73 @@ sysmelb_Value_t *sysmelb_allocateValue(void)
     return sysmelb_allocate(sizeof(sysmelb_Value_t));
 }
 
+#ifdef SYSMELB_TAGGED_VALUES
+sysmelb_Value_t sysmelb_value_escape(sysmelb_ValueKind_t kind, bool isStringSlice, uint32_t typeIndexOrStringSize, uint64_t payload)
+{
+    sysmelb_WideValue_t *wideValue = sysmelb_allocate(sizeof(sysmelb_WideValue_t));
+    wideValue->kind = kind;
+    wideValue->isStringSlice = isStringSlice;
+    wideValue->typeIndex = typeIndexOrStringSize;
+    wideValue->unsignedInteger = payload;
+
+    sysmelb_Value_t value = {
+        .bits = ((uint64_t)kind << SYSMELB_TAGGED_VALUE_KIND_SHIFT) | SYSMELB_TAGGED_VALUE_ESCAPED_BIT | (uintptr_t)wideValue
+    };
+    return value;
+}
+#endif
+
 sysmelb_Value_t sysmelb_decayValue(sysmelb_Value_t value)
 {
-    if(value.kind == SysmelValueKindValueBoxReference)
-        return value.valueBoxReference->currentValue;
+    if(sysmelb_value_getKind(value) == SysmelValueKindValueBoxReference)
+        return sysmelb_value_getReference(value, valueBox)->currentValue;
     return value;
 }
 
 bool sysmelb_value_equals(sysmelb_Value_t a, sysmelb_Value_t b)
 {
-    if(a.kind != b.kind)
+    if(sysmelb_value_getKind(a) != sysmelb_value_getKind(b))
         return false;
 
-    switch(a.kind)
+    switch(sysmelb_value_getKind(a))
     {
     case SysmelValueKindNull:
         return true;
     case SysmelValueKindVoid:
         return true;
     case SysmelValueKindBoolean:
-        return a.boolean == b.boolean;
+        return sysmelb_value_getBoolean(a) == sysmelb_value_getBoolean(b);
     case SysmelValueKindCharacter:
-        return a.unsignedInteger == b.unsignedInteger;
+        return sysmelb_value_getUnsignedInteger(a) == sysmelb_value_getUnsignedInteger(b);
     case SysmelValueKindInteger:
-        return a.integer == b.integer;
+        return sysmelb_value_getInteger(a) == sysmelb_value_getInteger(b);
     case SysmelValueKindUnsignedInteger:
-        return a.unsignedInteger == b.unsignedInteger;
+        return sysmelb_value_getUnsignedInteger(a) == sysmelb_value_getUnsignedInteger(b);
     case SysmelValueKindFloatingPoint:
-        return a.floatingPoint == b.floatingPoint;
+        return sysmelb_value_getFloatingPoint(a) == sysmelb_value_getFloatingPoint(b);
 
     case SysmelValueKindTypeReference:
-        return a.typeReference == b.typeReference;
+        return sysmelb_value_getReference(a, type) == sysmelb_value_getReference(b, type);
     case SysmelValueKindFunctionReference:
-        return a.functionReference == b.functionReference;
+        return sysmelb_value_getReference(a, function) == sysmelb_value_getReference(b, function);
     case SysmelValueKindParseTreeReference:
-        return a.parseTreeReference == b.parseTreeReference;
+        return sysmelb_value_getReference(a, parseTree) == sysmelb_value_getReference(b, parseTree);
     case SysmelValueKindSymbolReference:
-        return a.symbolReference == b.symbolReference;
+        return sysmelb_value_getReference(a, symbol) == sysmelb_value_getReference(b, symbol);
     case SysmelValueKindStringReference:
-        return a.string == b.string && a.stringSize == b.stringSize;
+        return sysmelb_value_getString(a) == sysmelb_value_getString(b) && sysmelb_value_getStringSize(a) == sysmelb_value_getStringSize(b);
     case SysmelValueKindArrayReference:
-        return a.arrayReference == b.arrayReference;
+        return sysmelb_value_getReference(a, array) == sysmelb_value_getReference(b, array);
     case SysmelValueKindByteArrayReference:
-        return a.byteArrayReference == b.byteArrayReference;
+        return sysmelb_value_getReference(a, byteArray) == sysmelb_value_getReference(b, byteArray);
     case SysmelValueKindTupleReference:
-        return a.tupleReference == b.tupleReference;
+        return sysmelb_value_getReference(a, tuple) == sysmelb_value_getReference(b, tuple);
     case SysmelValueKindAssociationReference:
-        return a.associationReference == b.associationReference;
+        return sysmelb_value_getReference(a, association) == sysmelb_value_getReference(b, association);
     case SysmelValueKindImmutableDictionaryReference:
-        return a.immutableDictionaryReference == b.immutableDictionaryReference;
+        return sysmelb_value_getReference(a, immutableDictionary) == sysmelb_value_getReference(b, immutableDictionary);
     case SysmelValueKindValueBoxReference:
-        return a.valueBoxReference == b.valueBoxReference;
+        return sysmelb_value_getReference(a, valueBox) == sysmelb_value_getReference(b, valueBox);
     default:
         return false;
     }
@@ -80,10 +97,10 @@ void sysmelb_printValueWithMaxDepth(sysmelb_Value_t value, int depth)
     }
 
     const char *printingSuffix = "";
-    if(value.type && value.type->printingSuffix)
-        printingSuffix = value.type->printingSuffix;
+    if(sysmelb_value_getType(value) && sysmelb_value_getType(value)->printingSuffix)
+        printingSuffix = sysmelb_value_getType(value)->printingSuffix;
 
-    switch(value.kind)
+    switch(sysmelb_value_getKind(value))
     {
     case SysmelValueKindNull:
         printf("null");
@@ -92,55 +109,55 @@ void sysmelb_printValueWithMaxDepth(sysmelb_Value_t value, int depth)
         printf("void");
         break;
     case SysmelValueKindBoolean:
-        printf(value.boolean ? "true" : "false");
+        printf(sysmelb_value_getBoolean(value) ? "true" : "false");
         break;
     case SysmelValueKindTypeReference:
-        if (value.typeReference->name)
-            printf("%.*s", value.typeReference->name->size, value.typeReference->name->string);
+        if (sysmelb_value_getReference(value, type)->name)
+            printf("%.*s", sysmelb_value_getReference(value, type)->name->size, sysmelb_value_getReference(value, type)->name->string);
         else
             printf("AnonTypeReference");
         break;
     case SysmelValueKindSymbolReference:
-        printf("#%.*s", value.symbolReference->size, value.symbolReference->string);
+        printf("#%.*s", sysmelb_value_getReference(value, symbol)->size, sysmelb_value_getReference(value, symbol)->string);
         break;
     case SysmelValueKindStringReference:
-        printf("\"%.*s\"", (int)value.stringSize, value.string);
+        printf("\"%.*s\"", (int)sysmelb_value_getStringSize(value), sysmelb_value_getString(value));
         break;
     case SysmelValueKindCharacter:
-        printf("%c%s", (int)value.unsignedInteger, printingSuffix);
+        printf("%c%s", (int)sysmelb_value_getUnsignedInteger(value), printingSuffix);
         break;
     case SysmelValueKindArrayReference:
         printf("[");
-        for(size_t i = 0; i < value.arrayReference->size; ++i)
+        for(size_t i = 0; i < sysmelb_value_getReference(value, array)->size; ++i)
         {
             if(i != 0)
                 printf(" . ");
-            sysmelb_printValueWithMaxDepth(value.arrayReference->elements[i], depth);
+            sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, array)->elements[i], depth);
         }
         printf("]");
         break;
     case SysmelValueKindByteArrayReference:
         printf("#[");
-        for(size_t i = 0; i < value.byteArrayReference->size; ++i)
+        for(size_t i = 0; i < sysmelb_value_getReference(value, byteArray)->size; ++i)
         {
             if(i != 0)
                 printf(" . ");
-            printf("%d", value.byteArrayReference->elements[i]);
+            printf("%d", sysmelb_value_getReference(value, byteArray)->elements[i]);
         }
         printf("]");
         break;
     case SysmelValueKindTupleReference:
-        if(value.type->kind == SysmelTypeKindRecord)
+        if(sysmelb_value_getType(value)->kind == SysmelTypeKindRecord)
         {
-            if(value.type->name)
-                printf("%.*s", value.type->name->size, value.type->name->string);
+            if(sysmelb_value_getType(value)->name)
+                printf("%.*s", sysmelb_value_getType(value)->name->size, sysmelb_value_getType(value)->name->string);
             printf("#{");
-            for(uint32_t i = 0; i < value.type->tupleAndRecords.fieldCount; ++i)
+            for(uint32_t i = 0; i < sysmelb_value_getType(value)->tupleAndRecords.fieldCount; ++i)
             {
                 if(i != 0) printf(" ");
-                sysmelb_symbol_t *fieldName = value.type->tupleAndRecords.fieldNames[i];
+                sysmelb_symbol_t *fieldName = sysmelb_value_getType(value)->tupleAndRecords.fieldNames[i];
                 printf("%.*s: ", fieldName->size, fieldName->string);
-                sysmelb_printValueWithMaxDepth(value.tupleReference->elements[i], depth);
+                sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, tuple)->elements[i], depth);
                 printf(".");
             }
             printf("}");
@@ -148,43 +165,43 @@ void sysmelb_printValueWithMaxDepth(sysmelb_Value_t value, int depth)
         else
         {
             printf("(");
-            for(size_t i = 0; i < value.tupleReference->size; ++i)
+            for(size_t i = 0; i < sysmelb_value_getReference(value, tuple)->size; ++i)
             {
                 if(i != 0)
                     printf(", ");
-                sysmelb_printValueWithMaxDepth(value.tupleReference->elements[i], depth);
+                sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, tuple)->elements[i], depth);
             }
             printf(")");
         }
         break;
     case SysmelValueKindObjectReference:
-        if(value.type->name)
-            printf("%.*s", value.type->name->size, value.type->name->string);
+        if(sysmelb_value_getType(value)->name)
+            printf("%.*s", sysmelb_value_getType(value)->name->size, sysmelb_value_getType(value)->name->string);
         printf("#{");
-        for(uint32_t i = 0; i < value.type->clazz.fieldCount; ++i)
+        for(uint32_t i = 0; i < sysmelb_value_getType(value)->clazz.fieldCount; ++i)
         {
             if(i != 0) printf(" ");
-            sysmelb_symbol_t *fieldName = value.type->clazz.fieldNames[i];
+            sysmelb_symbol_t *fieldName = sysmelb_value_getType(value)->clazz.fieldNames[i];
             printf("%.*s: ", fieldName->size, fieldName->string);
-            sysmelb_printValueWithMaxDepth(value.objectReference->elements[value.type->clazz.superFieldCount + i], depth);
+            sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, object)->elements[sysmelb_value_getType(value)->clazz.superFieldCount + i], depth);
             printf(".");
         }
         printf("}");
         break;
     case SysmelValueKindAssociationReference:
-        sysmelb_printValueWithMaxDepth(value.associationReference->key, depth);
+        sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, association)->key, depth);
         printf(" : ");
-        sysmelb_printValueWithMaxDepth(value.associationReference->value, depth);
+        sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, association)->value, depth);
         break;
     case SysmelValueKindImmutableDictionaryReference:
         {
-            size_t dictionarySize = value.immutableDictionaryReference->size;
+            size_t dictionarySize = sysmelb_value_getReference(value, immutableDictionary)->size;
             printf("#{");
             for(size_t i = 0; i < dictionarySize; ++i)
             {
                 if(i != 0)
                     printf(". ");
-                sysmelb_Association_t *assoc = value.immutableDictionaryReference->elements[i];
+                sysmelb_Association_t *assoc = sysmelb_value_getReference(value, immutableDictionary)->elements[i];
                 sysmelb_printValueWithMaxDepth(assoc->key, depth);
                 printf(" : ");
                 sysmelb_printValueWithMaxDepth(assoc->value, depth);
@@ -193,38 +210,41 @@ void sysmelb_printValueWithMaxDepth(sysmelb_Value_t value, int depth)
         }
         break;
     case SysmelValueKindInteger:
-        printf("%lld%s", (long long int)value.integer, printingSuffix);
+        printf("%lld%s", (long long int)sysmelb_value_getInteger(value), printingSuffix);
         break;
     case SysmelValueKindUnsignedInteger:
-        printf("%llu%s", (long long unsigned int)value.integer, printingSuffix);
+        printf("%llu%s", (long long unsigned int)sysmelb_value_getInteger(value), printingSuffix);
         break;
     case SysmelValueKindFloatingPoint:
-        printf("%f%s", value.floatingPoint, printingSuffix);
+        printf("%f%s", sysmelb_value_getFloatingPoint(value), printingSuffix);
         break;
     case SysmelValueKindValueBoxReference:
         printf("Box[");
-        sysmelb_printValueWithMaxDepth(value.valueBoxReference->currentValue, depth);
+        sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, valueBox)->currentValue, depth);
         printf("]");
         break;
     case SysmelValueKindFunctionReference:
         printf("function(");
-        if(value.functionReference->name)
-            printf("%.*s", value.functionReference->name->size, value.functionReference->name->string);
+        if(sysmelb_value_getReference(value, function)->name)
+            printf("%.*s", sysmelb_value_getReference(value, function)->name->size, sysmelb_value_getReference(value, function)->name->string);
         printf(")");
         break;
     case SysmelValueKindOrderedCollectionReference:
         printf("OrderedCollection with: [");
-        for(size_t i = 0; i < value.orderedCollectionReference->size; ++i)
+        for(size_t i = 0; i < sysmelb_value_getReference(value, orderedCollection)->size; ++i)
         {
             if(i != 0) printf(" . ");
-            sysmelb_printValueWithMaxDepth(value.orderedCollectionReference->elements[i], depth);
+            sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, orderedCollection)->elements[i], depth);
         }
         printf("]");
         break;
+    case SysmelValueKindStringBuilderReference:
+        printf("StringBuilder with: \"%.*s\"", (int)sysmelb_value_getReference(value, stringBuilder)->size, sysmelb_value_getReference(value, stringBuilder)->data);
+        break;
     case SysmelValueKindSumValueReference:
-        printf("%.*s[%u:", value.type->name->size, value.type->name->string,
-             value.sumTypeValueReference->alternativeIndex);
-        sysmelb_printValueWithMaxDepth(value.sumTypeValueReference->alternativeValue, depth);
+        printf("%.*s[%u:", sysmelb_value_getType(value)->name->size, sysmelb_value_getType(value)->name->string,
+             sysmelb_value_getReference(value, sumTypeValue)->alternativeIndex);
+        sysmelb_printValueWithMaxDepth(sysmelb_value_getReference(value, sumTypeValue)->alternativeValue, depth);
         printf("]");
         break;
     case SysmelValueKindSymbolHashtableReference:
@@ -247,7 +267,7 @@ void sysmelb_OrderedCollection_increaseCapacity(sysmelb_OrderedCollection_t *col
     if(newCapacity < 32) newCapacity = 32;
 
     sysmelb_Value_t *newStorage = sysmelb_allocate(sizeof(sysmelb_Value_t) * newCapacity);
-    if(collection->size != 0)
+    if(collection->elements)
     {
         memcpy(newStorage, collection->elements, collection->size*sizeof(sysmelb_Value_t));
         sysmelb_freeAllocation(collection->elements);
@@ -271,7 +291,7 @@ void sysmelb_ByteOrderedCollection_increaseCapacity(sysmelb_ByteOrderedCollectio
     if(newCapacity < 32) newCapacity = 32;
 
     uint8_t *newStorage = sysmelb_allocate(newCapacity);
-    if(collection->size != 0)
+    if(collection->elements)
     {
         memcpy(newStorage, collection->elements, collection->size);
         sysmelb_freeAllocation(collection->elements);
@@ -288,9 +308,52 @@ void sysmelb_ByteOrderedCollection_add(sysmelb_ByteOrderedCollection_t *collecti
     collection->elements[collection->size++] = value;
 }
 
+void sysmelb_StringBuilder_reserve(sysmelb_StringBuilder_t *builder, size_t extraSize)
+{
+    size_t requiredCapacity = builder->size + extraSize;
+    if(requiredCapacity <= builder->capacity)
+        return;
+
+    size_t newCapacity = builder->capacity*2;
+    if(newCapacity < 32) newCapacity = 32;
+    if(newCapacity < requiredCapacity) newCapacity = requiredCapacity;
+
+    char *newStorage = sysmelb_allocate(newCapacity);
+    if(builder->data)
+    {
+        memcpy(newStorage, builder->data, builder->size);
+        sysmelb_freeAllocation(builder->data);
+    }
+
+    builder->capacity = newCapacity;
+    builder->data = newStorage;
+}
+
+void sysmelb_StringBuilder_addCharacter(sysmelb_StringBuilder_t *builder, char character)
+{
+    sysmelb_StringBuilder_reserve(builder, 1);
+    builder->data[builder->size++] = character;
+}
+
+void sysmelb_StringBuilder_addString(sysmelb_StringBuilder_t *builder, size_t stringSize, const char *string)
+{
+    sysmelb_StringBuilder_reserve(builder, stringSize);
+    memcpy(builder->data + builder->size, string, stringSize);
+    builder->size += stringSize;
+}
+
+sysmelb_Value_t sysmelb_StringBuilder_asString(sysmelb_StringBuilder_t *builder)
+{
+    char *string = sysmelb_allocate(builder->size);
+    memcpy(string, builder->data, builder->size);
+
+    sysmelb_Value_t result = sysmelb_value_makeString(builder->size, string);
+    return result;
+}
+
 void *sysmelb_getValuePointer(sysmelb_Value_t value)
 {
-    switch(value.kind)
+    switch(sysmelb_value_getKind(value))
     {
     case SysmelValueKindTypeReference:
     case SysmelValueKindFunctionReference:
@@ -308,10 +371,11 @@ void *sysmelb_getValuePointer(sysmelb_Value_t value)
     case SysmelValueKindNamespaceReference:
     case SysmelValueKindOrderedCollectionReference:
     case SysmelValueKindByteOrderedCollectionReference:
+    case SysmelValueKindStringBuilderReference:
     case SysmelValueKindSumValueReference:
     case SysmelValueKindIdentityHashsetReference:
     case SysmelValueKindIdentityDictionaryReference:
-        return value.objectReference;
+        return sysmelb_value_getPointerPayload(value);
     default:
         return NULL;
     }
@@ -319,8 +383,5 @@ void *sysmelb_getValuePointer(sysmelb_Value_t value)
 
 uint64_t sysmelb_getValueIdentityHash(sysmelb_Value_t value)
 {
-    uint64_t basePointer = (uintptr_t)sysmelb_getValuePointer(value);
-    // LCG. See https://en.wikipedia.org/wiki/Linear_congruential_generator
-    // for coefficient choice.
-    return basePointer * 6364136223846793005ull + 1;
+    return sysmelb_hashPointer(sysmelb_getValuePointer(value));
 }
\ No newline at end of file
@@ -4,6 +4,9 @@
 #include "types.h"
 #include "hashtable.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
 
 typedef enum sysmelb_ValueKind_e
 {
@@ -31,6 +34,7 @@ typedef enum sysmelb_ValueKind_e
     SysmelValueKindNamespaceReference,
     SysmelValueKindOrderedCollectionReference,
     SysmelValueKindByteOrderedCollectionReference,
+    SysmelValueKindStringBuilderReference,
     SysmelValueKindSumValueReference,
     SysmelValueKindIdentityHashsetReference,
     SysmelValueKindIdentityDictionaryReference,
@@ -59,10 +63,28 @@ typedef struct sysmelb_ValueBox_s sysmelb_ValueBox_t;
 typedef struct sysmelb_OrderedCollection_s sysmelb_OrderedCollection_t;
 typedef struct sysmelb_SumTypeValue_s sysmelb_SumTypeValue_t;
 
-struct sysmelb_Value_s
+// Values are 16 bytes by default. The type is stored as an index in the type
+// table, except for strings whose type is implied, so that they can use the
+// same slot for their size. String slices point into the storage of their
+// parent string, and are marked so that they are not modified through it.
+//
+// With SYSMELB_TAGGED_VALUES, values are a single 64-bit word instead, and
+// this wide layout is only used for the values that do not fit in one.
+#ifndef SYSMELB_TAGGED_VALUES
+#define sysmelb_WideValue_s sysmelb_Value_s
+#endif
+
+typedef struct sysmelb_WideValue_s sysmelb_WideValue_t;
+
+struct sysmelb_WideValue_s
 {
-    sysmelb_ValueKind_t kind;
-    sysmelb_Type_t *type;
+    sysmelb_ValueKind_t kind : 8;
+    bool isStringSlice : 1;
+    union
+    {
+        uint32_t typeIndex;
+        uint32_t stringSize;
+    };
     union
     {
         bool boolean;
@@ -88,34 +110,57 @@ struct sysmelb_Value_s
 
         sysmelb_OrderedCollection_t *orderedCollectionReference;
         sysmelb_ByteOrderedCollection_t *byteOrderedCollectionReference;
+        sysmelb_StringBuilder_t *stringBuilderReference;
         sysmelb_SymbolHashtable_t *symbolHashtableReference;
         sysmelb_IdentityHashset_t *identityHashsetReference;
         
         sysmelb_SumTypeValue_t *sumTypeValueReference;
 
-        struct
-        {
-            size_t stringSize;
-            char *string;
-        };
+        char *string;
     };
 };
 
+#ifdef SYSMELB_TAGGED_VALUES
+// A tagged value keeps its kind in the top 5 bits and a 48-bit payload in the
+// low bits. The 10 bits in between hold the type index, or for strings the
+// slice bit and a size below 512. Integers and pointers are sign extended
+// from the payload, and floating point numbers keep their top 48 bits. A
+// value whose payload, type index or string size does not fit is escaped:
+// its payload points to a copy in the wide layout, allocated in the heap.
+struct sysmelb_Value_s
+{
+    uint64_t bits;
+};
+
+#define SYSMELB_TAGGED_VALUE_KIND_SHIFT 59
+#define SYSMELB_TAGGED_VALUE_ESCAPED_BIT ((uint64_t)1 << 58)
+#define SYSMELB_TAGGED_VALUE_SLOT_SHIFT 48
+#define SYSMELB_TAGGED_VALUE_SLOT_MASK 0x3FF
+#define SYSMELB_TAGGED_VALUE_STRING_SLICE_BIT 0x200
+#define SYSMELB_TAGGED_VALUE_STRING_SIZE_MASK 0x1FF
+#define SYSMELB_TAGGED_VALUE_PAYLOAD_MASK (((uint64_t)1 << 48) - 1)
+
+_Static_assert(SysmelValueKindIdentityDictionaryReference < 32, "Value kinds must fit in 5 bits.");
+#endif
+
 struct sysmelb_ArrayHeader_s
 {
-    size_t size;
+    uint32_t size;
+    bool isLiteral;
     sysmelb_Value_t elements[];
 };
 
 struct sysmelb_ByteArrayHeader_s
 {
-    size_t size;
+    uint32_t size;
+    bool isLiteral;
     uint8_t elements[];
 };
 
 struct sysmelb_TupleHeader_s
 {
-    size_t size;
+    uint32_t size;
+    bool isLiteral;
     sysmelb_Value_t elements[];
 };
 
@@ -157,6 +202,15 @@ struct sysmelb_ByteOrderedCollection_s
     uint8_t *elements;
 };
 
+// Strings are immutable, so building one by concatenation copies it each
+// time. A builder appends in place, and makes a string only when asked.
+struct sysmelb_StringBuilder_s
+{
+    size_t capacity;
+    size_t size;
+    char *data;
+};
+
 struct sysmelb_SumTypeValue_s
 {
     uint32_t alternativeIndex;
@@ -166,6 +220,269 @@ struct sysmelb_SumTypeValue_s
 void sysmelb_OrderedCollection_add(sysmelb_OrderedCollection_t *collection, sysmelb_Value_t value);
 void sysmelb_ByteOrderedCollection_add(sysmelb_ByteOrderedCollection_t *collection, uint8_t byte);
 
+void sysmelb_StringBuilder_addCharacter(sysmelb_StringBuilder_t *builder, char character);
+void sysmelb_StringBuilder_addString(sysmelb_StringBuilder_t *builder, size_t stringSize, const char *string);
+sysmelb_Value_t sysmelb_StringBuilder_asString(sysmelb_StringBuilder_t *builder);
+
+// Accessors for the parts of a value. Everything outside of this header goes
+// through them instead of the fields, so that it does not depend on the value
+// layout. Reading a payload as another member than the one it was made with
+// reinterprets its 64 bits, as reading another member of the union does.
+#ifdef SYSMELB_TAGGED_VALUES
+
+sysmelb_Value_t sysmelb_value_escape(sysmelb_ValueKind_t kind, bool isStringSlice, uint32_t typeIndexOrStringSize, uint64_t payload);
+
+static inline sysmelb_ValueKind_t sysmelb_value_getKind(sysmelb_Value_t value)
+{
+    return (sysmelb_ValueKind_t)(value.bits >> SYSMELB_TAGGED_VALUE_KIND_SHIFT);
+}
+
+static inline bool sysmelb_value_isEscaped(sysmelb_Value_t value)
+{
+    return (value.bits & SYSMELB_TAGGED_VALUE_ESCAPED_BIT) != 0;
+}
+
+static inline sysmelb_WideValue_t *sysmelb_value_getEscaped(sysmelb_Value_t value)
+{
+    return (sysmelb_WideValue_t*)(uintptr_t)(value.bits & SYSMELB_TAGGED_VALUE_PAYLOAD_MASK);
+}
+
+static inline uint32_t sysmelb_value_getSlot(sysmelb_Value_t value)
+{
+    return (uint32_t)(value.bits >> SYSMELB_TAGGED_VALUE_SLOT_SHIFT) & SYSMELB_TAGGED_VALUE_SLOT_MASK;
+}
+
+static inline uint64_t sysmelb_value_getPayload(sysmelb_Value_t value)
+{
+    if(sysmelb_value_isEscaped(value))
+        return sysmelb_value_getEscaped(value)->unsignedInteger;
+    if(sysmelb_value_getKind(value) == SysmelValueKindFloatingPoint)
+        return (value.bits & SYSMELB_TAGGED_VALUE_PAYLOAD_MASK) << 16;
+    return (uint64_t)((int64_t)(value.bits << 16) >> 16);
+}
+
+static inline uint32_t sysmelb_value_getTypeIndex(sysmelb_Value_t value)
+{
+    return sysmelb_value_isEscaped(value) ? sysmelb_value_getEscaped(value)->typeIndex : sysmelb_value_getSlot(value);
+}
+
+static inline uint32_t sysmelb_value_getStringSize(sysmelb_Value_t value)
+{
+    if(sysmelb_value_isEscaped(value))
+        return sysmelb_value_getEscaped(value)->stringSize;
+    return sysmelb_value_getSlot(value) & SYSMELB_TAGGED_VALUE_STRING_SIZE_MASK;
+}
+
+static inline bool sysmelb_value_isStringSlice(sysmelb_Value_t value)
+{
+    if(sysmelb_value_isEscaped(value))
+        return sysmelb_value_getEscaped(value)->isStringSlice;
+    return (sysmelb_value_getSlot(value) & SYSMELB_TAGGED_VALUE_STRING_SLICE_BIT) != 0;
+}
+
+static inline bool sysmelb_value_getBoolean(sysmelb_Value_t value)
+{
+    return (uint8_t)sysmelb_value_getPayload(value) != 0;
+}
+
+static inline sysmelb_IntegerLiteralType_t sysmelb_value_getInteger(sysmelb_Value_t value)
+{
+    return (sysmelb_IntegerLiteralType_t)sysmelb_value_getPayload(value);
+}
+
+static inline sysmelb_UnsignedIntegerLiteralType_t sysmelb_value_getUnsignedInteger(sysmelb_Value_t value)
+{
+    return sysmelb_value_getPayload(value);
+}
+
+static inline double sysmelb_value_getFloatingPoint(sysmelb_Value_t value)
+{
+    uint64_t payload = sysmelb_value_getPayload(value);
+    double floatingPoint;
+    memcpy(&floatingPoint, &payload, sizeof(double));
+    return floatingPoint;
+}
+
+static inline void *sysmelb_value_getPointerPayload(sysmelb_Value_t value)
+{
+    return (void*)(uintptr_t)sysmelb_value_getPayload(value);
+}
+
+#define sysmelb_value_getString(value) ((char*)sysmelb_value_getPointerPayload(value))
+#define sysmelb_value_getReference(value, referenceName) \
+    ((__typeof__(((sysmelb_WideValue_t*)0)->referenceName##Reference))sysmelb_value_getPointerPayload(value))
+
+static inline sysmelb_Value_t sysmelb_value_pack(sysmelb_ValueKind_t kind, bool isStringSlice, uint32_t typeIndexOrStringSize, uint64_t payload)
+{
+    uint64_t slot = typeIndexOrStringSize;
+    bool fits;
+    if(kind == SysmelValueKindStringReference)
+    {
+        fits = slot <= SYSMELB_TAGGED_VALUE_STRING_SIZE_MASK;
+        if(isStringSlice)
+            slot |= SYSMELB_TAGGED_VALUE_STRING_SLICE_BIT;
+    }
+    else
+    {
+        fits = slot <= SYSMELB_TAGGED_VALUE_SLOT_MASK;
+    }
+
+    uint64_t encodedPayload;
+    if(kind == SysmelValueKindFloatingPoint)
+    {
+        fits = fits && (payload & 0xFFFF) == 0;
+        encodedPayload = payload >> 16;
+    }
+    else
+    {
+        fits = fits && (uint64_t)((int64_t)(payload << 16) >> 16) == payload;
+        encodedPayload = payload & SYSMELB_TAGGED_VALUE_PAYLOAD_MASK;
+    }
+
+    if(!fits)
+        return sysmelb_value_escape(kind, isStringSlice, typeIndexOrStringSize, payload);
+
+    sysmelb_Value_t value = {
+        .bits = ((uint64_t)kind << SYSMELB_TAGGED_VALUE_KIND_SHIFT) | (slot << SYSMELB_TAGGED_VALUE_SLOT_SHIFT) | encodedPayload
+    };
+    return value;
+}
+
+static inline void sysmelb_value_setTypeIndex(sysmelb_Value_t *value, uint32_t typeIndex)
+{
+    *value = sysmelb_value_pack(sysmelb_value_getKind(*value), false, typeIndex, sysmelb_value_getPayload(*value));
+}
+
+static inline void sysmelb_value_setPayload(sysmelb_Value_t *value, uint64_t payload)
+{
+    sysmelb_ValueKind_t kind = sysmelb_value_getKind(*value);
+    if(kind == SysmelValueKindStringReference)
+        *value = sysmelb_value_pack(kind, sysmelb_value_isStringSlice(*value), sysmelb_value_getStringSize(*value), payload);
+    else
+        *value = sysmelb_value_pack(kind, false, sysmelb_value_getTypeIndex(*value), payload);
+}
+
+#else
+
+#define sysmelb_value_getKind(value) ((value).kind)
+#define sysmelb_value_getTypeIndex(value) ((value).typeIndex)
+#define sysmelb_value_getStringSize(value) ((value).stringSize)
+#define sysmelb_value_isStringSlice(value) ((value).isStringSlice)
+#define sysmelb_value_getBoolean(value) ((value).boolean)
+#define sysmelb_value_getInteger(value) ((value).integer)
+#define sysmelb_value_getUnsignedInteger(value) ((value).unsignedInteger)
+#define sysmelb_value_getFloatingPoint(value) ((value).floatingPoint)
+#define sysmelb_value_getString(value) ((value).string)
+#define sysmelb_value_getReference(value, referenceName) ((value).referenceName##Reference)
+#define sysmelb_value_getPointerPayload(value) ((void*)(value).objectReference)
+
+static inline sysmelb_Value_t sysmelb_value_pack(sysmelb_ValueKind_t kind, bool isStringSlice, uint32_t typeIndexOrStringSize, uint64_t payload)
+{
+    sysmelb_Value_t value = {
+        .kind = kind,
+        .isStringSlice = isStringSlice,
+        .typeIndex = typeIndexOrStringSize,
+        .unsignedInteger = payload,
+    };
+    return value;
+}
+
+static inline void sysmelb_value_setTypeIndex(sysmelb_Value_t *value, uint32_t typeIndex)
+{
+    value->typeIndex = typeIndex;
+}
+
+static inline void sysmelb_value_setPayload(sysmelb_Value_t *value, uint64_t payload)
+{
+    value->unsignedInteger = payload;
+}
+
+#endif
+
+static inline sysmelb_Type_t *sysmelb_value_getType(sysmelb_Value_t value)
+{
+    if(sysmelb_value_getKind(value) == SysmelValueKindStringReference)
+        return sysmelb_getBasicTypes()->string;
+    return sysmelb_type_getFromIndex(sysmelb_value_getTypeIndex(value));
+}
+
+static inline void sysmelb_value_setType(sysmelb_Value_t *value, sysmelb_Type_t *type)
+{
+    assert(sysmelb_value_getKind(*value) != SysmelValueKindStringReference || type == sysmelb_getBasicTypes()->string);
+    if(sysmelb_value_getKind(*value) != SysmelValueKindStringReference)
+        sysmelb_value_setTypeIndex(value, sysmelb_type_getIndex(type));
+}
+
+static inline void sysmelb_value_setBoolean(sysmelb_Value_t *value, bool boolean)
+{
+    sysmelb_value_setPayload(value, boolean);
+}
+
+static inline void sysmelb_value_setInteger(sysmelb_Value_t *value, sysmelb_IntegerLiteralType_t integer)
+{
+    sysmelb_value_setPayload(value, (uint64_t)integer);
+}
+
+static inline void sysmelb_value_setUnsignedInteger(sysmelb_Value_t *value, sysmelb_UnsignedIntegerLiteralType_t unsignedInteger)
+{
+    sysmelb_value_setPayload(value, unsignedInteger);
+}
+
+static inline void sysmelb_value_setFloatingPoint(sysmelb_Value_t *value, double floatingPoint)
+{
+    uint64_t payload;
+    memcpy(&payload, &floatingPoint, sizeof(double));
+    sysmelb_value_setPayload(value, payload);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeImmediate(sysmelb_ValueKind_t kind, sysmelb_Type_t *type)
+{
+    return sysmelb_value_pack(kind, false, sysmelb_type_getIndex(type), 0);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeBoolean(bool boolean)
+{
+    return sysmelb_value_pack(SysmelValueKindBoolean, false, sysmelb_type_getIndex(sysmelb_getBasicTypes()->boolean), boolean);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeInteger(sysmelb_Type_t *type, sysmelb_IntegerLiteralType_t integer)
+{
+    return sysmelb_value_pack(SysmelValueKindInteger, false, sysmelb_type_getIndex(type), (uint64_t)integer);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeUnsignedInteger(sysmelb_Type_t *type, sysmelb_UnsignedIntegerLiteralType_t unsignedInteger)
+{
+    return sysmelb_value_pack(SysmelValueKindUnsignedInteger, false, sysmelb_type_getIndex(type), unsignedInteger);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeCharacter(sysmelb_Type_t *type, sysmelb_UnsignedIntegerLiteralType_t character)
+{
+    return sysmelb_value_pack(SysmelValueKindCharacter, false, sysmelb_type_getIndex(type), character);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeFloatingPoint(sysmelb_Type_t *type, double floatingPoint)
+{
+    uint64_t payload;
+    memcpy(&payload, &floatingPoint, sizeof(double));
+    return sysmelb_value_pack(SysmelValueKindFloatingPoint, false, sysmelb_type_getIndex(type), payload);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeReference(sysmelb_ValueKind_t kind, sysmelb_Type_t *type, void *pointer)
+{
+    assert(kind != SysmelValueKindStringReference);
+    return sysmelb_value_pack(kind, false, sysmelb_type_getIndex(type), (uintptr_t)pointer);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeString(size_t stringSize, char *string)
+{
+    return sysmelb_value_pack(SysmelValueKindStringReference, false, (uint32_t)stringSize, (uintptr_t)string);
+}
+
+static inline sysmelb_Value_t sysmelb_value_makeStringSlice(size_t stringSize, char *string)
+{
+    return sysmelb_value_pack(SysmelValueKindStringReference, true, (uint32_t)stringSize, (uintptr_t)string);
+}
+
 sysmelb_Value_t *sysmelb_allocateValue(void);
 sysmelb_Value_t sysmelb_decayValue(sysmelb_Value_t value);
 bool sysmelb_value_equals(sysmelb_Value_t a, sysmelb_Value_t b);
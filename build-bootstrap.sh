@@ -1,3 +1,6 @@
 #!/bin/sh
 mkdir -p build
 gcc -Wall -Wextra -g -o build/bootstrap bootstrap/unity.c
+gcc -Wall -Wextra -g -DSYSMELB_TAGGED_VALUES -o build/bootstrap-tagged bootstrap/unity.c
+gcc -Wall -Wextra -g -O2 -o build/benchmark bootstrap/benchmark.c
+gcc -Wall -Wextra -g -O2 -DSYSMELB_TAGGED_VALUES -o build/benchmark-tagged bootstrap/benchmark.c